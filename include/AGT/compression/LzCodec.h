@@ -0,0 +1,241 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+
+namespace AGT {
+    //Byte oriented LZ77 block codec in the spirit of LZ4. A block is a list of sequences: a token with the literal
+    //and match length, the literals, a 16 bit offset and the match. The last sequence only has literals.
+    //Lengths that don't fit the 4 bit token fields continue in bytes of 255.
+    class LzCodec {
+    public:
+        LzCodec() : m_hashTable(std::make_unique<uint32_t[]>(HASH_TABLE_SIZE)) {}
+
+        static constexpr size_t GetMaxCompressedSize(size_t size) noexcept {
+            return size + size / 255 + 16;
+        }
+
+        //Returns the compressed size, 0 if dst is too small
+        size_t Compress(std::span<const char> src, std::span<char> dst) noexcept {
+            const uint8_t* base = reinterpret_cast<const uint8_t*>(src.data());
+            const uint8_t* ip = base;
+            const uint8_t* anchor = base;
+            const uint8_t* end = base + src.size();
+            uint8_t* out = reinterpret_cast<uint8_t*>(dst.data());
+            uint8_t* outEnd = out + dst.size();
+            uint8_t* op = out;
+
+            if (src.size() >= MIN_INPUT_SIZE) {
+                memset(m_hashTable.get(), 0, HASH_TABLE_SIZE * sizeof(uint32_t));
+                const uint8_t* matchLimit = end - LAST_LITERALS;
+
+                while (ip + MIN_MATCH <= matchLimit) {
+                    uint32_t sequence = Read32(ip);
+                    uint32_t& entry = m_hashTable[Hash(sequence)];
+                    const uint8_t* ref = base + entry;
+                    entry = static_cast<uint32_t>(ip - base);
+
+                    if (ref >= ip || ip - ref > MAX_OFFSET || Read32(ref) != sequence) {
+                        //step faster through data that doesn't compress
+                        ip += 1 + ((ip - anchor) >> SKIP_STRENGTH);
+                        continue;
+                    }
+
+                    //extend the match backwards over pending literals, then forwards
+                    while (ip > anchor && ref > base && ip[-1] == ref[-1]) {
+                        --ip;
+                        --ref;
+                    }
+
+                    size_t matchLength = MIN_MATCH;
+                    while (ip + matchLength < matchLimit && ip[matchLength] == ref[matchLength]) {
+                        ++matchLength;
+                    }
+
+                    op = WriteSequence(op, outEnd, anchor, ip - anchor, static_cast<uint16_t>(ip - ref), matchLength);
+                    if (!op) {
+                        return 0;
+                    }
+
+                    ip += matchLength;
+                    anchor = ip;
+                }
+            }
+
+            op = WriteSequence(op, outEnd, anchor, end - anchor, 0, 0);
+            return op ? static_cast<size_t>(op - out) : 0;
+        }
+
+        //dst has to be exactly the size of the original data. Malformed input is rejected, never read or written out of bounds.
+        static bool Decompress(std::span<const char> src, std::span<char> dst) noexcept {
+            const uint8_t* ip = reinterpret_cast<const uint8_t*>(src.data());
+            const uint8_t* end = ip + src.size();
+            uint8_t* out = reinterpret_cast<uint8_t*>(dst.data());
+            uint8_t* op = out;
+            uint8_t* outEnd = out + dst.size();
+
+            while (ip < end) {
+                uint8_t token = *ip++;
+
+                size_t literalLength = token >> 4;
+                if (!ReadLength(ip, end, literalLength)
+                    || literalLength > static_cast<size_t>(end - ip)
+                    || literalLength > static_cast<size_t>(outEnd - op)) {
+                    return false;
+                }
+
+                if (literalLength > 0) {
+                    memcpy(op, ip, literalLength);
+                    ip += literalLength;
+                    op += literalLength;
+                }
+
+                if (ip == end) {
+                    break;
+                }
+
+                if (end - ip < 2) {
+                    return false;
+                }
+
+                size_t offset = ip[0] | (ip[1] << 8);
+                ip += 2;
+                if (offset == 0 || offset > static_cast<size_t>(op - out)) {
+                    return false;
+                }
+
+                size_t matchLength = token & 0xF;
+                if (!ReadLength(ip, end, matchLength)) {
+                    return false;
+                }
+
+                matchLength += MIN_MATCH;
+                if (matchLength > static_cast<size_t>(outEnd - op)) {
+                    return false;
+                }
+
+                const uint8_t* ref = op - offset;
+                if (offset >= matchLength) {
+                    memcpy(op, ref, matchLength);
+                    op += matchLength;
+                } else {
+                    //overlapping match repeats the last offset bytes
+                    for (size_t i = 0; i < matchLength; ++i) {
+                        *op++ = *ref++;
+                    }
+                }
+            }
+
+            return op == outEnd;
+        }
+
+    private:
+        LzCodec(const LzCodec&) = delete;
+        LzCodec& operator=(const LzCodec&) = delete;
+
+        static constexpr size_t MIN_MATCH = 4;
+        static constexpr size_t LAST_LITERALS = 5;
+        static constexpr size_t MIN_INPUT_SIZE = 13;
+        static constexpr ptrdiff_t MAX_OFFSET = 65535;
+        static constexpr int SKIP_STRENGTH = 6;
+        static constexpr int HASH_BITS = 14;
+        static constexpr size_t HASH_TABLE_SIZE = size_t{ 1 } << HASH_BITS;
+
+        static uint32_t Read32(const uint8_t* ptr) noexcept {
+            uint32_t value;
+            memcpy(&value, ptr, sizeof(value));
+            return value;
+        }
+
+        static uint32_t Hash(uint32_t sequence) noexcept {
+            return (sequence * 2654435761u) >> (32 - HASH_BITS);
+        }
+
+        static uint8_t* WriteLength(uint8_t* op, size_t length) noexcept {
+            for (length -= 15; length >= 255; length -= 255) {
+                *op++ = 255;
+            }
+            *op++ = static_cast<uint8_t>(length);
+            return op;
+        }
+
+        static bool ReadLength(const uint8_t*& ip, const uint8_t* end, size_t& length) noexcept {
+            if (length != 15) {
+                return true;
+            }
+
+            uint8_t value = 0;
+            do {
+                if (ip == end) {
+                    return false;
+                }
+                value = *ip++;
+                length += value;
+            } while (value == 255);
+            return true;
+        }
+
+        //A matchLength of 0 writes the final, literals only sequence
+        static uint8_t* WriteSequence(uint8_t* op, uint8_t* outEnd, const uint8_t* literals, size_t literalLength, uint16_t offset, size_t matchLength) noexcept {
+            size_t maxSize = 1 + literalLength / 255 + 1 + literalLength + 2 + matchLength / 255 + 1;
+            if (maxSize > static_cast<size_t>(outEnd - op)) {
+                return nullptr;
+            }
+
+            uint8_t* token = op++;
+            *token = static_cast<uint8_t>(std::min<size_t>(literalLength, 15) << 4);
+            if (literalLength >= 15) {
+                op = WriteLength(op, literalLength);
+            }
+
+            if (literalLength > 0) {
+                memcpy(op, literals, literalLength);
+                op += literalLength;
+            }
+
+            if (matchLength == 0) {
+                return op;
+            }
+
+            *op++ = static_cast<uint8_t>(offset);
+            *op++ = static_cast<uint8_t>(offset >> 8);
+
+            size_t matchCode = matchLength - MIN_MATCH;
+            *token |= static_cast<uint8_t>(std::min<size_t>(matchCode, 15));
+            if (matchCode >= 15) {
+                op = WriteLength(op, matchCode);
+            }
+            return op;
+        }
+
+        std::unique_ptr<uint32_t[]> m_hashTable;
+    };
+}
\ No newline at end of file
@@ -25,6 +25,7 @@ SOFTWARE.
 #pragma once
 
 #include "../platform/Platform.h"
+#include "../log/FlightRecorder.h"
 #include "../log/Log.h"
 
 #include <atomic>
@@ -35,6 +36,10 @@ SOFTWARE.
 #ifdef AGT_PLAT_WINDOWS
 #include <Windows.h>
 #include <Dbghelp.h>
+#else
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
 #endif
 
 namespace AGT {
@@ -45,6 +50,9 @@ namespace AGT {
         Large
     };
 
+    //On a crash the active FlightRecorder is marked and written back first. fOnTerminate runs for std::terminate
+    //and Windows exceptions, fatal POSIX signals only print a fixed message since the handler must be async-signal-safe.
+    //Minidumps are Windows only, elsewhere the default action of the signal produces the core dump.
     class CrashHandler {
     public:
         static void Init(MinidumpSize minidumpSize, const char* crashDumpPath, const std::function<void()>& fOnTerminate) noexcept {
@@ -52,8 +60,20 @@ namespace AGT {
             m_fOnTerminate = fOnTerminate;
             m_crashDumpPath = crashDumpPath;
 
+#ifdef AGT_PLAT_WINDOWS
             SetUnhandledExceptionFilter(::AGT::CrashHandler::UnhandledExceptionHandler);
             signal(SIGABRT, &::AGT::CrashHandler::AbortHandler);
+#else
+            struct sigaction action {};
+            action.sa_handler = &::AGT::CrashHandler::FatalSignalHandler;
+            action.sa_flags = SA_RESETHAND;
+            sigemptyset(&action.sa_mask);
+            for (int fatalSignal : { SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT }) {
+                sigaction(fatalSignal, &action, nullptr);
+            }
+
+            std::set_terminate(&::AGT::CrashHandler::TerminateHandler);
+#endif
         }
 
     private:
@@ -63,36 +83,35 @@ namespace AGT {
 
         ~CrashHandler() = default;
 
+        static void SaveFlightRecorder(int signal) noexcept {
+            if (FlightRecorder* recorder = FlightRecorder::GetActive()) {
+                recorder->OnCrash(signal);
+            }
+        }
+
+#ifdef AGT_PLAT_WINDOWS
         static void AbortHandler(int) noexcept {
+            SaveFlightRecorder(SIGABRT);
             AGT_ERR("Abort called. Terminating program.");
 
-#ifdef AGT_PLAT_WINDOWS
             __try {
                 int* createException = nullptr;
                 *createException = 1;
             } __except (UnhandledExceptionHandler(GetExceptionInformation())) {}
-#else
-            //TODO is it possibe to get the current exception
-            m_fOnTerminate();
-#endif
         }
 
         static LONG CALLBACK UnhandledExceptionHandler(EXCEPTION_POINTERS* ex) noexcept {
+            SaveFlightRecorder(ex ? static_cast<int>(ex->ExceptionRecord->ExceptionCode) : 0);
             AGT_ERR("Unhanded exception was thrown. Terminating program.");
 
             if (m_minidumpSize != MinidumpSize::None && m_crashDumpPath && !m_minidumpGenerated) {
-#ifdef AGT_PLAT_WINDOWS
                 SaveMinidump(ex, m_crashDumpPath, m_minidumpSize);
-#else
-                //TODO add platform support
-#endif
             }
             
             m_fOnTerminate();
             return EXCEPTION_CONTINUE_SEARCH;
         }
 
-#ifdef AGT_PLAT_WINDOWS
         static void SaveMinidump(EXCEPTION_POINTERS* ex, const char* crashDumpPath, MinidumpSize size) noexcept {
             AGT_INFO("Attempting to generate a minidump.");
 
@@ -162,6 +181,62 @@ namespace AGT {
 
             CloseHandle(hFile);
         }
+#else
+        //SA_RESETHAND restored the default action, the signal raised again on return produces the core dump.
+        //Only async-signal-safe work happens here: the crashed thread may hold the logger's locks,
+        //so logging and fOnTerminate are left to TerminateHandler.
+        static void FatalSignalHandler(int signal) noexcept {
+            SaveFlightRecorder(signal);
+            WriteFatalSignalMessage(signal);
+            raise(signal);
+        }
+
+        static void WriteFatalSignalMessage(int signal) noexcept {
+            static const char PREFIX[] = "Fatal signal ";
+            static const char SUFFIX[] = ". Terminating program.\n";
+
+            char message[sizeof(PREFIX) + sizeof(SUFFIX) + 16];
+            size_t size = sizeof(PREFIX) - 1;
+            memcpy(message, PREFIX, size);
+
+            char digits[16];
+            size_t numDigits = 0;
+            unsigned int value = signal < 0 ? 0u : static_cast<unsigned int>(signal);
+            do {
+                digits[numDigits++] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            } while (value && numDigits < sizeof(digits));
+            while (numDigits) {
+                message[size++] = digits[--numDigits];
+            }
+
+            memcpy(message + size, SUFFIX, sizeof(SUFFIX) - 1);
+            size += sizeof(SUFFIX) - 1;
+            [[maybe_unused]] ssize_t written = write(STDERR_FILENO, message, size);
+        }
+
+        static void TerminateHandler() noexcept {
+            SaveFlightRecorder(SIGABRT);
+
+            try {
+                if (std::exception_ptr exception = std::current_exception()) {
+                    std::rethrow_exception(exception);
+                }
+                AGT_ERR("std::terminate called. Terminating program.");
+            } catch (const std::exception& ex) {
+                AGT_ERR("Unhandled exception: %s. Terminating program.", ex.what());
+            } catch (...) {
+                AGT_ERR("Unhandled exception was thrown. Terminating program.");
+            }
+
+            if (m_fOnTerminate) {
+                m_fOnTerminate();
+            }
+
+            //already handled, abort must not run the handlers again
+            signal(SIGABRT, SIG_DFL);
+            std::abort();
+        }
 #endif
         static inline MinidumpSize m_minidumpSize{ MinidumpSize::Small };
         static inline const char* m_crashDumpPath{ nullptr };
@@ -0,0 +1,85 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace AGT {
+    //Layout of the stream produced by DeferredLogger in binary mode. A stream is a sequence of records, each
+    //starting with a BinaryLogRecord byte. Call sites and threads are described once and then referenced by entries.
+    //
+    //  Process: uint32 magic, uint32 version, varint pid
+    //  Site:    varint id, uint8 level, varint line, varint numArgs, uint8 argTypes[numArgs], file, function, format
+    //           (strings are a varint length followed by the characters)
+    //  Thread:  varint thread id
+    //  Entry:   varint site id, zigzag varint timestamp delta (ns), varint args size, encoded args (see LogArgs)
+    enum class BinaryLogRecord : uint8_t {
+        Process = 1,
+        Site = 2,
+        Thread = 3,
+        Entry = 4
+    };
+
+    class BinaryLogFormat {
+    public:
+        static constexpr uint32_t MAGIC = 0x4C544741; // "AGTL"
+        static constexpr uint32_t VERSION = 1;
+
+        static void WriteVarint(std::vector<char>& out, uint64_t value) {
+            while (value >= 0x80) {
+                out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<char>(value));
+        }
+
+        static bool ReadVarint(std::span<const char> data, size_t& offset, uint64_t& value) noexcept {
+            value = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                if (offset >= data.size()) {
+                    return false;
+                }
+
+                uint8_t byte = static_cast<uint8_t>(data[offset++]);
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        static uint64_t ZigZagEncode(int64_t value) noexcept {
+            return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+        }
+
+        static int64_t ZigZagDecode(uint64_t value) noexcept {
+            return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+        }
+    };
+}
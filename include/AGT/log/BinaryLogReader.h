@@ -0,0 +1,212 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "BinaryLogFormat.h"
+#include "DeferredLogger.h"
+#include "ILoggerSink.h"
+#include "LogArgs.h"
+#include "LogEntryBuilder.h"
+#include "LogSiteRegistry.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace AGT {
+    //Turns the binary stream written by DeferredLogger back into text entries. Can be used by offline tools.
+    template<typename TFormatter>
+    class BinaryLogReader {
+    public:
+        BinaryLogReader(size_t maxLineSize = 1024) {
+            m_lineBuffer.resize(maxLineSize < 2 ? 2 : maxLineSize);
+        }
+
+        //Decodes a sequence of complete records and writes the resulting entries to the sink.
+        //Returns false if the stream is malformed. State is kept between calls, so a stream can be fed in pieces.
+        bool Read(std::span<const char> data, ILoggerSink& sink) {
+            size_t offset = 0;
+            while (offset < data.size()) {
+                auto recordType = static_cast<BinaryLogRecord>(data[offset++]);
+                bool valid = false;
+
+                switch (recordType) {
+                case BinaryLogRecord::Process: valid = ReadProcess(data, offset); break;
+                case BinaryLogRecord::Site:    valid = ReadSite(data, offset); break;
+                case BinaryLogRecord::Thread:  valid = ReadThread(data, offset); break;
+                case BinaryLogRecord::Entry:   valid = ReadEntry(data, offset, sink); break;
+                default: break;
+                }
+
+                if (!valid) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        bool ReadFile(const char* path, ILoggerSink& sink) {
+            std::ifstream file(path, std::ios::binary);
+            if (!file.is_open()) {
+                return false;
+            }
+
+            std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            return Read(data, sink);
+        }
+
+    private:
+        BinaryLogReader(const BinaryLogReader&) = delete;
+        BinaryLogReader& operator=(const BinaryLogReader&) = delete;
+
+        struct Site {
+            LogSiteDescriptor descriptor;
+            std::string file;
+            std::string function;
+            std::string format;
+            std::vector<LogArgType> argTypes;
+        };
+
+        bool ReadProcess(std::span<const char> data, size_t& offset) {
+            uint32_t magic = 0;
+            uint32_t version = 0;
+            uint64_t pid = 0;
+            if (!ReadValue(data, offset, magic) || !ReadValue(data, offset, version) || !BinaryLogFormat::ReadVarint(data, offset, pid)) {
+                return false;
+            }
+
+            if (magic != BinaryLogFormat::MAGIC || version != BinaryLogFormat::VERSION) {
+                return false;
+            }
+
+            m_pid = static_cast<int>(pid);
+            m_timestamp = 0;
+            return true;
+        }
+
+        bool ReadSite(std::span<const char> data, size_t& offset) {
+            auto site = std::make_unique<Site>();
+
+            uint64_t id = 0;
+            uint8_t level = 0;
+            uint64_t lineNumber = 0;
+            uint64_t numArgs = 0;
+            if (!BinaryLogFormat::ReadVarint(data, offset, id)
+                || !ReadValue(data, offset, level)
+                || !BinaryLogFormat::ReadVarint(data, offset, lineNumber)
+                || !BinaryLogFormat::ReadVarint(data, offset, numArgs)
+                || numArgs > data.size() - offset) {
+                return false;
+            }
+
+            for (uint64_t i = 0; i < numArgs; ++i) {
+                site->argTypes.push_back(static_cast<LogArgType>(data[offset++]));
+            }
+
+            if (!ReadString(data, offset, site->file) || !ReadString(data, offset, site->function) || !ReadString(data, offset, site->format)) {
+                return false;
+            }
+
+            site->descriptor.id = static_cast<uint32_t>(id);
+            site->descriptor.level = static_cast<LogLevel>(level);
+            site->descriptor.lineNumber = static_cast<int>(lineNumber);
+            site->descriptor.file = site->file.c_str();
+            site->descriptor.function = site->function.c_str();
+            site->descriptor.format = site->format.c_str();
+            site->descriptor.argTypes = site->argTypes;
+
+            m_sites[site->descriptor.id] = std::move(site);
+            return true;
+        }
+
+        bool ReadThread(std::span<const char> data, size_t& offset) {
+            return BinaryLogFormat::ReadVarint(data, offset, m_threadId);
+        }
+
+        bool ReadEntry(std::span<const char> data, size_t& offset, ILoggerSink& sink) {
+            uint64_t siteId = 0;
+            uint64_t timestampDelta = 0;
+            uint64_t argsSize = 0;
+            if (!BinaryLogFormat::ReadVarint(data, offset, siteId)
+                || !BinaryLogFormat::ReadVarint(data, offset, timestampDelta)
+                || !BinaryLogFormat::ReadVarint(data, offset, argsSize)
+                || argsSize > data.size() - offset) {
+                return false;
+            }
+
+            auto it = m_sites.find(static_cast<uint32_t>(siteId));
+            if (it == m_sites.end()) {
+                return false;
+            }
+
+            m_timestamp += BinaryLogFormat::ZigZagDecode(timestampDelta);
+            std::span<const char> args = data.subspan(offset, argsSize);
+            offset += argsSize;
+
+            LogEntryBuilder builder(m_lineBuffer);
+            if (!FormatDeferredEntry(m_formatter, builder, it->second->descriptor, m_timestamp, m_pid, m_threadId, args)) {
+                return false;
+            }
+            sink.Write(m_lineBuffer.data(), builder.GetSizeWritten());
+            return true;
+        }
+
+        template<typename T>
+        static bool ReadValue(std::span<const char> data, size_t& offset, T& value) noexcept {
+            if (sizeof(T) > data.size() - offset) {
+                return false;
+            }
+
+            memcpy(&value, data.data() + offset, sizeof(T));
+            offset += sizeof(T);
+            return true;
+        }
+
+        static bool ReadString(std::span<const char> data, size_t& offset, std::string& str) {
+            uint64_t size = 0;
+            if (!BinaryLogFormat::ReadVarint(data, offset, size) || size > data.size() - offset) {
+                return false;
+            }
+
+            str.assign(data.data() + offset, size);
+            offset += size;
+            return true;
+        }
+
+        TFormatter m_formatter;
+        std::vector<char> m_lineBuffer;
+        std::unordered_map<uint32_t, std::unique_ptr<Site>> m_sites;
+        int m_pid{ 0 };
+        uint64_t m_threadId{ 0 };
+        uint64_t m_timestamp{ 0 };
+    };
+}
@@ -0,0 +1,55 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+namespace AGT {
+    //Layout of files written by LoggerCompressedFileSink. A file header is followed by blocks that can be
+    //decompressed independently. Readers find blocks by walking the block headers, a block cut short by a crash is ignored.
+    //
+    //  File:  CompressedLogFileHeader
+    //  Block: CompressedLogBlockHeader, payload (LzCodec block, raw bytes if compressedSize == size)
+    struct CompressedLogFileHeader {
+        uint32_t magic;
+        uint32_t version;
+    };
+
+    struct CompressedLogBlockHeader {
+        uint32_t compressedSize;
+        uint32_t size;
+        uint32_t numEntries;
+        uint32_t reserved;
+        uint64_t firstTimestampNs; // time the first entry reached the sink
+        uint64_t lastTimestampNs;
+    };
+
+    class CompressedLogFormat {
+    public:
+        static constexpr uint32_t MAGIC = 0x5A544741; // "AGTZ"
+        static constexpr uint32_t VERSION = 1;
+        static constexpr uint32_t MAX_BLOCK_SIZE = 64 * 1024 * 1024;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,133 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "../compression/LzCodec.h"
+#include "CompressedLogFormat.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+namespace AGT {
+    struct CompressedLogBlockInfo {
+        CompressedLogBlockHeader header;
+        uint64_t payloadOffset;
+    };
+
+    //Reads files written by LoggerCompressedFileSink. Opening only walks the block headers,
+    //each block is decompressed on its own when it is read.
+    class CompressedLogReader {
+    public:
+        static std::unique_ptr<CompressedLogReader> Open(const std::filesystem::path& path) {
+            auto reader = std::unique_ptr<CompressedLogReader>(new CompressedLogReader());
+            if (reader && reader->Init(path)) {
+                return reader;
+            }
+
+            return nullptr;
+        }
+
+        size_t GetNumBlocks() const noexcept { return m_blocks.size(); }
+        const CompressedLogBlockInfo& GetBlock(size_t index) const noexcept { return m_blocks[index]; }
+
+        //First block with entries written at or after timestampNs, GetNumBlocks() if there is none
+        size_t FindBlock(uint64_t timestampNs) const noexcept {
+            auto it = std::lower_bound(m_blocks.begin(), m_blocks.end(), timestampNs, [](const CompressedLogBlockInfo& block, uint64_t value) {
+                return block.header.lastTimestampNs < value;
+            });
+            return it - m_blocks.begin();
+        }
+
+        //Replaces the contents of out with the entries of the block
+        bool ReadBlock(size_t index, std::vector<char>& out) {
+            if (index >= m_blocks.size()) {
+                return false;
+            }
+
+            const CompressedLogBlockHeader& header = m_blocks[index].header;
+            m_file.clear();
+            m_file.seekg(static_cast<std::streamoff>(m_blocks[index].payloadOffset));
+
+            out.resize(header.size);
+            if (header.compressedSize == header.size) {
+                return static_cast<bool>(m_file.read(out.data(), header.size));
+            }
+
+            m_compressed.resize(header.compressedSize);
+            if (!m_file.read(m_compressed.data(), header.compressedSize)) {
+                return false;
+            }
+
+            return LzCodec::Decompress(m_compressed, out);
+        }
+
+    private:
+        CompressedLogReader(const CompressedLogReader&) = delete;
+        CompressedLogReader& operator=(const CompressedLogReader&) = delete;
+
+        CompressedLogReader() noexcept = default;
+
+        bool Init(const std::filesystem::path& path) {
+            std::error_code error;
+            uint64_t fileSize = std::filesystem::file_size(path, error);
+            if (error) {
+                return false;
+            }
+
+            m_file.open(path, std::ios::binary);
+            CompressedLogFileHeader fileHeader{};
+            if (!m_file.read(reinterpret_cast<char*>(&fileHeader), sizeof(fileHeader))
+                || fileHeader.magic != CompressedLogFormat::MAGIC
+                || fileHeader.version != CompressedLogFormat::VERSION) {
+                return false;
+            }
+
+            uint64_t offset = sizeof(fileHeader);
+            CompressedLogBlockHeader header{};
+            while (offset + sizeof(header) <= fileSize && m_file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+                uint64_t payloadOffset = offset + sizeof(header);
+                if (header.size > CompressedLogFormat::MAX_BLOCK_SIZE
+                    || header.compressedSize > header.size
+                    || header.compressedSize > fileSize - payloadOffset) {
+                    break;
+                }
+
+                m_blocks.push_back({ header, payloadOffset });
+                offset = payloadOffset + header.compressedSize;
+                m_file.seekg(static_cast<std::streamoff>(offset));
+            }
+
+            return true;
+        }
+
+        std::ifstream m_file;
+        std::vector<CompressedLogBlockInfo> m_blocks;
+        std::vector<char> m_compressed;
+    };
+}
\ No newline at end of file
@@ -25,14 +25,37 @@ SOFTWARE.
 #pragma once
 
 #include "../platform/Platform.h"
+#include "../thread/ThreadInfo.h"
+#include "../time/TscClock.h"
+#include "LogArgs.h"
 #include "LogEntryBuilder.h"
 #include "LogLevel.h"
+#include "LogSite.h"
+
+#include <cstdint>
+#include <string_view>
 
 namespace AGT {
     class DefaultLogFormatter {
     public:
         DefaultLogFormatter() noexcept = default;
 
+        template<typename... Args>
+        void Format(
+            LogEntryBuilder& builder,
+            const LogSite& site,
+            const char* format,
+            Args&&... args
+        ) noexcept {
+            static_assert((IsLogArg<Args> && ...), "Log arguments must be arithmetic values, enums, C strings or pointers");
+
+            uint64_t timestampNs = TscClock::GetTimeSinceEpochNs();
+
+            FormatHeader(builder, site.GetLevel(), timestampNs, ThreadInfo::GetLogHeader(), site.GetPrefix());
+            builder.Write(format, std::forward<Args>(args)...);
+            EndEntry(builder);
+        }
+
         template<typename... Args>
         void Format(
             LogEntryBuilder& builder,
@@ -43,37 +66,83 @@ namespace AGT {
             const char* format,
             Args&&... args
         ) noexcept {
-            static const char PATH_SEPARATOR =
-#ifdef AGT_PLAT_WINDOWS
-                '\\';
-#elif
-                '/';
-#endif
-
-            //shortens file path to the file name
-            const char* fileName = file;
-            const char* fileNamePos = strrchr(file, PATH_SEPARATOR);
-            if (fileNamePos) {
-                fileName = fileNamePos + 1;
-            }
-
-            int pid = _getpid();
-            size_t threadId = std::hash<std::thread::id>{}(std::this_thread::get_id());
-
-            auto duration = std::chrono::high_resolution_clock::now().time_since_epoch();
-            uint64_t timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
-
-            builder.WriteLine("[%llu][%s][pid=%i][tid=%llu][%s | %s() | %i]",
-                              timestampNs,
-                              LogLevelToString(level),
-                              pid,
-                              threadId,
-                              fileName,
-                              function,
-                              lineNumber);
-
-            builder.WriteLine(format, std::forward<Args>(args)...);
+            LogSite site(level, GetLogFileName(file), function, lineNumber);
+            Format(builder, site, format, std::forward<Args>(args)...);
+        }
+
+        //Used when the fields were captured earlier, e.g. by the deferred logger backend
+        void FormatHeader(
+            LogEntryBuilder& builder,
+            LogLevel level,
+            uint64_t timestampNs,
+            int pid,
+            uint64_t threadId,
+            const char* file,
+            const char* function,
+            int lineNumber
+        ) noexcept {
+            LogSite site(level, GetLogFileName(file), function, lineNumber);
+            FormatHeader(builder, level, timestampNs, pid, threadId, site.GetPrefix());
+        }
+
+        //Only the dynamic fields are formatted, the call site part is copied from the pre-rendered prefix
+        void FormatHeader(
+            LogEntryBuilder& builder,
+            LogLevel level,
+            uint64_t timestampNs,
+            int pid,
+            uint64_t threadId,
+            std::string_view sitePrefix
+        ) noexcept {
+            AppendPrefix(builder, level, timestampNs);
+            builder.Append("[pid=");
+            builder.Append(pid);
+            builder.Append("][tid=");
+            builder.Append(threadId);
+            builder.Append(']');
+            builder.Append(sitePrefix);
+            builder.EndLine(true);
+        }
+
+        //The process and thread part comes pre-rendered from ThreadInfo
+        void FormatHeader(
+            LogEntryBuilder& builder,
+            LogLevel level,
+            uint64_t timestampNs,
+            std::string_view threadHeader,
+            std::string_view sitePrefix
+        ) noexcept {
+            AppendPrefix(builder, level, timestampNs);
+            builder.Append(threadHeader);
+            builder.Append(sitePrefix);
+            builder.EndLine(true);
+        }
+
+        //The entry without its header line, used to detect repeated messages regardless of timestamp and thread
+        static std::string_view GetEntryBody(std::string_view entry) noexcept {
+            size_t headerEnd = entry.find('\n');
+            return headerEnd == std::string_view::npos ? entry : entry.substr(headerEnd + 1);
+        }
+
+        //Writes the message of an entry started with FormatHeader. fWrite receives the builder to write it into.
+        template<typename TWrite>
+        void WriteMessage(LogEntryBuilder& builder, TWrite&& fWrite) noexcept {
+            fWrite(builder);
+        }
+
+        //Terminates an entry whose message was written directly into the builder
+        void EndEntry(LogEntryBuilder& builder) noexcept {
+            builder.EndLine(true);
             builder.EndLine();
         }
+
+    private:
+        static void AppendPrefix(LogEntryBuilder& builder, LogLevel level, uint64_t timestampNs) noexcept {
+            builder.Append('[');
+            builder.Append(timestampNs);
+            builder.Append("][");
+            builder.Append(LogLevelToString(level));
+            builder.Append(']');
+        }
     };
 }
\ No newline at end of file
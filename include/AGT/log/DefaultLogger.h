@@ -24,22 +24,75 @@ SOFTWARE.
 
 #pragma once
 
+#include "../thread/ProfiledLock.h"
+#include "../time/TscClock.h"
 #include "ILoggerSink.h"
+#include "LogCategory.h"
+#include "LogCoalescer.h"
 #include "LogEntryBuilder.h"
 #include "LogLevel.h"
+#include "LogQueueWorker.h"
+#include "LogSegmentPool.h"
+#include "LogSite.h"
+#include "LoggerAsyncConfig.h"
+#include "LoggerSinkWorker.h"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstring>
+#include <cstdint>
 #include <memory>
 #include <mutex>
+#include <span>
+#include <string_view>
 #include <vector>
 
 namespace AGT {
+    //Each sink can have its own level and, through LoggerSinkConfig::queueSize, its own queue and worker thread.
+    //Entries are formatted once and only if at least one sink accepts their level.
     template<typename TFormatter>
     class DefaultLogger {
     public:
         static std::unique_ptr<DefaultLogger<TFormatter>> Create(LogLevel maxLevel, size_t maxLineSize, std::span<std::shared_ptr<ILoggerSink>> sinks) {
+            std::vector<LoggerSinkConfig> sinkConfigs = ToSinkConfigs(sinks);
+            return Create(maxLevel, maxLineSize, std::span<const LoggerSinkConfig>(sinkConfigs));
+        }
+
+        static std::unique_ptr<DefaultLogger<TFormatter>> Create(
+            LogLevel maxLevel,
+            size_t maxLineSize,
+            std::span<const LoggerSinkConfig> sinks,
+            const LoggerSpillConfig& spillConfig = {}
+        ) {
             auto logger = std::unique_ptr<DefaultLogger<TFormatter>>(new DefaultLogger<TFormatter>());
-            if (logger && logger->Init(maxLevel, maxLineSize, sinks)) {
+            if (logger && logger->Init(maxLevel, maxLineSize, sinks, spillConfig)) {
+                return logger;
+            }
+
+            return nullptr;
+        }
+
+        //Entries are formatted on the calling thread and queued. A backend thread writes them to the sinks.
+        static std::unique_ptr<DefaultLogger<TFormatter>> CreateAsync(
+            LogLevel maxLevel,
+            size_t maxLineSize,
+            std::span<std::shared_ptr<ILoggerSink>> sinks,
+            const LoggerAsyncConfig& config
+        ) {
+            std::vector<LoggerSinkConfig> sinkConfigs = ToSinkConfigs(sinks);
+            return CreateAsync(maxLevel, maxLineSize, std::span<const LoggerSinkConfig>(sinkConfigs), config);
+        }
+
+        static std::unique_ptr<DefaultLogger<TFormatter>> CreateAsync(
+            LogLevel maxLevel,
+            size_t maxLineSize,
+            std::span<const LoggerSinkConfig> sinks,
+            const LoggerAsyncConfig& config,
+            const LoggerSpillConfig& spillConfig = {}
+        ) {
+            auto logger = std::unique_ptr<DefaultLogger<TFormatter>>(new DefaultLogger<TFormatter>());
+            if (logger && logger->Init(maxLevel, maxLineSize, sinks, spillConfig) && logger->InitAsync(maxLineSize, config)) {
                 return logger;
             }
 
@@ -47,19 +100,49 @@ namespace AGT {
         }
 
         ~DefaultLogger() {
+            StopBackend();
             Flush();
         }
 
-        DefaultLogger(DefaultLogger&& other) noexcept {
-            *this = std::move(other);
+        //False if the level is above the logger's level or no sink accepts it
+        bool IsEnabled(LogLevel level) const noexcept {
+            return static_cast<int>(level) <= static_cast<int>(m_enabledLevel.load(std::memory_order_relaxed));
+        }
+
+        //A category with a level of its own replaces the logger's level, the sink levels still apply
+        bool IsEnabled(LogLevel level, const LogCategory* category) const noexcept {
+            LogLevel categoryLevel;
+            if (!category || !category->GetLevel(categoryLevel)) {
+                return IsEnabled(level);
+            }
+
+            return static_cast<int>(level) <= static_cast<int>(categoryLevel) &&
+                static_cast<int>(level) <= static_cast<int>(m_sinksLevel.load(std::memory_order_relaxed));
+        }
+
+        //Takes effect on the next call from any thread
+        void SetMaxLevel(LogLevel maxLevel) noexcept {
+            std::lock_guard<std::mutex> lock(m_levelLock);
+            m_maxLevel = maxLevel;
+            UpdateEnabledLevel();
         }
 
-        DefaultLogger& operator=(DefaultLogger&& other) noexcept {
-            m_maxLevel = other.m_maxLevel;
-            other.m_maxLevel = LogLevel::Debug;
+        //Sinks are indexed in the order they were passed to Create
+        void SetSinkMaxLevel(size_t index, LogLevel maxLevel) noexcept {
+            if (index >= m_sinks.size()) {
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(m_levelLock);
+            m_sinks[index].maxLevel.store(maxLevel, std::memory_order_relaxed);
+            UpdateEnabledLevel();
+        }
 
-            m_lineBuffer = std::move(other.m_lineBuffer);
-            m_sinks = std::move(other.m_sinks);
+        //Identical consecutive entries (ignoring timestamp and thread) within the window are written once,
+        //followed by a "repeated N times" entry when the run ends or on Flush. Zero disables coalescing.
+        //The file and function strings of coalesced sites must outlive the logger, as the macros' do.
+        void SetCoalescingWindow(std::chrono::nanoseconds window) noexcept {
+            m_coalescingWindowNs.store(static_cast<uint64_t>(window.count()), std::memory_order_relaxed);
         }
 
         template<typename... Args>
@@ -71,61 +154,450 @@ namespace AGT {
             const char* format,
             Args&&... args
         ) {
-            std::lock_guard<std::mutex> lock(m_lock);
+            if (!IsEnabled(level)) {
+                return;
+            }
+
+            LogSite site(level, GetLogFileName(file), function, lineNumber);
+            Write(site, format, std::forward<Args>(args)...);
+        }
+
+        template<typename... Args>
+        void Write(const LogSite& site, const char* format, Args&&... args) {
+            if (!IsEnabled(site.GetLevel(), site.GetCategory())) {
+                return;
+            }
 
-            if (static_cast<int>(level) > static_cast<int>(m_maxLevel)) {
+            if (m_queue) {
+                WriteAsync(site, format, std::forward<Args>(args)...);
                 return;
             }
 
+            //each thread formats into its own buffer so only the sink writes are serialized
+            std::span<char> lineBuffer = GetThreadLineBuffer();
+
             TFormatter formatter;
-            LogEntryBuilder builder(m_lineBuffer);
-
-            formatter.Format(
-                builder,
-                level,
-                file,
-                function,
-                lineNumber,
-                format,
-                std::forward<Args>(args)...
-            );
+            LogEntryBuilder builder(lineBuffer, m_spillPool.get());
+            formatter.Format(builder, site, format, std::forward<Args>(args)...);
+            std::string_view entry(lineBuffer.data(), builder.GetInlineSize());
+            const LogSegment* spilled = builder.GetSpilled();
+
+            bool coalesce = IsCoalescing();
+            LogEntryKey key;
+            if (coalesce) {
+                key = MakeEntryKey(site, entry, spilled);
+            }
+
+            std::lock_guard lock(m_lock);
+
+            if (coalesce) {
+                if (m_coalescer.Add(key, m_coalescingWindowNs.load(std::memory_order_relaxed))) {
+                    return;
+                }
 
-            for (auto& sink : m_sinks) {
-                sink->Write(m_lineBuffer.data(), builder.GetSizeWritten());
+                LogEntryKey endedRun;
+                WriteRepeatSummary(m_coalescer.TakeRepeats(endedRun), endedRun);
+            }
+
+            if (spilled) {
+                WriteScatteredToSinks(site.GetLevel(), { entry.data(), entry.size() }, spilled);
+            } else {
+                WriteToSinks(site.GetLevel(), entry.data(), entry.size());
             }
         }
 
+        //In async mode, waits until every entry queued before the call has been written to the sinks
         void Flush() {
-            std::lock_guard<std::mutex> lock(m_lock);
+            if (m_queue) {
+                m_queue->WaitProcessed();
+            }
+
+            {
+                std::lock_guard lock(m_lock);
 
-            for (auto& sink : m_sinks) {
-                sink->Flush();
+                LogEntryKey run;
+                WriteRepeatSummary(m_coalescer.TakeCurrentRepeats(run), run);
+
+                for (auto& slot : m_sinks) {
+                    if (!slot.worker) {
+                        slot.sink->Flush();
+                    }
+                }
+            }
+
+            //outside the lock, a slow sink must not hold up the logging threads while it catches up
+            for (auto& slot : m_sinks) {
+                if (slot.worker) {
+                    slot.worker->Flush();
+                }
             }
         }
 
+        //Number of entries discarded by the overflow policy in async mode
+        uint64_t GetDroppedCount() const noexcept {
+            return m_queue ? m_queue->GetDroppedCount() : 0;
+        }
+
+        //Number of entries cut because every spill segment was in use
+        uint64_t GetSpillExhaustedCount() const noexcept {
+            return m_spillPool ? m_spillPool->GetExhaustedCount() : 0;
+        }
+
+        //Number of entries a sink with its own queue discarded
+        uint64_t GetSinkDroppedCount(size_t index) const noexcept {
+            return index < m_sinks.size() && m_sinks[index].worker ? m_sinks[index].worker->GetDroppedCount() : 0;
+        }
+
     private:
         DefaultLogger(const DefaultLogger&) = delete;
         DefaultLogger& operator=(const DefaultLogger&) = delete;
 
         DefaultLogger() noexcept = default;
 
-        bool Init(LogLevel maxLevel, size_t maxLineSize, std::span<std::shared_ptr<ILoggerSink>> sinks) {
-            std::lock_guard<std::mutex> lock(m_lock);
+        struct QueueEntry {
+            std::vector<char> buffer;
+            size_t size{ 0 };
+            LogLevel level{ LogLevel::Debug };
+            LogSegment* spilled{ nullptr }; // the rest of an entry longer than the buffer
+            bool coalesce{ false };
+            LogEntryKey key;
+        };
 
-            m_maxLevel = maxLevel;
-            m_lineBuffer.resize(maxLineSize);
+        struct SinkSlot {
+            std::shared_ptr<ILoggerSink> sink;
+            std::atomic<LogLevel> maxLevel{ LogLevel::Debug };
+            std::unique_ptr<LoggerSinkWorker> worker;
+
+            bool Accepts(LogLevel level) const noexcept {
+                return static_cast<int>(level) <= static_cast<int>(maxLevel.load(std::memory_order_relaxed));
+            }
+        };
+
+        static std::vector<LoggerSinkConfig> ToSinkConfigs(std::span<std::shared_ptr<ILoggerSink>> sinks) {
+            std::vector<LoggerSinkConfig> sinkConfigs(sinks.size());
+            for (size_t i = 0; i < sinks.size(); ++i) {
+                sinkConfigs[i].sink = sinks[i];
+            }
+            return sinkConfigs;
+        }
+
+        bool Init(LogLevel maxLevel, size_t maxLineSize, std::span<const LoggerSinkConfig> sinks, const LoggerSpillConfig& spillConfig) {
+            std::lock_guard lock(m_lock);
+
+            m_maxLineSize = maxLineSize;
+            m_summaryBuffer.resize(maxLineSize);
 
-            m_sinks.reserve(sinks.size());
-            for (auto& sink : sinks) {
-                m_sinks.emplace_back(sink);
+            if (spillConfig.numSegments > 0) {
+                m_spillPool = LogSegmentPool::Create(spillConfig.segmentSize, spillConfig.numSegments);
+                if (!m_spillPool) {
+                    return false;
+                }
+                m_scatterParts.reserve(spillConfig.numSegments + 1);
             }
 
+            m_sinks = std::vector<SinkSlot>(sinks.size());
+            for (size_t i = 0; i < sinks.size(); ++i) {
+                const LoggerSinkConfig& config = sinks[i];
+                if (!config.sink) {
+                    m_sinks.clear(); // the destructor flushes every slot
+                    return false;
+                }
+
+                SinkSlot& slot = m_sinks[i];
+                slot.sink = config.sink;
+                slot.maxLevel.store(config.maxLevel, std::memory_order_relaxed);
+                if (config.queueSize > 0) {
+                    slot.worker = LoggerSinkWorker::Create(config.sink, config.queueSize, maxLineSize, config.overflowPolicy, spillConfig);
+                    if (!slot.worker) {
+                        m_sinks.clear();
+                        return false;
+                    }
+                }
+            }
+
+            std::lock_guard<std::mutex> levelLock(m_levelLock);
+            m_maxLevel = maxLevel;
+            UpdateEnabledLevel();
             return true;
         }
 
-        std::mutex m_lock;
+        //Called under m_levelLock
+        void UpdateEnabledLevel() noexcept {
+            int sinksLevel = static_cast<int>(LogLevel::Debug);
+            if (!m_sinks.empty()) {
+                sinksLevel = static_cast<int>(LogLevel::Error);
+                for (auto& slot : m_sinks) {
+                    sinksLevel = std::max(sinksLevel, static_cast<int>(slot.maxLevel.load(std::memory_order_relaxed)));
+                }
+            }
+
+            m_sinksLevel.store(static_cast<LogLevel>(sinksLevel), std::memory_order_relaxed);
+            m_enabledLevel.store(static_cast<LogLevel>(std::min(static_cast<int>(m_maxLevel), sinksLevel)), std::memory_order_relaxed);
+        }
+
+        //One buffer per thread, shared by every Write instantiation
+        std::span<char> GetThreadLineBuffer() const {
+            static thread_local std::vector<char> s_threadLineBuffer;
+            if (s_threadLineBuffer.size() < m_maxLineSize) {
+                s_threadLineBuffer.resize(m_maxLineSize);
+            }
+            return std::span<char>(s_threadLineBuffer.data(), m_maxLineSize);
+        }
+
+        //Called under m_lock
+        void WriteToSinks(LogLevel level, const char* data, size_t size) {
+            for (auto& slot : m_sinks) {
+                if (!slot.Accepts(level)) {
+                    continue;
+                }
+
+                if (slot.worker) {
+                    slot.worker->Push(data, size);
+                } else {
+                    slot.sink->Write(data, size);
+                }
+            }
+        }
+
+        //Called under m_lock
+        void WriteScatteredToSinks(LogLevel level, IoBuffer inlinePart, const LogSegment* spilled) {
+            m_scatterParts.clear();
+            m_scatterParts.push_back(inlinePart);
+            for (const LogSegment* segment = spilled; segment; segment = segment->next) {
+                m_scatterParts.push_back({ segment->data, segment->size });
+            }
+
+            for (auto& slot : m_sinks) {
+                if (!slot.Accepts(level)) {
+                    continue;
+                }
+
+                if (slot.worker) {
+                    slot.worker->PushScattered(m_scatterParts);
+                } else {
+                    slot.sink->WriteScattered(m_scatterParts);
+                }
+            }
+        }
+
+        //Called under m_lock with the batch collected by DrainQueue
+        void WriteBatchToSinks(LogLevel batchMaxLevel) {
+            for (auto& slot : m_sinks) {
+                if (slot.worker) {
+                    for (size_t i = 0; i < m_batch.size(); ++i) {
+                        if (slot.Accepts(m_batchLevels[i])) {
+                            slot.worker->Push(static_cast<const char*>(m_batch[i].data), m_batch[i].size);
+                        }
+                    }
+                    continue;
+                }
+
+                if (slot.Accepts(batchMaxLevel)) {
+                    slot.sink->WriteBatch(m_batch);
+                    continue;
+                }
+
+                m_sinkBatch.clear();
+                for (size_t i = 0; i < m_batch.size(); ++i) {
+                    if (slot.Accepts(m_batchLevels[i])) {
+                        m_sinkBatch.push_back(m_batch[i]);
+                    }
+                }
+
+                if (!m_sinkBatch.empty()) {
+                    slot.sink->WriteBatch(m_sinkBatch);
+                }
+            }
+        }
+
+        bool InitAsync(size_t maxLineSize, const LoggerAsyncConfig& config) {
+            if (config.queueSize == 0) {
+                return false;
+            }
+
+            //a coalesced run can end on every entry, each adding its summary to the batch
+            m_lineBuffer.resize(maxLineSize * MAX_BATCH_SIZE * 2);
+            m_batch.reserve(MAX_BATCH_SIZE * 2);
+            m_batchLevels.reserve(MAX_BATCH_SIZE * 2);
+            m_sinkBatch.reserve(MAX_BATCH_SIZE * 2);
+            m_queue = LogQueueWorker<QueueEntry>::Create(
+                config.queueSize,
+                config.overflowPolicy,
+                [maxLineSize](QueueEntry& entry) { entry.buffer.resize(maxLineSize); },
+                [this](LogQueueWorker<QueueEntry>& queue) { return DrainQueue(queue); }
+            );
+            return m_queue != nullptr;
+        }
+
+        template<typename... Args>
+        void WriteAsync(const LogSite& site, const char* format, Args&&... args) {
+            auto fFill = [&](QueueEntry& entry) {
+                TFormatter formatter;
+                LogEntryBuilder builder(entry.buffer, m_spillPool.get());
+                formatter.Format(builder, site, format, std::forward<Args>(args)...);
+                entry.size = builder.GetInlineSize();
+                entry.spilled = builder.TakeSpilled();
+                entry.level = site.GetLevel();
+                entry.coalesce = IsCoalescing();
+                if (entry.coalesce) {
+                    entry.key = MakeEntryKey(site, std::string_view(entry.buffer.data(), entry.size), entry.spilled);
+                }
+            };
+
+            m_queue->Push(fFill, [this](QueueEntry& entry) { ReleaseSpilled(entry.spilled); });
+        }
+
+        size_t DrainQueue(LogQueueWorker<QueueEntry>& queue) {
+            std::lock_guard lock(m_lock);
+
+            //copy the entries out so the slots are released before a slow sink gets to run
+            size_t batchSize = 0;
+            size_t numPopped = 0;
+            int batchMaxLevel = static_cast<int>(LogLevel::Error);
+            auto fAppend = [this, &batchSize, &batchMaxLevel](LogLevel level, size_t size) {
+                m_batch.push_back({ m_lineBuffer.data() + batchSize, size });
+                m_batchLevels.push_back(level);
+                batchSize += size;
+                batchMaxLevel = std::max(batchMaxLevel, static_cast<int>(level));
+            };
+
+            auto fConsume = [this, &batchSize, &numPopped, &fAppend](QueueEntry& entry) {
+                ++numPopped;
+                if (entry.coalesce) {
+                    if (m_coalescer.Add(entry.key, m_coalescingWindowNs.load(std::memory_order_relaxed))) {
+                        ReleaseSpilled(entry.spilled);
+                        return;
+                    }
+
+                    LogEntryKey key;
+                    if (uint64_t numRepeats = m_coalescer.TakeRepeats(key)) {
+                        fAppend(key.level, FormatRepeatSummary(numRepeats, key, std::span<char>(m_lineBuffer.data() + batchSize, m_maxLineSize)));
+                    }
+                }
+
+                memcpy(m_lineBuffer.data() + batchSize, entry.buffer.data(), entry.size);
+                fAppend(entry.level, entry.size);
+                m_batchSpilled = entry.spilled;
+                entry.spilled = nullptr;
+            };
+
+            size_t numDrained = 0;
+            for (;;) {
+                m_batch.clear();
+                m_batchLevels.clear();
+                batchSize = 0;
+                numPopped = 0;
+                batchMaxLevel = static_cast<int>(LogLevel::Error);
+                //a spilled entry ends the batch, it goes to the sinks on its own
+                while (numPopped < MAX_BATCH_SIZE && !m_batchSpilled && queue.TryPop(fConsume)) {}
+
+                if (!numPopped) {
+                    break;
+                }
+
+                IoBuffer spilledInlinePart{};
+                LogLevel spilledLevel = LogLevel::Debug;
+                if (m_batchSpilled) {
+                    spilledInlinePart = m_batch.back();
+                    spilledLevel = m_batchLevels.back();
+                    m_batch.pop_back();
+                    m_batchLevels.pop_back();
+                }
+
+                if (!m_batch.empty()) {
+                    WriteBatchToSinks(static_cast<LogLevel>(batchMaxLevel));
+                }
+
+                if (m_batchSpilled) {
+                    WriteScatteredToSinks(spilledLevel, spilledInlinePart, m_batchSpilled);
+                    ReleaseSpilled(m_batchSpilled);
+                }
+
+                queue.MarkProcessed(numPopped);
+                numDrained += numPopped;
+            }
+
+            return numDrained;
+        }
+
+        bool IsCoalescing() const noexcept {
+            return m_coalescingWindowNs.load(std::memory_order_relaxed) != 0;
+        }
+
+        static std::string_view GetEntryBody(std::string_view entry) noexcept {
+            if constexpr (requires { TFormatter::GetEntryBody(entry); }) {
+                return TFormatter::GetEntryBody(entry);
+            } else {
+                return entry;
+            }
+        }
+
+        LogEntryKey MakeEntryKey(const LogSite& site, std::string_view entry, const LogSegment* spilled) const noexcept {
+            LogEntryKey key;
+            key.hash = LogCoalescer::Hash(GetEntryBody(entry), LogCoalescer::Hash(site.GetPrefix(), static_cast<uint64_t>(site.GetLevel())));
+            for (const LogSegment* segment = spilled; segment; segment = segment->next) {
+                key.hash = LogCoalescer::Hash(std::string_view(segment->data, segment->size), key.hash);
+            }
+            key.timestampNs = TscClock::GetMonotonicNs();
+            key.level = site.GetLevel();
+            key.fileName = site.GetFileName();
+            key.function = site.GetFunction();
+            key.lineNumber = site.GetLineNumber();
+            return key;
+        }
+
+        size_t FormatRepeatSummary(uint64_t numRepeats, const LogEntryKey& key, std::span<char> buffer) noexcept {
+            LogSite site(key.level, key.fileName, key.function, key.lineNumber);
+            TFormatter formatter;
+            LogEntryBuilder builder(buffer);
+            formatter.Format(builder, site, "Previous message repeated %llu times", static_cast<unsigned long long>(numRepeats));
+            return builder.GetSizeWritten();
+        }
+
+        //Called under m_lock
+        void WriteRepeatSummary(uint64_t numRepeats, const LogEntryKey& key) {
+            if (!numRepeats) {
+                return;
+            }
+
+            size_t size = FormatRepeatSummary(numRepeats, key, m_summaryBuffer);
+            WriteToSinks(key.level, m_summaryBuffer.data(), size);
+        }
+
+        void ReleaseSpilled(LogSegment*& spilled) noexcept {
+            if (spilled) {
+                m_spillPool->Release(spilled);
+                spilled = nullptr;
+            }
+        }
+
+        void StopBackend() {
+            if (m_queue) {
+                m_queue->Stop();
+            }
+        }
+
+        static constexpr size_t MAX_BATCH_SIZE = 64;
+
+        ProfiledLock<std::mutex> m_lock{ "DefaultLogger" };
+        std::atomic<LogLevel> m_enabledLevel{ LogLevel::Debug }; // the lower of m_maxLevel and the highest sink level
+        std::atomic<LogLevel> m_sinksLevel{ LogLevel::Debug }; // the highest sink level
+        std::mutex m_levelLock;
         LogLevel m_maxLevel{ LogLevel::Debug };
-        std::vector<char> m_lineBuffer;
-        std::vector<std::shared_ptr<ILoggerSink>> m_sinks;
+        size_t m_maxLineSize{ 0 };
+        std::vector<char> m_lineBuffer; // staging for one batch of entries in async mode
+        std::vector<IoBuffer> m_batch;
+        std::vector<LogLevel> m_batchLevels;
+        std::vector<IoBuffer> m_sinkBatch;
+        std::unique_ptr<LogSegmentPool> m_spillPool;
+        LogSegment* m_batchSpilled{ nullptr }; // set by DrainQueue when the batch ends with a spilled entry
+        std::vector<IoBuffer> m_scatterParts;
+        std::vector<SinkSlot> m_sinks;
+
+        std::atomic<uint64_t> m_coalescingWindowNs{ 0 };
+        LogCoalescer m_coalescer;
+        std::vector<char> m_summaryBuffer;
+
+        std::unique_ptr<LogQueueWorker<QueueEntry>> m_queue;
     };
 }
\ No newline at end of file
@@ -0,0 +1,605 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "../thread/ThreadInfo.h"
+#include "../time/TscClock.h"
+#include "BinaryLogFormat.h"
+#include "ILoggerSink.h"
+#include "LogArgs.h"
+#include "LogCategory.h"
+#include "LogEntryBuilder.h"
+#include "LogLevel.h"
+#include "LogSiteRegistry.h"
+#include "LoggerAsyncConfig.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace AGT {
+    //False if the arguments don't match the site's format
+    template<typename TFormatter>
+    bool FormatDeferredEntry(
+        TFormatter& formatter,
+        LogEntryBuilder& builder,
+        const LogSiteDescriptor& site,
+        uint64_t timestampNs,
+        int pid,
+        uint64_t threadId,
+        std::span<const char> args
+    ) noexcept {
+        bool decoded = false;
+        formatter.FormatHeader(builder, site.level, timestampNs, pid, threadId, site.file, site.function, site.lineNumber);
+        formatter.WriteMessage(builder, [&](LogEntryBuilder& messageBuilder) {
+            decoded = LogArgs::Decode(messageBuilder, site.format, site.argTypes, args);
+        });
+        formatter.EndEntry(builder);
+        return decoded;
+    }
+
+    //NanoLog style logger. The calling thread only copies the call site id, a timestamp and the raw arguments
+    //into its own staging buffer. A backend thread polls the buffers and either formats the entries as text or
+    //emits the compact binary stream described in BinaryLogFormat.h, which BinaryLogReader turns into text later.
+    //Format strings are referenced by the call site registry, so they must be string literals.
+    //Entries are ordered per thread, not across threads.
+    template<typename TFormatter>
+    class DeferredLogger {
+    public:
+        static std::unique_ptr<DeferredLogger<TFormatter>> Create(LogLevel maxLevel, size_t maxLineSize, std::span<std::shared_ptr<ILoggerSink>> sinks) {
+            return Create(maxLevel, maxLineSize, sinks, DeferredLoggerConfig());
+        }
+
+        static std::unique_ptr<DeferredLogger<TFormatter>> Create(
+            LogLevel maxLevel,
+            size_t maxLineSize,
+            std::span<std::shared_ptr<ILoggerSink>> sinks,
+            const DeferredLoggerConfig& config
+        ) {
+            auto logger = std::unique_ptr<DeferredLogger<TFormatter>>(new DeferredLogger<TFormatter>());
+            if (logger && logger->Init(maxLevel, maxLineSize, sinks, config)) {
+                return logger;
+            }
+
+            return nullptr;
+        }
+
+        ~DeferredLogger() {
+            StopBackend();
+            Flush();
+
+            //threads drop their buffers of this logger the next time they add one
+            std::lock_guard<std::mutex> lock(m_buffersLock);
+            for (auto& buffer : m_buffers) {
+                buffer->Retire();
+            }
+        }
+
+        bool IsEnabled(LogLevel level) const noexcept {
+            return static_cast<int>(level) <= static_cast<int>(m_maxLevel.load(std::memory_order_relaxed));
+        }
+
+        //Takes effect on the next call from any thread
+        void SetMaxLevel(LogLevel maxLevel) noexcept {
+            m_maxLevel.store(maxLevel, std::memory_order_relaxed);
+        }
+
+        //A category with a level of its own replaces the logger's level
+        bool IsEnabled(LogLevel level, const LogCategory* category) const noexcept {
+            LogLevel categoryLevel;
+            if (!category || !category->GetLevel(categoryLevel)) {
+                return IsEnabled(level);
+            }
+            return static_cast<int>(level) <= static_cast<int>(categoryLevel);
+        }
+
+        template<typename... Args>
+        void Write(
+            LogSiteHandle& site,
+            LogLevel level,
+            const char* file,
+            const char* function,
+            int lineNumber,
+            const char* format,
+            const Args&... args
+        ) noexcept {
+            Write(site, nullptr, level, file, function, lineNumber, format, args...);
+        }
+
+        template<typename... Args>
+        void Write(
+            LogSiteHandle& site,
+            const LogCategory* category,
+            LogLevel level,
+            const char* file,
+            const char* function,
+            int lineNumber,
+            const char* format,
+            const Args&... args
+        ) noexcept {
+            if (!IsEnabled(level, category)) {
+                return;
+            }
+
+            uint32_t siteId = site.id.load(std::memory_order_acquire);
+            if (!siteId) {
+                siteId = LogSiteRegistry::Register<Args...>(site, level, file, function, lineNumber, format);
+                if (!siteId) {
+                    return;
+                }
+            }
+
+            ThreadBuffer* buffer = GetThreadBuffer();
+            size_t argsSize = (static_cast<size_t>(0) + ... + LogArgs::GetEncodedSize(args, m_maxLineSize));
+            size_t recordSize = ThreadBuffer::GetRecordSize(argsSize);
+
+            char* record = buffer->Reserve(recordSize);
+            while (!record) {
+                if (m_overflowPolicy != LogOverflowPolicy::Block || recordSize > buffer->GetMaxRecordSize()) {
+                    buffer->AddDropped();
+                    return;
+                }
+
+                std::this_thread::yield();
+                record = buffer->Reserve(recordSize);
+            }
+
+            RecordHeader header{ static_cast<uint32_t>(argsSize), siteId, TscClock::GetTicks() };
+            memcpy(record, &header, sizeof(header));
+
+            [[maybe_unused]] char* out = record + sizeof(header);
+            ((out = LogArgs::Encode(out, args, m_maxLineSize)), ...);
+
+            buffer->Commit();
+        }
+
+        //Waits until every entry written before the call has been handed to the sinks, then flushes them
+        void Flush() {
+            if (m_backend.joinable()) {
+                std::vector<std::pair<std::shared_ptr<ThreadBuffer>, size_t>> targets;
+                {
+                    std::lock_guard<std::mutex> lock(m_buffersLock);
+                    for (auto& buffer : m_buffers) {
+                        targets.emplace_back(buffer, buffer->GetWritePos());
+                    }
+                }
+
+                for (auto& [buffer, writePos] : targets) {
+                    while (buffer->GetReadPos() < writePos) {
+                        WakeBackend();
+                        std::this_thread::yield();
+                    }
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            for (auto& sink : m_sinks) {
+                sink->Flush();
+            }
+        }
+
+        //Number of entries discarded because a staging buffer was full
+        uint64_t GetDroppedCount() {
+            std::lock_guard<std::mutex> lock(m_buffersLock);
+            return m_droppedCount + std::accumulate(m_buffers.begin(), m_buffers.end(), uint64_t{ 0 }, [](uint64_t sum, auto& buffer) {
+                return sum + buffer->GetDroppedCount();
+            });
+        }
+
+        //Staging buffers of threads that wrote to the logger and haven't exited, or still hold entries
+        size_t GetNumThreadBuffers() {
+            std::lock_guard<std::mutex> lock(m_buffersLock);
+            return m_buffers.size();
+        }
+
+    private:
+        DeferredLogger(const DeferredLogger&) = delete;
+        DeferredLogger& operator=(const DeferredLogger&) = delete;
+
+        DeferredLogger() noexcept = default;
+
+        struct RecordHeader {
+            uint32_t argsSize;
+            uint32_t siteId; // 0 marks padding up to the end of the buffer
+            uint64_t ticks; // raw TscClock ticks, converted to nanoseconds on the backend
+        };
+
+        //Single producer, single consumer byte ring. Records are contiguous and 16 byte aligned.
+        class ThreadBuffer {
+        public:
+            static constexpr size_t CACHE_LINE_SIZE = 64;
+            static constexpr size_t ALIGNMENT = sizeof(RecordHeader);
+
+            ThreadBuffer(size_t capacity, uint64_t threadId) : m_threadId(threadId) {
+                m_capacity = 4096;
+                while (m_capacity < capacity) {
+                    m_capacity <<= 1;
+                }
+
+                m_data.reset(new char[m_capacity]);
+            }
+
+            static size_t GetRecordSize(size_t argsSize) noexcept {
+                return (sizeof(RecordHeader) + argsSize + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+            }
+
+            size_t GetMaxRecordSize() const noexcept {
+                return m_capacity / 2;
+            }
+
+            char* Reserve(size_t size) noexcept {
+                size_t writePos = m_writePos.load(std::memory_order_relaxed);
+                size_t offset = writePos & (m_capacity - 1);
+                size_t padding = offset + size > m_capacity ? m_capacity - offset : 0;
+                size_t required = padding + size;
+
+                if (required > m_capacity - (writePos - m_cachedReadPos)) {
+                    m_cachedReadPos = m_readPos.load(std::memory_order_acquire);
+                    if (required > m_capacity - (writePos - m_cachedReadPos)) {
+                        return nullptr;
+                    }
+                }
+
+                if (padding) {
+                    RecordHeader header{ static_cast<uint32_t>(padding - sizeof(RecordHeader)), 0, 0 };
+                    memcpy(m_data.get() + offset, &header, sizeof(header));
+                    offset = 0;
+                }
+
+                m_pendingSize = required;
+                return m_data.get() + offset;
+            }
+
+            void Commit() noexcept {
+                m_writePos.store(m_writePos.load(std::memory_order_relaxed) + m_pendingSize, std::memory_order_release);
+            }
+
+            //Backend side. Calls fConsume(const RecordHeader&, std::span<const char> args) for every committed record.
+            template<typename TFunc>
+            size_t Consume(TFunc&& fConsume) {
+                size_t readPos = m_readPos.load(std::memory_order_relaxed);
+                size_t writePos = m_writePos.load(std::memory_order_acquire);
+
+                size_t numRecords = 0;
+                while (readPos < writePos) {
+                    const char* record = m_data.get() + (readPos & (m_capacity - 1));
+
+                    RecordHeader header;
+                    memcpy(&header, record, sizeof(header));
+                    if (header.siteId) {
+                        fConsume(header, std::span<const char>(record + sizeof(header), header.argsSize));
+                        ++numRecords;
+                    }
+
+                    readPos += GetRecordSize(header.argsSize);
+                }
+
+                m_readPos.store(readPos, std::memory_order_release);
+                return numRecords;
+            }
+
+            size_t GetWritePos() const noexcept { return m_writePos.load(std::memory_order_acquire); }
+            size_t GetReadPos() const noexcept { return m_readPos.load(std::memory_order_acquire); }
+            bool IsEmpty() const noexcept { return GetReadPos() == GetWritePos(); }
+
+            uint64_t GetThreadId() const noexcept { return m_threadId; }
+
+            void AddDropped() noexcept { m_droppedCount.store(m_droppedCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+            uint64_t GetDroppedCount() const noexcept { return m_droppedCount.load(std::memory_order_relaxed); }
+
+            void Retire() noexcept { m_retired.store(true, std::memory_order_release); }
+            bool IsRetired() const noexcept { return m_retired.load(std::memory_order_acquire); }
+
+        private:
+            ThreadBuffer(const ThreadBuffer&) = delete;
+            ThreadBuffer& operator=(const ThreadBuffer&) = delete;
+
+            std::unique_ptr<char[]> m_data;
+            size_t m_capacity{ 0 };
+            uint64_t m_threadId{ 0 };
+
+            alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_writePos{ 0 };
+            size_t m_cachedReadPos{ 0 };
+            size_t m_pendingSize{ 0 };
+            std::atomic<uint64_t> m_droppedCount{ 0 };
+
+            alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_readPos{ 0 };
+            std::atomic<bool> m_retired{ false };
+        };
+
+        //The buffers of one thread, one per logger it writes to
+        struct ThreadBufferHolder {
+            ~ThreadBufferHolder() {
+                for (auto& [loggerId, buffer] : buffers) {
+                    buffer->Retire();
+                }
+            }
+
+            std::vector<std::pair<uint64_t, std::shared_ptr<ThreadBuffer>>> buffers;
+        };
+
+        bool Init(LogLevel maxLevel, size_t maxLineSize, std::span<std::shared_ptr<ILoggerSink>> sinks, const DeferredLoggerConfig& config) {
+            if (maxLineSize < 2 || config.threadBufferSize == 0) {
+                return false;
+            }
+
+            m_maxLevel.store(maxLevel, std::memory_order_relaxed);
+            m_maxLineSize = maxLineSize;
+            m_lineBuffer.resize(maxLineSize * MAX_BATCH_SIZE);
+            m_batch.reserve(MAX_BATCH_SIZE);
+            m_threadBufferSize = config.threadBufferSize;
+            m_overflowPolicy = config.overflowPolicy;
+            m_output = config.output;
+            m_pollInterval = config.pollInterval;
+            m_pid = ThreadInfo::GetProcessId();
+
+            m_sinks.reserve(sinks.size());
+            for (auto& sink : sinks) {
+                m_sinks.emplace_back(sink);
+            }
+
+            m_running.store(true, std::memory_order_release);
+            m_backend = std::thread([this]() { BackendLoop(); });
+            return true;
+        }
+
+        ThreadBuffer* GetThreadBuffer() {
+            static thread_local ThreadBufferHolder s_holder;
+            for (auto it = s_holder.buffers.rbegin(); it != s_holder.buffers.rend(); ++it) {
+                if (it->first == m_id) {
+                    return it->second.get();
+                }
+            }
+
+            //buffers of destroyed loggers are retired
+            std::erase_if(s_holder.buffers, [](const auto& entry) { return entry.second->IsRetired(); });
+
+            auto buffer = std::make_shared<ThreadBuffer>(m_threadBufferSize, ThreadInfo::GetThreadId());
+            s_holder.buffers.emplace_back(m_id, buffer);
+
+            std::lock_guard<std::mutex> lock(m_buffersLock);
+            m_buffers.emplace_back(std::move(buffer));
+            ++m_buffersVersion;
+            return s_holder.buffers.back().second.get();
+        }
+
+        void WakeBackend() {
+            std::lock_guard<std::mutex> lock(m_wakeLock);
+            m_wakeCondition.notify_one();
+        }
+
+        void BackendLoop() {
+            for (;;) {
+                bool running = m_running.load(std::memory_order_acquire);
+                if (DrainBuffers() > 0) {
+                    continue;
+                }
+
+                if (!running) {
+                    return;
+                }
+
+                //producers never signal, the backend polls so the hot path stays free of syscalls
+                std::unique_lock<std::mutex> lock(m_wakeLock);
+                if (m_running.load(std::memory_order_acquire)) {
+                    m_wakeCondition.wait_for(lock, m_pollInterval);
+                }
+            }
+        }
+
+        void RefreshBuffers() {
+            std::lock_guard<std::mutex> lock(m_buffersLock);
+
+            for (auto it = m_buffers.begin(); it != m_buffers.end();) {
+                if ((*it)->IsRetired() && (*it)->IsEmpty()) {
+                    m_droppedCount += (*it)->GetDroppedCount();
+                    it = m_buffers.erase(it);
+                    ++m_buffersVersion;
+                } else {
+                    ++it;
+                }
+            }
+
+            if (m_backendBuffersVersion != m_buffersVersion) {
+                m_backendBuffers = m_buffers;
+                m_backendBuffersVersion = m_buffersVersion;
+            }
+        }
+
+        size_t DrainBuffers() {
+            RefreshBuffers();
+
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            size_t numRecords = 0;
+            for (auto& buffer : m_backendBuffers) {
+                numRecords += buffer->Consume([this, &buffer](const RecordHeader& header, std::span<const char> args) {
+                    WriteRecord(*buffer, header, args);
+                });
+            }
+
+            WriteTextOutput();
+            WriteBinaryOutput();
+            return numRecords;
+        }
+
+        void WriteRecord(const ThreadBuffer& buffer, const RecordHeader& header, std::span<const char> args) {
+            const LogSiteDescriptor* site = LogSiteRegistry::Get(header.siteId);
+            if (!site) {
+                return;
+            }
+
+            uint64_t timestampNs = TscClock::TicksToEpochNs(header.ticks);
+            if (m_output == DeferredLogOutput::Text) {
+                char* line = m_lineBuffer.data() + m_batch.size() * m_maxLineSize;
+                LogEntryBuilder builder({ line, m_maxLineSize });
+                FormatDeferredEntry(m_formatter, builder, *site, timestampNs, m_pid, buffer.GetThreadId(), args);
+
+                m_batch.push_back({ line, builder.GetSizeWritten() });
+                if (m_batch.size() == MAX_BATCH_SIZE) {
+                    WriteTextOutput();
+                }
+                return;
+            }
+
+            if (!m_binaryStreamStarted) {
+                m_binaryOutput.push_back(static_cast<char>(BinaryLogRecord::Process));
+                AppendValue(m_binaryOutput, BinaryLogFormat::MAGIC);
+                AppendValue(m_binaryOutput, BinaryLogFormat::VERSION);
+                BinaryLogFormat::WriteVarint(m_binaryOutput, static_cast<uint64_t>(m_pid));
+                m_binaryStreamStarted = true;
+            }
+
+            if (m_emittedSites.size() <= site->id) {
+                m_emittedSites.resize(site->id + 1, false);
+            }
+
+            if (!m_emittedSites[site->id]) {
+                m_binaryOutput.push_back(static_cast<char>(BinaryLogRecord::Site));
+                BinaryLogFormat::WriteVarint(m_binaryOutput, site->id);
+                m_binaryOutput.push_back(static_cast<char>(site->level));
+                BinaryLogFormat::WriteVarint(m_binaryOutput, static_cast<uint64_t>(site->lineNumber));
+                BinaryLogFormat::WriteVarint(m_binaryOutput, site->argTypes.size());
+                for (LogArgType type : site->argTypes) {
+                    m_binaryOutput.push_back(static_cast<char>(type));
+                }
+                AppendString(m_binaryOutput, site->file);
+                AppendString(m_binaryOutput, site->function);
+                AppendString(m_binaryOutput, site->format);
+                m_emittedSites[site->id] = true;
+            }
+
+            if (!m_hasLastThreadId || m_lastThreadId != buffer.GetThreadId()) {
+                m_binaryOutput.push_back(static_cast<char>(BinaryLogRecord::Thread));
+                BinaryLogFormat::WriteVarint(m_binaryOutput, buffer.GetThreadId());
+                m_lastThreadId = buffer.GetThreadId();
+                m_hasLastThreadId = true;
+            }
+
+            m_binaryOutput.push_back(static_cast<char>(BinaryLogRecord::Entry));
+            BinaryLogFormat::WriteVarint(m_binaryOutput, site->id);
+            BinaryLogFormat::WriteVarint(m_binaryOutput, BinaryLogFormat::ZigZagEncode(static_cast<int64_t>(timestampNs - m_lastTimestamp)));
+            BinaryLogFormat::WriteVarint(m_binaryOutput, args.size());
+            m_binaryOutput.insert(m_binaryOutput.end(), args.begin(), args.end());
+            m_lastTimestamp = timestampNs;
+
+            if (m_binaryOutput.size() >= BINARY_OUTPUT_CHUNK_SIZE) {
+                WriteBinaryOutput();
+            }
+        }
+
+        void WriteTextOutput() {
+            if (m_batch.empty()) {
+                return;
+            }
+
+            for (auto& sink : m_sinks) {
+                sink->WriteBatch(m_batch);
+            }
+            m_batch.clear();
+        }
+
+        void WriteBinaryOutput() {
+            if (m_binaryOutput.empty()) {
+                return;
+            }
+
+            for (auto& sink : m_sinks) {
+                sink->Write(m_binaryOutput.data(), m_binaryOutput.size());
+            }
+            m_binaryOutput.clear();
+        }
+
+        template<typename T>
+        static void AppendValue(std::vector<char>& out, T value) {
+            const char* bytes = reinterpret_cast<const char*>(&value);
+            out.insert(out.end(), bytes, bytes + sizeof(value));
+        }
+
+        static void AppendString(std::vector<char>& out, const char* str) {
+            size_t size = str ? strlen(str) : 0;
+            BinaryLogFormat::WriteVarint(out, size);
+            out.insert(out.end(), str, str + size);
+        }
+
+        void StopBackend() {
+            if (!m_backend.joinable()) {
+                return;
+            }
+
+            m_running.store(false, std::memory_order_release);
+            WakeBackend();
+            m_backend.join();
+        }
+
+        static constexpr size_t MAX_BATCH_SIZE = 64;
+        static constexpr size_t BINARY_OUTPUT_CHUNK_SIZE = 64 * 1024;
+        static inline std::atomic<uint64_t> s_nextId{ 1 };
+
+        const uint64_t m_id{ s_nextId.fetch_add(1, std::memory_order_relaxed) };
+        std::atomic<LogLevel> m_maxLevel{ LogLevel::Debug };
+        size_t m_maxLineSize{ 0 };
+        size_t m_threadBufferSize{ 0 };
+        LogOverflowPolicy m_overflowPolicy{ LogOverflowPolicy::Block };
+        DeferredLogOutput m_output{ DeferredLogOutput::Text };
+        std::chrono::microseconds m_pollInterval{ 1000 };
+        int m_pid{ 0 };
+
+        std::mutex m_buffersLock;
+        std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+        uint64_t m_buffersVersion{ 0 };
+        uint64_t m_droppedCount{ 0 };
+
+        std::thread m_backend;
+        std::atomic<bool> m_running{ false };
+        std::mutex m_wakeLock;
+        std::condition_variable m_wakeCondition;
+
+        //backend state, guarded by m_lock
+        std::mutex m_lock;
+        std::vector<std::shared_ptr<ILoggerSink>> m_sinks;
+        std::vector<std::shared_ptr<ThreadBuffer>> m_backendBuffers;
+        uint64_t m_backendBuffersVersion{ 0 };
+        TFormatter m_formatter;
+        std::vector<char> m_lineBuffer; // one line per entry of the text batch
+        std::vector<IoBuffer> m_batch;
+        std::vector<char> m_binaryOutput;
+        std::vector<bool> m_emittedSites;
+        bool m_binaryStreamStarted{ false };
+        bool m_hasLastThreadId{ false };
+        uint64_t m_lastThreadId{ 0 };
+        uint64_t m_lastTimestamp{ 0 };
+    };
+}
@@ -0,0 +1,283 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "../platform/MappedFile.h"
+#include "../thread/ThreadInfo.h"
+#include "../time/TscClock.h"
+#include "BinaryLogFormat.h"
+#include "FlightRecorderFormat.h"
+#include "LogArgs.h"
+#include "LogLevel.h"
+#include "LogSiteRegistry.h"
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace AGT {
+    //Always-on record of the most recent log statements, kept in a memory mapped ring of fixed size slots.
+    //With AGT_ENABLE_FLIGHT_RECORDER the AGT_* macros record into the active recorder at every runtime level.
+    //Recording takes an atomic increment and a copy of the raw arguments, formatting happens in FlightRecorderReader.
+    //The ring lives in the page cache, so the file can be read after a crash or a hard kill.
+    class FlightRecorder {
+    public:
+        static constexpr size_t DEFAULT_NUM_SLOTS = 16384;
+        static constexpr size_t DEFAULT_SITE_TABLE_SIZE = 1024 * 1024;
+
+        //numSlots is rounded up to a power of two
+        static std::unique_ptr<FlightRecorder> Create(
+            const std::filesystem::path& path,
+            size_t numSlots = DEFAULT_NUM_SLOTS,
+            size_t siteTableSize = DEFAULT_SITE_TABLE_SIZE
+        ) {
+            auto recorder = std::unique_ptr<FlightRecorder>(new FlightRecorder());
+            if (recorder && recorder->Init(path, numSlots, siteTableSize)) {
+                return recorder;
+            }
+
+            return nullptr;
+        }
+
+        ~FlightRecorder() noexcept {
+            FlightRecorder* self = this;
+            s_active.compare_exchange_strong(self, nullptr, std::memory_order_acq_rel);
+            if (!m_header) {
+                return;
+            }
+
+            if (GetState() == FlightRecorderState::Running) {
+                SetState(FlightRecorderState::Closed);
+            }
+            m_file->Flush();
+        }
+
+        //The recorder the AGT_* macros write to. It must stay alive while it is active.
+        static void SetActive(FlightRecorder* recorder) noexcept {
+            s_active.store(recorder, std::memory_order_release);
+        }
+
+        static FlightRecorder* GetActive() noexcept {
+            return s_active.load(std::memory_order_acquire);
+        }
+
+        //Arguments that don't fit in a slot get their strings shortened, or are dropped if that isn't enough
+        template<typename... Args>
+        void Record(
+            LogSiteHandle& site,
+            LogLevel level,
+            const char* file,
+            const char* function,
+            int lineNumber,
+            const char* format,
+            const Args&... args
+        ) noexcept {
+            uint32_t siteId = site.id.load(std::memory_order_acquire);
+            if (!siteId) {
+                siteId = LogSiteRegistry::Register<Args...>(site, level, file, function, lineNumber, format);
+                if (!siteId) {
+                    return;
+                }
+            }
+
+            if (!IsSiteWritten(siteId)) {
+                WriteSite(siteId);
+            }
+
+            [[maybe_unused]] size_t maxStringSize = FlightRecorderFormat::MAX_ARGS_SIZE;
+            size_t argsSize = (static_cast<size_t>(0) + ... + LogArgs::GetEncodedSize(args, maxStringSize));
+            if (argsSize > FlightRecorderFormat::MAX_ARGS_SIZE) {
+                constexpr size_t numStrings = (static_cast<size_t>(0) + ... + IsLogStringArg<Args>::value);
+                size_t fixedSize = (static_cast<size_t>(0) + ... + LogArgs::GetEncodedSize(args, 0));
+                if (numStrings && fixedSize <= FlightRecorderFormat::MAX_ARGS_SIZE) {
+                    maxStringSize = (FlightRecorderFormat::MAX_ARGS_SIZE - fixedSize) / numStrings;
+                    argsSize = (static_cast<size_t>(0) + ... + LogArgs::GetEncodedSize(args, maxStringSize));
+                }
+            }
+
+            uint64_t sequence = std::atomic_ref<uint64_t>(m_header->nextSequence).fetch_add(1, std::memory_order_relaxed);
+            char* slot = m_slots + (sequence & m_slotMask) * FlightRecorderFormat::SLOT_SIZE;
+            auto* record = reinterpret_cast<FlightRecordHeader*>(slot);
+
+            //the sequence is cleared while the slot is written, so a record cut short by a crash is skipped by readers.
+            //Torn records go undetected only when a writer is lapped, i.e. another one a full ring ahead fills the same slot.
+            std::atomic_ref<uint64_t> slotSequence(record->sequence);
+            slotSequence.store(0, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            record->ticks = TscClock::GetTicks();
+            record->threadId = ThreadInfo::GetThreadId();
+            record->siteId = siteId;
+            record->level = static_cast<uint8_t>(level);
+            if (argsSize <= FlightRecorderFormat::MAX_ARGS_SIZE) {
+                record->argsSize = static_cast<uint16_t>(argsSize);
+                [[maybe_unused]] char* out = slot + sizeof(FlightRecordHeader);
+                ((out = LogArgs::Encode(out, args, maxStringSize)), ...);
+            } else {
+                record->argsSize = FlightRecorderFormat::ARGS_DROPPED;
+            }
+
+            slotSequence.store(sequence + 1, std::memory_order_release);
+        }
+
+        //Marks the file as crashed and starts writing it back. Only async-signal-safe calls, used by CrashHandler.
+        void OnCrash(int signal) noexcept {
+            std::atomic_ref<int32_t>(m_header->crashSignal).store(signal, std::memory_order_relaxed);
+            SetState(FlightRecorderState::Crashed);
+            m_file->Flush();
+        }
+
+        void Flush(bool wait = false) noexcept {
+            m_file->Flush(wait);
+        }
+
+        FlightRecorderState GetState() const noexcept {
+            return static_cast<FlightRecorderState>(std::atomic_ref<uint32_t>(m_header->state).load(std::memory_order_acquire));
+        }
+
+    private:
+        FlightRecorder(const FlightRecorder&) = delete;
+        FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+        FlightRecorder() noexcept = default;
+
+        static constexpr uint32_t MAX_SITES = LogSiteRegistry::CHUNK_SIZE * LogSiteRegistry::MAX_CHUNKS;
+
+        bool Init(const std::filesystem::path& path, size_t numSlots, size_t siteTableSize) {
+            if (numSlots == 0 || numSlots > UINT32_MAX / 2) {
+                return false;
+            }
+
+            numSlots = std::bit_ceil(numSlots);
+            siteTableSize = (siteTableSize + 7) & ~static_cast<size_t>(7);
+
+            uint64_t slotsOffset = FlightRecorderFormat::HEADER_SIZE + siteTableSize;
+            m_file = MappedFile::Create(path, slotsOffset + numSlots * FlightRecorderFormat::SLOT_SIZE);
+            if (!m_file) {
+                return false;
+            }
+
+            m_header = reinterpret_cast<FlightRecorderHeader*>(m_file->GetData());
+            m_siteTable = m_file->GetData() + FlightRecorderFormat::HEADER_SIZE;
+            m_siteTableSize = siteTableSize;
+            m_slots = m_file->GetData() + slotsOffset;
+            m_slotMask = numSlots - 1;
+            m_writtenSites = std::make_unique<std::atomic<uint64_t>[]>(MAX_SITES / 64);
+
+            uint64_t baseTicks = TscClock::GetTicks();
+
+            FlightRecorderHeader& header = *m_header;
+            header.magic = FlightRecorderFormat::MAGIC;
+            header.version = FlightRecorderFormat::VERSION;
+            header.slotSize = FlightRecorderFormat::SLOT_SIZE;
+            header.numSlots = static_cast<uint32_t>(numSlots);
+            header.siteTableOffset = FlightRecorderFormat::HEADER_SIZE;
+            header.siteTableSize = siteTableSize;
+            header.slotsOffset = slotsOffset;
+            header.pid = ThreadInfo::GetProcessId();
+            header.baseTicks = baseTicks;
+            header.baseEpochNs = TscClock::TicksToEpochNs(baseTicks);
+            header.ticksPerSecond = TscClock::GetTicksPerSecond();
+            header.siteTableUsed = 0;
+            header.nextSequence = 0;
+            header.crashSignal = 0;
+            SetState(FlightRecorderState::Running);
+            return true;
+        }
+
+        void SetState(FlightRecorderState state) noexcept {
+            std::atomic_ref<uint32_t>(m_header->state).store(static_cast<uint32_t>(state), std::memory_order_release);
+        }
+
+        bool IsSiteWritten(uint32_t siteId) const noexcept {
+            return siteId >= MAX_SITES
+                || (m_writtenSites[siteId / 64].load(std::memory_order_acquire) & (uint64_t{ 1 } << (siteId % 64)));
+        }
+
+        //Once per call site. If the table is full the site stays undescribed and the reader skips its records.
+        void WriteSite(uint32_t siteId) noexcept {
+            const LogSiteDescriptor* site = LogSiteRegistry::Get(siteId);
+            if (!site) {
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(m_siteLock);
+            if (IsSiteWritten(siteId)) {
+                return;
+            }
+
+            try {
+                m_siteRecord.clear();
+                BinaryLogFormat::WriteVarint(m_siteRecord, site->id);
+                m_siteRecord.push_back(static_cast<char>(site->level));
+                BinaryLogFormat::WriteVarint(m_siteRecord, static_cast<uint64_t>(site->lineNumber));
+                BinaryLogFormat::WriteVarint(m_siteRecord, site->argTypes.size());
+                for (LogArgType type : site->argTypes) {
+                    m_siteRecord.push_back(static_cast<char>(type));
+                }
+                AppendString(m_siteRecord, site->file);
+                AppendString(m_siteRecord, site->function);
+                AppendString(m_siteRecord, site->format);
+            } catch (...) {
+                return;
+            }
+
+            std::atomic_ref<uint64_t> used(m_header->siteTableUsed);
+            uint64_t offset = used.load(std::memory_order_relaxed);
+            uint32_t recordSize = static_cast<uint32_t>(m_siteRecord.size());
+            if (offset + sizeof(recordSize) + recordSize <= m_siteTableSize) {
+                memcpy(m_siteTable + offset, &recordSize, sizeof(recordSize));
+                memcpy(m_siteTable + offset + sizeof(recordSize), m_siteRecord.data(), recordSize);
+                used.store(offset + sizeof(recordSize) + recordSize, std::memory_order_release);
+            }
+
+            m_writtenSites[siteId / 64].fetch_or(uint64_t{ 1 } << (siteId % 64), std::memory_order_release);
+        }
+
+        static void AppendString(std::vector<char>& out, const char* str) {
+            size_t size = str ? strlen(str) : 0;
+            BinaryLogFormat::WriteVarint(out, size);
+            out.insert(out.end(), str, str + size);
+        }
+
+        static inline std::atomic<FlightRecorder*> s_active{ nullptr };
+
+        std::unique_ptr<MappedFile> m_file;
+        FlightRecorderHeader* m_header{ nullptr };
+        char* m_siteTable{ nullptr };
+        size_t m_siteTableSize{ 0 };
+        char* m_slots{ nullptr };
+        uint64_t m_slotMask{ 0 };
+
+        std::mutex m_siteLock;
+        std::vector<char> m_siteRecord;
+        std::unique_ptr<std::atomic<uint64_t>[]> m_writtenSites;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+namespace AGT {
+    //Layout of a FlightRecorder file: the header, a table of call site descriptors, then a ring of fixed size slots.
+    //The file is a shared mapping, so it is complete on disk even if the process is killed.
+    //
+    //  Site table: records of uint32 size followed by varint id, uint8 level, varint line, varint numArgs,
+    //              uint8 argTypes[numArgs], file, function, format (strings are a varint length and the characters)
+    //  Slot:       FlightRecordHeader followed by the arguments encoded with LogArgs
+    enum class FlightRecorderState : uint32_t {
+        Running = 1,
+        Closed = 2,
+        Crashed = 3
+    };
+
+    //Fields updated while recording are accessed through std::atomic_ref
+    struct FlightRecorderHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t slotSize;
+        uint32_t numSlots;
+        uint64_t siteTableOffset;
+        uint64_t siteTableSize;
+        uint64_t slotsOffset;
+        int32_t pid;
+        uint32_t reserved;
+
+        //converts slot ticks to nanoseconds since epoch
+        uint64_t baseTicks;
+        uint64_t baseEpochNs;
+        uint64_t ticksPerSecond;
+
+        uint64_t siteTableUsed;
+        uint64_t nextSequence;
+        uint32_t state;
+        int32_t crashSignal;
+    };
+
+    struct FlightRecordHeader {
+        uint64_t sequence; // sequence number + 1 once the slot is complete, 0 while it is being written
+        uint64_t ticks;
+        uint64_t threadId;
+        uint32_t siteId;
+        uint16_t argsSize;
+        uint8_t level;
+        uint8_t reserved;
+    };
+
+    class FlightRecorderFormat {
+    public:
+        static constexpr uint32_t MAGIC = 0x46544741; // "AGTF"
+        static constexpr uint32_t VERSION = 1;
+        static constexpr uint32_t SLOT_SIZE = 128;
+        static constexpr uint32_t MAX_ARGS_SIZE = SLOT_SIZE - sizeof(FlightRecordHeader);
+        static constexpr uint16_t ARGS_DROPPED = 0xFFFF; // the arguments didn't fit, only the format is kept
+        static constexpr uint64_t HEADER_SIZE = 4096;
+    };
+
+    static_assert(sizeof(FlightRecorderHeader) <= FlightRecorderFormat::HEADER_SIZE);
+    static_assert(sizeof(FlightRecordHeader) == 32);
+}
\ No newline at end of file
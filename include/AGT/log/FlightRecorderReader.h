@@ -0,0 +1,252 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "BinaryLogFormat.h"
+#include "FlightRecorderFormat.h"
+#include "ILoggerSink.h"
+#include "LogArgs.h"
+#include "LogEntryBuilder.h"
+#include "LogLevel.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace AGT {
+    //Recovers the entries of a FlightRecorder file, also one left behind by a crashed or killed process.
+    //Slots that were being written at the time are skipped, unless their writer had been lapped by one a full ring ahead.
+    template<typename TFormatter>
+    class FlightRecorderReader {
+    public:
+        static std::unique_ptr<FlightRecorderReader<TFormatter>> Open(const std::filesystem::path& path, size_t maxLineSize = 1024) {
+            auto reader = std::unique_ptr<FlightRecorderReader<TFormatter>>(new FlightRecorderReader<TFormatter>());
+            if (reader && reader->Init(path, maxLineSize)) {
+                return reader;
+            }
+
+            return nullptr;
+        }
+
+        FlightRecorderState GetState() const noexcept { return static_cast<FlightRecorderState>(m_header.state); }
+        int GetCrashSignal() const noexcept { return m_header.crashSignal; }
+        size_t GetNumEntries() const noexcept { return m_entries.size(); }
+
+        //Total number of statements recorded, including the ones overwritten since
+        uint64_t GetNumRecorded() const noexcept { return m_header.nextSequence; }
+
+        //Writes the recovered entries to the sink, oldest first
+        void Read(ILoggerSink& sink) {
+            for (const Entry& entry : m_entries) {
+                const FlightRecordHeader& record = entry.header;
+                auto it = m_sites.find(record.siteId);
+                if (it == m_sites.end()) {
+                    continue;
+                }
+
+                const Site& site = it->second;
+                LogEntryBuilder builder(m_lineBuffer);
+                m_formatter.FormatHeader(
+                    builder,
+                    static_cast<LogLevel>(record.level),
+                    TicksToEpochNs(record.ticks),
+                    m_header.pid,
+                    record.threadId,
+                    site.file.c_str(),
+                    site.function.c_str(),
+                    site.lineNumber
+                );
+
+                m_formatter.WriteMessage(builder, [&](LogEntryBuilder& messageBuilder) {
+                    if (record.argsSize == FlightRecorderFormat::ARGS_DROPPED
+                        || !LogArgs::Decode(messageBuilder, site.format.c_str(), site.argTypes, std::span<const char>(entry.args, record.argsSize))) {
+                        messageBuilder.Append(" [");
+                        messageBuilder.Append(site.format.c_str());
+                        messageBuilder.Append(']');
+                    }
+                });
+
+                m_formatter.EndEntry(builder);
+                sink.Write(m_lineBuffer.data(), builder.GetSizeWritten());
+            }
+        }
+
+    private:
+        FlightRecorderReader(const FlightRecorderReader&) = delete;
+        FlightRecorderReader& operator=(const FlightRecorderReader&) = delete;
+
+        FlightRecorderReader() noexcept = default;
+
+        struct Site {
+            int lineNumber{ 0 };
+            std::string file;
+            std::string function;
+            std::string format;
+            std::vector<LogArgType> argTypes;
+        };
+
+        struct Entry {
+            FlightRecordHeader header;
+            const char* args;
+        };
+
+        bool Init(const std::filesystem::path& path, size_t maxLineSize) {
+            std::ifstream file(path, std::ios::binary);
+            if (!file.is_open()) {
+                return false;
+            }
+
+            m_data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            if (m_data.size() < sizeof(m_header)) {
+                return false;
+            }
+
+            memcpy(&m_header, m_data.data(), sizeof(m_header));
+            if (m_header.magic != FlightRecorderFormat::MAGIC
+                || m_header.version != FlightRecorderFormat::VERSION
+                || m_header.slotSize != FlightRecorderFormat::SLOT_SIZE
+                || !std::has_single_bit(m_header.numSlots)
+                || m_header.siteTableUsed > m_header.siteTableSize
+                || m_header.siteTableOffset + m_header.siteTableSize > m_data.size()
+                || m_header.slotsOffset + static_cast<uint64_t>(m_header.numSlots) * m_header.slotSize > m_data.size()) {
+                return false;
+            }
+
+            m_lineBuffer.resize(maxLineSize < 2 ? 2 : maxLineSize);
+            ReadSites(std::span<const char>(m_data.data() + m_header.siteTableOffset, m_header.siteTableUsed));
+            ReadSlots();
+            return true;
+        }
+
+        //Stops at the first malformed record, the sites before it are still usable
+        void ReadSites(std::span<const char> data) {
+            size_t offset = 0;
+            uint32_t recordSize = 0;
+            while (ReadValue(data, offset, recordSize) && recordSize <= data.size() - offset) {
+                std::span<const char> record = data.subspan(offset, recordSize);
+                offset += recordSize;
+
+                size_t pos = 0;
+                uint64_t id = 0;
+                uint8_t level = 0;
+                uint64_t lineNumber = 0;
+                uint64_t numArgs = 0;
+                if (!BinaryLogFormat::ReadVarint(record, pos, id)
+                    || !ReadValue(record, pos, level)
+                    || !BinaryLogFormat::ReadVarint(record, pos, lineNumber)
+                    || !BinaryLogFormat::ReadVarint(record, pos, numArgs)
+                    || numArgs > record.size() - pos) {
+                    return;
+                }
+
+                Site site;
+                site.lineNumber = static_cast<int>(lineNumber);
+                for (uint64_t i = 0; i < numArgs; ++i) {
+                    site.argTypes.push_back(static_cast<LogArgType>(record[pos++]));
+                }
+
+                if (!ReadString(record, pos, site.file) || !ReadString(record, pos, site.function) || !ReadString(record, pos, site.format)) {
+                    return;
+                }
+
+                m_sites[static_cast<uint32_t>(id)] = std::move(site);
+            }
+        }
+
+        void ReadSlots() {
+            const char* slots = m_data.data() + m_header.slotsOffset;
+            uint64_t slotMask = m_header.numSlots - 1;
+            for (uint32_t i = 0; i < m_header.numSlots; ++i) {
+                const char* slot = slots + static_cast<size_t>(i) * m_header.slotSize;
+
+                Entry entry;
+                memcpy(&entry.header, slot, sizeof(entry.header));
+                entry.args = slot + sizeof(entry.header);
+
+                //empty, torn, or left over from an earlier lap that a newer record failed to complete
+                const FlightRecordHeader& record = entry.header;
+                if (record.sequence == 0
+                    || ((record.sequence - 1) & slotMask) != i
+                    || (record.argsSize > FlightRecorderFormat::MAX_ARGS_SIZE && record.argsSize != FlightRecorderFormat::ARGS_DROPPED)) {
+                    continue;
+                }
+
+                m_entries.push_back(entry);
+            }
+
+            std::sort(m_entries.begin(), m_entries.end(), [](const Entry& left, const Entry& right) {
+                return left.header.sequence < right.header.sequence;
+            });
+        }
+
+        uint64_t TicksToEpochNs(uint64_t ticks) const noexcept {
+            if (!m_header.ticksPerSecond) {
+                return m_header.baseEpochNs;
+            }
+
+            double deltaTicks = ticks >= m_header.baseTicks ?
+                static_cast<double>(ticks - m_header.baseTicks) :
+                -static_cast<double>(m_header.baseTicks - ticks);
+            return m_header.baseEpochNs + static_cast<int64_t>(deltaTicks * 1e9 / static_cast<double>(m_header.ticksPerSecond));
+        }
+
+        template<typename T>
+        static bool ReadValue(std::span<const char> data, size_t& offset, T& value) noexcept {
+            if (sizeof(T) > data.size() - offset) {
+                return false;
+            }
+
+            memcpy(&value, data.data() + offset, sizeof(T));
+            offset += sizeof(T);
+            return true;
+        }
+
+        static bool ReadString(std::span<const char> data, size_t& offset, std::string& str) {
+            uint64_t size = 0;
+            if (!BinaryLogFormat::ReadVarint(data, offset, size) || size > data.size() - offset) {
+                return false;
+            }
+
+            str.assign(data.data() + offset, size);
+            offset += size;
+            return true;
+        }
+
+        TFormatter m_formatter;
+        FlightRecorderHeader m_header{};
+        std::vector<char> m_data;
+        std::unordered_map<uint32_t, Site> m_sites;
+        std::vector<Entry> m_entries;
+        std::vector<char> m_lineBuffer;
+    };
+}
\ No newline at end of file
@@ -24,11 +24,31 @@ SOFTWARE.
 
 #pragma once
 
+#include "../platform/IoBuffer.h"
+
+#include <span>
+
 namespace AGT {
     class ILoggerSink {
     public:
         virtual ~ILoggerSink() noexcept {}
         virtual void Write(const char* /*msg*/, size_t /*size*/) {};
+
+        //Hands several entries to the sink at once, sinks that can gather writes should override it
+        virtual void WriteBatch(std::span<const IoBuffer> entries) {
+            for (const IoBuffer& entry : entries) {
+                Write(static_cast<const char*>(entry.data), entry.size);
+            }
+        }
+
+        //Hands over one entry split into parts, e.g. an entry that outgrew the logger's line buffer.
+        //Each part is null terminated. Sinks that need the entry in one piece should override it.
+        virtual void WriteScattered(std::span<const IoBuffer> parts) {
+            for (const IoBuffer& part : parts) {
+                Write(static_cast<const char*>(part.data), part.size);
+            }
+        }
+
         virtual void Flush() {};
     };
 }
\ No newline at end of file
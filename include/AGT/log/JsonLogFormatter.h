@@ -0,0 +1,345 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "../platform/Platform.h"
+#include "../thread/ThreadInfo.h"
+#include "../time/TscClock.h"
+#include "LogArgs.h"
+#include "LogCategory.h"
+#include "LogEntryBuilder.h"
+#include "LogLevel.h"
+#include "LogSite.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <string_view>
+
+#if defined(AGT_ARCH_X64)
+#include <immintrin.h>
+#endif
+
+namespace AGT {
+    //Writes every entry as one JSON object per line:
+    //{"timestamp":1700000000000000000,"level":"Warning","pid":12,"tid":34,"file":"Render.cpp","function":"Draw","line":42,"message":"..."}
+    //Sites of a category add a "category" field before the message. The message is formatted into a thread local
+    //buffer first, so it can be escaped as a whole. It spills like the entry if the builder has a pool.
+    //Otherwise a message that doesn't fit the line or MESSAGE_BUFFER_SIZE is cut before an escape sequence
+    //or UTF-8 character that would be split, and the entry gets a "truncated":true field, so the line stays
+    //valid JSON as long as the header fits.
+    class JsonLogFormatter {
+    public:
+        static constexpr size_t MESSAGE_BUFFER_SIZE = 4096;
+
+        JsonLogFormatter() noexcept = default;
+
+        template<typename... Args>
+        void Format(
+            LogEntryBuilder& builder,
+            const LogSite& site,
+            const char* format,
+            Args&&... args
+        ) noexcept {
+            static_assert((IsLogArg<Args> && ...), "Log arguments must be arithmetic values, enums, C strings or pointers");
+
+            uint64_t timestampNs = TscClock::GetTimeSinceEpochNs();
+
+            AppendHeader(builder, site.GetLevel(), timestampNs, ThreadInfo::GetProcessId(), ThreadInfo::GetThreadId(),
+                site.GetFileName(), site.GetFunction(), site.GetLineNumber(), site.GetCategory());
+            WriteMessage(builder, [&](LogEntryBuilder& messageBuilder) {
+                messageBuilder.Write(format, args...);
+            });
+            EndEntry(builder);
+        }
+
+        template<typename... Args>
+        void Format(
+            LogEntryBuilder& builder,
+            LogLevel level,
+            const char* file,
+            const char* function,
+            int lineNumber,
+            const char* format,
+            Args&&... args
+        ) noexcept {
+            LogSite site(level, GetLogFileName(file), function, lineNumber);
+            Format(builder, site, format, std::forward<Args>(args)...);
+        }
+
+        //Used when the fields were captured earlier, e.g. by the deferred logger backend
+        void FormatHeader(
+            LogEntryBuilder& builder,
+            LogLevel level,
+            uint64_t timestampNs,
+            int pid,
+            uint64_t threadId,
+            const char* file,
+            const char* function,
+            int lineNumber
+        ) noexcept {
+            AppendHeader(builder, level, timestampNs, pid, threadId, GetLogFileName(file ? file : ""), function, lineNumber, nullptr);
+        }
+
+        //Writes the message of an entry started with FormatHeader as an escaped JSON string
+        template<typename TWrite>
+        void WriteMessage(LogEntryBuilder& builder, TWrite&& fWrite) noexcept {
+            std::array<char, MESSAGE_BUFFER_SIZE>& message = GetMessageBuffer();
+            LogEntryBuilder messageBuilder(message, builder.GetSpillPool());
+            fWrite(messageBuilder);
+
+            //a truncated buffer counts its terminator
+            bool cut = messageBuilder.GetInlineSize() >= message.size();
+            std::string_view text(message.data(), std::min(messageBuilder.GetInlineSize(), message.size() - 1));
+            if (!builder.GetSpillPool()) {
+                //keeps room for the closing quote and brace, the line break and the terminator
+                size_t numLeft = builder.GetNumLeft();
+                if (cut || GetEscapedSize(text) + CLOSING.size() + 2 > numLeft) {
+                    text = cut ? TrimPartialCharacter(text) : text;
+                    AppendEscaped(builder, text, numLeft > TRUNCATED_CLOSING.size() + 2 ? numLeft - TRUNCATED_CLOSING.size() - 2 : 0);
+                    m_truncated = true;
+                } else {
+                    AppendEscaped(builder, text);
+                }
+                return;
+            }
+
+            AppendEscaped(builder, text);
+            for (const LogSegment* segment = messageBuilder.GetSpilled(); segment; segment = segment->next) {
+                AppendEscaped(builder, std::string_view(segment->data, segment->size));
+            }
+        }
+
+        //The entry without the timestamp, level, process and thread, used to detect repeated messages
+        static std::string_view GetEntryBody(std::string_view entry) noexcept {
+            size_t bodyBegin = entry.find(",\"file\":");
+            return bodyBegin == std::string_view::npos ? entry : entry.substr(bodyBegin);
+        }
+
+        //Closes the message and the object
+        void EndEntry(LogEntryBuilder& builder) noexcept {
+            builder.Append(m_truncated ? TRUNCATED_CLOSING : CLOSING);
+            m_truncated = false;
+            builder.EndLine(true);
+        }
+
+        //Appends str as a quoted JSON string
+        static void AppendString(LogEntryBuilder& builder, std::string_view str) noexcept {
+            builder.Append('"');
+            AppendEscaped(builder, str);
+            builder.Append('"');
+        }
+
+        //Appends str with '"', '\\' and control characters escaped. Runs without any of them are copied as is,
+        //so valid UTF-8 stays valid UTF-8.
+        static void AppendEscaped(LogEntryBuilder& builder, std::string_view str) noexcept {
+            for (;;) {
+                size_t pos = FindEscape(str.data(), str.size());
+                builder.Append(str.substr(0, pos));
+                if (pos == str.size()) {
+                    return;
+                }
+
+                AppendEscapedChar(builder, static_cast<unsigned char>(str[pos]));
+                str.remove_prefix(pos + 1);
+            }
+        }
+
+        //Same as AppendEscaped, but writes at most maxSize characters and never part of an escape sequence
+        //or of a UTF-8 character. Returns false if str was cut.
+        static bool AppendEscaped(LogEntryBuilder& builder, std::string_view str, size_t maxSize) noexcept {
+            for (;;) {
+                size_t pos = FindEscape(str.data(), str.size());
+                if (pos > maxSize) {
+                    //backs up to the lead byte of a character that doesn't fit
+                    size_t size = maxSize;
+                    while (size > 0 && (static_cast<unsigned char>(str[size]) & 0xC0) == 0x80) {
+                        --size;
+                    }
+                    builder.Append(str.substr(0, size));
+                    return false;
+                }
+
+                builder.Append(str.substr(0, pos));
+                if (pos == str.size()) {
+                    return true;
+                }
+
+                maxSize -= pos;
+                size_t escapedSize = GetEscapedCharSize(static_cast<unsigned char>(str[pos]));
+                if (escapedSize > maxSize) {
+                    return false;
+                }
+                AppendEscapedChar(builder, static_cast<unsigned char>(str[pos]));
+                maxSize -= escapedSize;
+                str.remove_prefix(pos + 1);
+            }
+        }
+
+        //Size of str once escaped
+        static size_t GetEscapedSize(std::string_view str) noexcept {
+            size_t size = 0;
+            for (;;) {
+                size_t pos = FindEscape(str.data(), str.size());
+                size += pos;
+                if (pos == str.size()) {
+                    return size;
+                }
+
+                size += GetEscapedCharSize(static_cast<unsigned char>(str[pos]));
+                str.remove_prefix(pos + 1);
+            }
+        }
+
+        //Index of the first character that has to be escaped, or size if there is none.
+        //Scans 32 bytes per step with AVX2 when the build enables it, 16 with SSE2 on x64.
+        static size_t FindEscape(const char* data, size_t size) noexcept {
+            size_t pos = 0;
+#if defined(__AVX2__)
+            const __m256i quote256 = _mm256_set1_epi8('"');
+            const __m256i backslash256 = _mm256_set1_epi8('\\');
+            const __m256i maxControl256 = _mm256_set1_epi8(0x1F);
+            for (; pos + 32 <= size; pos += 32) {
+                __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+                //min(c, 0x1F) == c only for control characters
+                __m256i special = _mm256_or_si256(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(chars, quote256), _mm256_cmpeq_epi8(chars, backslash256)),
+                    _mm256_cmpeq_epi8(_mm256_min_epu8(chars, maxControl256), chars));
+                uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(special));
+                if (mask) {
+                    return pos + std::countr_zero(mask);
+                }
+            }
+#endif
+#if defined(AGT_ARCH_X64)
+            const __m128i quote = _mm_set1_epi8('"');
+            const __m128i backslash = _mm_set1_epi8('\\');
+            const __m128i maxControl = _mm_set1_epi8(0x1F);
+            for (; pos + 16 <= size; pos += 16) {
+                __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+                __m128i special = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(chars, quote), _mm_cmpeq_epi8(chars, backslash)),
+                    _mm_cmpeq_epi8(_mm_min_epu8(chars, maxControl), chars));
+                uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(special));
+                if (mask) {
+                    return pos + std::countr_zero(mask);
+                }
+            }
+#endif
+            while (pos < size && !NeedsEscape(static_cast<unsigned char>(data[pos]))) {
+                ++pos;
+            }
+            return pos;
+        }
+
+    private:
+        static constexpr std::string_view CLOSING = "\"}";
+        static constexpr std::string_view TRUNCATED_CLOSING = "\",\"truncated\":true}";
+
+        bool m_truncated = false;
+
+        //Shared by every instantiation of WriteMessage, so a thread holds a single buffer
+        static std::array<char, MESSAGE_BUFFER_SIZE>& GetMessageBuffer() noexcept {
+            static thread_local std::array<char, MESSAGE_BUFFER_SIZE> s_message;
+            return s_message;
+        }
+
+        static constexpr bool NeedsEscape(unsigned char c) noexcept {
+            return c < 0x20 || c == '"' || c == '\\';
+        }
+
+        static constexpr size_t GetEscapedCharSize(unsigned char c) noexcept {
+            return c == '"' || c == '\\' || c == '\b' || c == '\f' || c == '\n' || c == '\r' || c == '\t' ? 2 : 6;
+        }
+
+        //Drops a UTF-8 character that was cut off at the end of str
+        static std::string_view TrimPartialCharacter(std::string_view str) noexcept {
+            size_t numContinuation = 0;
+            while (numContinuation < 3 && numContinuation < str.size()
+                && (static_cast<unsigned char>(str[str.size() - 1 - numContinuation]) & 0xC0) == 0x80) {
+                ++numContinuation;
+            }
+            if (numContinuation == str.size()) {
+                return str;
+            }
+
+            unsigned char lead = static_cast<unsigned char>(str[str.size() - 1 - numContinuation]);
+            size_t charSize = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 1;
+            return charSize > numContinuation + 1 ? str.substr(0, str.size() - numContinuation - 1) : str;
+        }
+
+        static void AppendEscapedChar(LogEntryBuilder& builder, unsigned char c) noexcept {
+            switch (c) {
+            case '"':  builder.Append(std::string_view("\\\"")); break;
+            case '\\': builder.Append(std::string_view("\\\\")); break;
+            case '\b': builder.Append(std::string_view("\\b")); break;
+            case '\f': builder.Append(std::string_view("\\f")); break;
+            case '\n': builder.Append(std::string_view("\\n")); break;
+            case '\r': builder.Append(std::string_view("\\r")); break;
+            case '\t': builder.Append(std::string_view("\\t")); break;
+            default: {
+                const char* digits = "0123456789abcdef";
+                const char escaped[6] = { '\\', 'u', '0', '0', digits[c >> 4], digits[c & 0xF] };
+                builder.Append(std::string_view(escaped, sizeof(escaped)));
+                break;
+            }
+            }
+        }
+
+        //Everything up to the opening quote of the message
+        static void AppendHeader(
+            LogEntryBuilder& builder,
+            LogLevel level,
+            uint64_t timestampNs,
+            int pid,
+            uint64_t threadId,
+            const char* file,
+            const char* function,
+            int lineNumber,
+            const LogCategory* category
+        ) noexcept {
+            builder.Append(std::string_view("{\"timestamp\":"));
+            builder.Append(timestampNs);
+            builder.Append(std::string_view(",\"level\":\""));
+            builder.Append(LogLevelToString(level));
+            builder.Append(std::string_view("\",\"pid\":"));
+            builder.Append(pid);
+            builder.Append(std::string_view(",\"tid\":"));
+            builder.Append(threadId);
+            builder.Append(std::string_view(",\"file\":"));
+            AppendString(builder, file ? file : "");
+            builder.Append(std::string_view(",\"function\":"));
+            AppendString(builder, function ? function : "");
+            builder.Append(std::string_view(",\"line\":"));
+            builder.Append(lineNumber);
+            if (category) {
+                builder.Append(std::string_view(",\"category\":"));
+                AppendString(builder, category->GetName());
+            }
+            builder.Append(std::string_view(",\"message\":\""));
+        }
+    };
+}
\ No newline at end of file
@@ -24,39 +24,325 @@ SOFTWARE.
 
 #pragma once
 
+#include "LogLevel.h"
+
+//Most verbose level compiled in. Statements above it expand to nothing, arguments included.
+#ifndef AGT_MAX_LOG_LEVEL
+#ifdef AGT_ENABLE_DEBUG_LOG
+#define AGT_MAX_LOG_LEVEL AGT_LOG_LEVEL_DEBUG
+#else
+#define AGT_MAX_LOG_LEVEL AGT_LOG_LEVEL_INFO_V3
+#endif
+#endif //AGT_MAX_LOG_LEVEL
+
 #ifdef AGT_ENABLE_LOGGING
 
-#if !defined(AGT_ERR) && !defined(AGT_WARN) && !defined(AGT_INFO) && !defined(AGT_VERBOSE) && !defined(AGT_DEBUG)
+#if !defined(AGT_ERR) && !defined(AGT_WARN) && !defined(AGT_INFO) && !defined(AGT_INFO_V2) && !defined(AGT_VERBOSE) && !defined(AGT_DEBUG)
 
-#include "DefaultLogger.h"
 #include "DefaultLogFormatter.h"
 #include "../other/StaticHolder.h"
 
+#include "LogSite.h"
+#include "LogThrottle.h"
+
+//The runtime level is checked with a relaxed load before any argument is evaluated.
+//The unevaluated CheckLogFormat call lets the compiler validate the format against the arguments.
+#define AGT_CHECK_LOG_FORMAT(format, ...) \
+    if (false) { \
+        AGT::CheckLogFormat(format, ##__VA_ARGS__); \
+    }
+
+#ifdef AGT_ENABLE_DEFERRED_LOGGING
+#include "DeferredLogger.h"
+
+namespace AGT {
+    using LoggerT = AGT::DeferredLogger<AGT::DefaultLogFormatter>;
+}
+
+namespace AGT {
+    inline void WriteSuppressedSummary(LoggerT& logger, LogThrottle& throttle, uint64_t count) noexcept {
+        logger.Write(
+            throttle.GetSummarySite(),
+            throttle.GetLevel(),
+            throttle.GetFileName(),
+            throttle.GetFunction(),
+            throttle.GetLineNumber(),
+            "Suppressed %llu messages",
+            static_cast<unsigned long long>(count)
+        );
+    }
+}
+
+//each call site registers itself once, so the format must be a string literal
+#define AGT_WRITE_LOG_SITE(category, level, function, format, ...) \
+    static AGT::LogSiteHandle s_agtLogSite; \
+    agtLogger->Write(s_agtLogSite, category, level, s_agtFileName, function, __LINE__, format, ##__VA_ARGS__);
+
+#else
+#include "DefaultLogger.h"
+
 namespace AGT {
     using LoggerT = AGT::DefaultLogger<AGT::DefaultLogFormatter>;
 }
 
-#define AGT_ERR(format, ...)        AGT::StaticHolder<AGT::LoggerT>::Get()->Write(AGT::LogLevel::Error, __FILE__, __func__, __LINE__, format, __VA_ARGS__)
-#define AGT_WARN(format, ...)       AGT::StaticHolder<AGT::LoggerT>::Get()->Write(AGT::LogLevel::Warning, __FILE__, __func__, __LINE__, format, __VA_ARGS__)
-#define AGT_INFO(format, ...)       AGT::StaticHolder<AGT::LoggerT>::Get()->Write(AGT::LogLevel::InfoV1, __FILE__, __func__, __LINE__, format, __VA_ARGS__)
-#define AGT_VERBOSE(format, ...)    AGT::StaticHolder<AGT::LoggerT>::Get()->Write(AGT::LogLevel::InfoV3, __FILE__, __func__, __LINE__, format, __VA_ARGS__)
+namespace AGT {
+    inline void WriteSuppressedSummary(LoggerT& logger, LogThrottle& throttle, uint64_t count) {
+        logger.Write(
+            throttle.GetLevel(),
+            throttle.GetFileName(),
+            throttle.GetFunction(),
+            throttle.GetLineNumber(),
+            "Suppressed %llu messages",
+            static_cast<unsigned long long>(count)
+        );
+    }
+}
+
+#define AGT_WRITE_LOG_SITE(category, level, function, format, ...) \
+    static const AGT::LogSite s_agtLogSite(level, s_agtFileName, function, __LINE__, category); \
+    agtLogger->Write(s_agtLogSite, format, ##__VA_ARGS__);
 
-#ifdef AGT_ENABLE_DEBUG_LOG
-#define AGT_DEBUG(format, ...)      AGT::StaticHolder<AGT::LoggerT>::Get()->Write(AGT::LogLevel::Debug, __FILE__, __func__, __LINE__, format, __VA_ARGS__)
+#endif //AGT_ENABLE_DEFERRED_LOGGING
+
+#ifdef AGT_ENABLE_FLIGHT_RECORDER
+#include "FlightRecorder.h"
+
+namespace AGT {
+    inline void RecordSuppressedSummary(LogThrottle& throttle, uint64_t count) noexcept {
+        if (FlightRecorder* recorder = FlightRecorder::GetActive()) {
+            recorder->Record(
+                throttle.GetSummarySite(),
+                throttle.GetLevel(),
+                throttle.GetFileName(),
+                throttle.GetFunction(),
+                throttle.GetLineNumber(),
+                "Suppressed %llu messages",
+                static_cast<unsigned long long>(count)
+            );
+        }
+    }
+}
+
+//Statements are also copied to the active FlightRecorder, whatever the runtime level. The condition is checked
+//once when either of them takes the statement and gates both. The arguments are evaluated once, as the lambda's
+//parameters, and shared by both.
+#define AGT_LOG_IF_IMPL(category, level, condition, format, ...) \
+    do { \
+        auto& agtLogger = AGT::StaticHolder<AGT::LoggerT>::Get(); \
+        bool agtLogEnabled = agtLogger && agtLogger->IsEnabled(level, category); \
+        AGT::FlightRecorder* agtRecorder = AGT::FlightRecorder::GetActive(); \
+        if ((agtLogEnabled || agtRecorder) && (condition)) { \
+            static constexpr const char* s_agtFileName = AGT::GetLogFileName(__FILE__); \
+            static AGT::LogSiteHandle s_agtRecorderSite; \
+            const char* agtFunction = __func__; \
+            [&](const auto&... agtArgs) { \
+                if (agtRecorder) { \
+                    agtRecorder->Record(s_agtRecorderSite, level, s_agtFileName, agtFunction, __LINE__, format, agtArgs...); \
+                } \
+                if (agtLogEnabled) { \
+                    AGT_WRITE_LOG_SITE(category, level, agtFunction, format, agtArgs...) \
+                } \
+            }(__VA_ARGS__); \
+        } \
+        AGT_CHECK_LOG_FORMAT(format, ##__VA_ARGS__) \
+    } while (0)
+
+#else
+
+namespace AGT {
+    inline void RecordSuppressedSummary(LogThrottle& /*throttle*/, uint64_t /*count*/) noexcept {}
+}
+
+#define AGT_LOG_IF_IMPL(category, level, condition, format, ...) \
+    do { \
+        auto& agtLogger = AGT::StaticHolder<AGT::LoggerT>::Get(); \
+        bool agtLogEnabled = agtLogger && agtLogger->IsEnabled(level, category); \
+        if (agtLogEnabled && (condition)) { \
+            static constexpr const char* s_agtFileName = AGT::GetLogFileName(__FILE__); \
+            AGT_WRITE_LOG_SITE(category, level, __func__, format, ##__VA_ARGS__) \
+        } \
+        AGT_CHECK_LOG_FORMAT(format, ##__VA_ARGS__) \
+    } while (0)
+
+#endif //AGT_ENABLE_FLIGHT_RECORDER
+
+namespace AGT {
+    inline void ReportSuppressed(LoggerT& logger, LogThrottle& throttle, uint64_t count) {
+        RecordSuppressedSummary(throttle, count);
+        WriteSuppressedSummary(logger, throttle, count);
+    }
+
+    //Checked once per call that the logger or the flight recorder would take, logger is null if only the recorder does.
+    //A call that gets through first reports the calls suppressed before it.
+    inline bool ShouldWriteThrottled(LoggerT* logger, LogThrottle& throttle) {
+        if (!throttle.ShouldLog()) {
+            return false;
+        }
+
+        if (uint64_t count = throttle.TakeSuppressedCount()) {
+            RecordSuppressedSummary(throttle, count);
+            if (logger) {
+                WriteSuppressedSummary(*logger, throttle, count);
+            }
+        }
+        return true;
+    }
+}
+
+//AGT_LOG_IF_IMPL evaluates the condition only for an enabled level or an active flight recorder, before the arguments
+#define AGT_LOG_IMPL(category, level, format, ...) AGT_LOG_IF_IMPL(category, level, true, format, ##__VA_ARGS__)
+
+#define AGT_LOG(level, format, ...) AGT_LOG_IMPL(nullptr, level, format, ##__VA_ARGS__)
+
+//Same as AGT_LOG for a statement of an AGT::LogCategory, enabled by the category's level when it has one
+#define AGT_LOG_CAT(category, level, format, ...) AGT_LOG_IMPL(&(category), level, format, ##__VA_ARGS__)
+
+//Same as AGT_LOG but limited by a per call site LogThrottle. Disabled levels skip the throttle entirely unless
+//a flight recorder is active, suppressed calls are summarized by the next message from the site.
+//A suppressed call costs the throttle check only, the recorder gets the same calls and summaries as the logger.
+#define AGT_LOG_THROTTLED(level, mode, limit, format, ...) \
+    do { \
+        static AGT::LogThrottle s_agtThrottle(mode, limit, level, AGT::GetLogFileName(__FILE__), __func__, __LINE__); \
+        AGT_LOG_IF_IMPL(nullptr, level, AGT::ShouldWriteThrottled(agtLogEnabled ? agtLogger.get() : nullptr, s_agtThrottle), format, ##__VA_ARGS__); \
+    } while (0)
+
+namespace AGT {
+    //Reports suppressed counts of throttled sites that have not logged since, e.g. once per frame or at shutdown
+    inline void LogSuppressedSummary() {
+        auto& logger = StaticHolder<LoggerT>::Get();
+        if (!logger) {
+            return;
+        }
 
+        LogThrottle::ForEachSuppressed([&logger](LogThrottle& throttle, uint64_t count) {
+            ReportSuppressed(*logger, throttle, count);
+        });
+    }
+}
+
+#define AGT_LOG_SUPPRESSED_SUMMARY() AGT::LogSuppressedSummary()
+
+#if AGT_MAX_LOG_LEVEL >= AGT_LOG_LEVEL_ERROR
+#define AGT_ERR(format, ...)        AGT_LOG(AGT::LogLevel::Error, format, ##__VA_ARGS__)
+#define AGT_ERR_EVERY_N(n, format, ...)         AGT_LOG_THROTTLED(AGT::LogLevel::Error, AGT::LogThrottleMode::EveryN, n, format, ##__VA_ARGS__)
+#define AGT_ERR_FIRST_N(n, format, ...)         AGT_LOG_THROTTLED(AGT::LogLevel::Error, AGT::LogThrottleMode::FirstN, n, format, ##__VA_ARGS__)
+#define AGT_ERR_RATE(perSecond, format, ...)    AGT_LOG_THROTTLED(AGT::LogLevel::Error, AGT::LogThrottleMode::Rate, perSecond, format, ##__VA_ARGS__)
+#define AGT_ERR_CAT(category, format, ...)      AGT_LOG_CAT(category, AGT::LogLevel::Error, format, ##__VA_ARGS__)
+#else
+#define AGT_ERR(format, ...)        ((void)0)
+#define AGT_ERR_EVERY_N(n, format, ...)         ((void)0)
+#define AGT_ERR_FIRST_N(n, format, ...)         ((void)0)
+#define AGT_ERR_RATE(perSecond, format, ...)    ((void)0)
+#define AGT_ERR_CAT(category, format, ...)      ((void)0)
+#endif
+
+#if AGT_MAX_LOG_LEVEL >= AGT_LOG_LEVEL_WARNING
+#define AGT_WARN(format, ...)       AGT_LOG(AGT::LogLevel::Warning, format, ##__VA_ARGS__)
+#define AGT_WARN_EVERY_N(n, format, ...)        AGT_LOG_THROTTLED(AGT::LogLevel::Warning, AGT::LogThrottleMode::EveryN, n, format, ##__VA_ARGS__)
+#define AGT_WARN_FIRST_N(n, format, ...)        AGT_LOG_THROTTLED(AGT::LogLevel::Warning, AGT::LogThrottleMode::FirstN, n, format, ##__VA_ARGS__)
+#define AGT_WARN_RATE(perSecond, format, ...)   AGT_LOG_THROTTLED(AGT::LogLevel::Warning, AGT::LogThrottleMode::Rate, perSecond, format, ##__VA_ARGS__)
+#define AGT_WARN_CAT(category, format, ...)     AGT_LOG_CAT(category, AGT::LogLevel::Warning, format, ##__VA_ARGS__)
 #else
-#define AGT_DEBUG(format, ...) 
+#define AGT_WARN(format, ...)       ((void)0)
+#define AGT_WARN_EVERY_N(n, format, ...)        ((void)0)
+#define AGT_WARN_FIRST_N(n, format, ...)        ((void)0)
+#define AGT_WARN_RATE(perSecond, format, ...)   ((void)0)
+#define AGT_WARN_CAT(category, format, ...)     ((void)0)
+#endif
 
-#endif //AGT_ENABLE_DEBUG_LOG
+#if AGT_MAX_LOG_LEVEL >= AGT_LOG_LEVEL_INFO_V1
+#define AGT_INFO(format, ...)       AGT_LOG(AGT::LogLevel::InfoV1, format, ##__VA_ARGS__)
+#define AGT_INFO_EVERY_N(n, format, ...)        AGT_LOG_THROTTLED(AGT::LogLevel::InfoV1, AGT::LogThrottleMode::EveryN, n, format, ##__VA_ARGS__)
+#define AGT_INFO_FIRST_N(n, format, ...)        AGT_LOG_THROTTLED(AGT::LogLevel::InfoV1, AGT::LogThrottleMode::FirstN, n, format, ##__VA_ARGS__)
+#define AGT_INFO_RATE(perSecond, format, ...)   AGT_LOG_THROTTLED(AGT::LogLevel::InfoV1, AGT::LogThrottleMode::Rate, perSecond, format, ##__VA_ARGS__)
+#define AGT_INFO_CAT(category, format, ...)     AGT_LOG_CAT(category, AGT::LogLevel::InfoV1, format, ##__VA_ARGS__)
+#else
+#define AGT_INFO(format, ...)       ((void)0)
+#define AGT_INFO_EVERY_N(n, format, ...)        ((void)0)
+#define AGT_INFO_FIRST_N(n, format, ...)        ((void)0)
+#define AGT_INFO_RATE(perSecond, format, ...)   ((void)0)
+#define AGT_INFO_CAT(category, format, ...)     ((void)0)
+#endif
 
-#endif !defined(AGT_ERR) && !defined(AGT_WARN) && !defined(AGT_INFO) && !defined(AGT_VERBOSE) && !defined(AGT_DEBUG)
+#if AGT_MAX_LOG_LEVEL >= AGT_LOG_LEVEL_INFO_V2
+#define AGT_INFO_V2(format, ...)    AGT_LOG(AGT::LogLevel::InfoV2, format, ##__VA_ARGS__)
+#define AGT_INFO_V2_EVERY_N(n, format, ...)     AGT_LOG_THROTTLED(AGT::LogLevel::InfoV2, AGT::LogThrottleMode::EveryN, n, format, ##__VA_ARGS__)
+#define AGT_INFO_V2_FIRST_N(n, format, ...)     AGT_LOG_THROTTLED(AGT::LogLevel::InfoV2, AGT::LogThrottleMode::FirstN, n, format, ##__VA_ARGS__)
+#define AGT_INFO_V2_RATE(perSecond, format, ...)AGT_LOG_THROTTLED(AGT::LogLevel::InfoV2, AGT::LogThrottleMode::Rate, perSecond, format, ##__VA_ARGS__)
+#define AGT_INFO_V2_CAT(category, format, ...)  AGT_LOG_CAT(category, AGT::LogLevel::InfoV2, format, ##__VA_ARGS__)
+#else
+#define AGT_INFO_V2(format, ...)    ((void)0)
+#define AGT_INFO_V2_EVERY_N(n, format, ...)     ((void)0)
+#define AGT_INFO_V2_FIRST_N(n, format, ...)     ((void)0)
+#define AGT_INFO_V2_RATE(perSecond, format, ...)((void)0)
+#define AGT_INFO_V2_CAT(category, format, ...)  ((void)0)
+#endif
+
+#if AGT_MAX_LOG_LEVEL >= AGT_LOG_LEVEL_INFO_V3
+#define AGT_VERBOSE(format, ...)    AGT_LOG(AGT::LogLevel::InfoV3, format, ##__VA_ARGS__)
+#define AGT_VERBOSE_EVERY_N(n, format, ...)     AGT_LOG_THROTTLED(AGT::LogLevel::InfoV3, AGT::LogThrottleMode::EveryN, n, format, ##__VA_ARGS__)
+#define AGT_VERBOSE_FIRST_N(n, format, ...)     AGT_LOG_THROTTLED(AGT::LogLevel::InfoV3, AGT::LogThrottleMode::FirstN, n, format, ##__VA_ARGS__)
+#define AGT_VERBOSE_RATE(perSecond, format, ...)AGT_LOG_THROTTLED(AGT::LogLevel::InfoV3, AGT::LogThrottleMode::Rate, perSecond, format, ##__VA_ARGS__)
+#define AGT_VERBOSE_CAT(category, format, ...)  AGT_LOG_CAT(category, AGT::LogLevel::InfoV3, format, ##__VA_ARGS__)
+#else
+#define AGT_VERBOSE(format, ...)    ((void)0)
+#define AGT_VERBOSE_EVERY_N(n, format, ...)     ((void)0)
+#define AGT_VERBOSE_FIRST_N(n, format, ...)     ((void)0)
+#define AGT_VERBOSE_RATE(perSecond, format, ...)((void)0)
+#define AGT_VERBOSE_CAT(category, format, ...)  ((void)0)
+#endif
+
+#if AGT_MAX_LOG_LEVEL >= AGT_LOG_LEVEL_DEBUG
+#define AGT_DEBUG(format, ...)      AGT_LOG(AGT::LogLevel::Debug, format, ##__VA_ARGS__)
+#define AGT_DEBUG_EVERY_N(n, format, ...)       AGT_LOG_THROTTLED(AGT::LogLevel::Debug, AGT::LogThrottleMode::EveryN, n, format, ##__VA_ARGS__)
+#define AGT_DEBUG_FIRST_N(n, format, ...)       AGT_LOG_THROTTLED(AGT::LogLevel::Debug, AGT::LogThrottleMode::FirstN, n, format, ##__VA_ARGS__)
+#define AGT_DEBUG_RATE(perSecond, format, ...)  AGT_LOG_THROTTLED(AGT::LogLevel::Debug, AGT::LogThrottleMode::Rate, perSecond, format, ##__VA_ARGS__)
+#define AGT_DEBUG_CAT(category, format, ...)    AGT_LOG_CAT(category, AGT::LogLevel::Debug, format, ##__VA_ARGS__)
+#else
+#define AGT_DEBUG(format, ...)      ((void)0)
+#define AGT_DEBUG_EVERY_N(n, format, ...)       ((void)0)
+#define AGT_DEBUG_FIRST_N(n, format, ...)       ((void)0)
+#define AGT_DEBUG_RATE(perSecond, format, ...)  ((void)0)
+#define AGT_DEBUG_CAT(category, format, ...)    ((void)0)
+#endif
+
+#endif //!defined(AGT_ERR) && !defined(AGT_WARN) && !defined(AGT_INFO) && !defined(AGT_INFO_V2) && !defined(AGT_VERBOSE) && !defined(AGT_DEBUG)
 
 #else
 
 #define AGT_ERR(format, ...)
 #define AGT_WARN(format, ...)
 #define AGT_INFO(format, ...)
+#define AGT_INFO_V2(format, ...)
 #define AGT_VERBOSE(format, ...)
 #define AGT_DEBUG(format, ...)  
 
+#define AGT_ERR_EVERY_N(n, format, ...)
+#define AGT_ERR_FIRST_N(n, format, ...)
+#define AGT_ERR_RATE(perSecond, format, ...)
+#define AGT_WARN_EVERY_N(n, format, ...)
+#define AGT_WARN_FIRST_N(n, format, ...)
+#define AGT_WARN_RATE(perSecond, format, ...)
+#define AGT_INFO_EVERY_N(n, format, ...)
+#define AGT_INFO_FIRST_N(n, format, ...)
+#define AGT_INFO_RATE(perSecond, format, ...)
+#define AGT_INFO_V2_EVERY_N(n, format, ...)
+#define AGT_INFO_V2_FIRST_N(n, format, ...)
+#define AGT_INFO_V2_RATE(perSecond, format, ...)
+#define AGT_VERBOSE_EVERY_N(n, format, ...)
+#define AGT_VERBOSE_FIRST_N(n, format, ...)
+#define AGT_VERBOSE_RATE(perSecond, format, ...)
+#define AGT_DEBUG_EVERY_N(n, format, ...)
+#define AGT_DEBUG_FIRST_N(n, format, ...)
+#define AGT_DEBUG_RATE(perSecond, format, ...)
+
+#define AGT_ERR_CAT(category, format, ...)
+#define AGT_WARN_CAT(category, format, ...)
+#define AGT_INFO_CAT(category, format, ...)
+#define AGT_INFO_V2_CAT(category, format, ...)
+#define AGT_VERBOSE_CAT(category, format, ...)
+#define AGT_DEBUG_CAT(category, format, ...)
+
+#define AGT_LOG_SUPPRESSED_SUMMARY()
+
 #endif //AGT_ENABLE_LOGGING
\ No newline at end of file
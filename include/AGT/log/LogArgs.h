@@ -0,0 +1,402 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "LogEntryBuilder.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+namespace AGT {
+    //Binary representation of printf arguments, used by deferred logging to copy arguments now and format them later.
+    //Integers are stored with the type they are promoted to when passed to printf, so decoding feeds snprintf the same types.
+    enum class LogArgType : uint8_t {
+        Int32 = 0,
+        UInt32 = 1,
+        Int64 = 2,
+        UInt64 = 3,
+        Double = 4,
+        String = 5, // uint32_t length, characters, null terminator
+        Pointer = 6
+    };
+
+    template<typename T>
+    struct IsLogStringArg : std::bool_constant<
+        std::is_same_v<std::decay_t<T>, char*> || std::is_same_v<std::decay_t<T>, const char*>> {};
+
+    //Types printf can consume: arithmetic values, enums, C strings and pointers
+    template<typename T>
+    constexpr bool IsLogArg = std::is_arithmetic_v<std::decay_t<T>>
+        || std::is_enum_v<std::decay_t<T>>
+        || std::is_pointer_v<std::decay_t<T>>
+        || std::is_null_pointer_v<std::decay_t<T>>;
+
+    template<typename T>
+    constexpr LogArgType GetLogArgType() noexcept {
+        using U = std::decay_t<T>;
+        if constexpr (IsLogStringArg<U>::value) {
+            return LogArgType::String;
+        } else if constexpr (std::is_pointer_v<U> || std::is_null_pointer_v<U>) {
+            return LogArgType::Pointer;
+        } else if constexpr (std::is_enum_v<U>) {
+            return GetLogArgType<std::underlying_type_t<U>>();
+        } else if constexpr (std::is_floating_point_v<U>) {
+            return LogArgType::Double;
+        } else if constexpr (std::is_integral_v<U> && sizeof(U) < sizeof(int32_t)) {
+            return LogArgType::Int32;
+        } else if constexpr (std::is_integral_v<U> && sizeof(U) == sizeof(int32_t)) {
+            return std::is_signed_v<U> ? LogArgType::Int32 : LogArgType::UInt32;
+        } else if constexpr (std::is_integral_v<U> && sizeof(U) == sizeof(int64_t)) {
+            return std::is_signed_v<U> ? LogArgType::Int64 : LogArgType::UInt64;
+        } else {
+            static_assert(!sizeof(U), "Unsupported log argument type");
+        }
+    }
+
+    class LogArgs {
+    public:
+        //Strings longer than maxStringSize are truncated
+        template<typename T>
+        static size_t GetEncodedSize(const T& arg, size_t maxStringSize) noexcept {
+            if constexpr (IsLogStringArg<T>::value) {
+                return sizeof(uint32_t) + GetStringSize(arg, maxStringSize) + 1;
+            } else {
+                return GetFixedSize(GetLogArgType<T>());
+            }
+        }
+
+        template<typename T>
+        static char* Encode(char* out, const T& arg, size_t maxStringSize) noexcept {
+            constexpr LogArgType type = GetLogArgType<T>();
+            if constexpr (type == LogArgType::String) {
+                const char* str = arg;
+                uint32_t size = static_cast<uint32_t>(GetStringSize(str, maxStringSize));
+                memcpy(out, &size, sizeof(size));
+                memcpy(out + sizeof(size), str ? str : "", size);
+                out[sizeof(size) + size] = '\0';
+                return out + sizeof(size) + size + 1;
+            } else if constexpr (type == LogArgType::Pointer) {
+                return EncodeValue(out, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(arg)));
+            } else if constexpr (type == LogArgType::Double) {
+                return EncodeValue(out, static_cast<double>(arg));
+            } else if constexpr (type == LogArgType::Int32) {
+                return EncodeValue(out, static_cast<int32_t>(arg));
+            } else if constexpr (type == LogArgType::UInt32) {
+                return EncodeValue(out, static_cast<uint32_t>(arg));
+            } else if constexpr (type == LogArgType::Int64) {
+                return EncodeValue(out, static_cast<int64_t>(arg));
+            } else {
+                return EncodeValue(out, static_cast<uint64_t>(arg));
+            }
+        }
+
+        //Size of the encoded arguments starting at data, 0 if they are malformed
+        static size_t GetEncodedSize(std::span<const LogArgType> types, std::span<const char> data) noexcept {
+            size_t offset = 0;
+            for (LogArgType type : types) {
+                size_t size = GetValueSize(type, data.subspan(std::min(offset, data.size())));
+                if (!size) {
+                    return 0;
+                }
+                offset += size;
+            }
+
+            return offset;
+        }
+
+        //Expands a printf format using encoded arguments. Returns false if the arguments don't match the format.
+        //Format and types may come from a damaged file, so every conversion is checked against its argument's type.
+        static bool Decode(LogEntryBuilder& builder, const char* format, std::span<const LogArgType> types, std::span<const char> data) noexcept {
+            size_t argIndex = 0;
+            size_t offset = 0;
+            const char* pos = format;
+
+            for (;;) {
+                const char* specBegin = strchr(pos, '%');
+                if (!specBegin) {
+                    builder.Append(pos);
+                    break;
+                }
+
+                if (specBegin > pos) {
+                    builder.Append(std::string_view(pos, specBegin - pos));
+                }
+
+                if (specBegin[1] == '%') {
+                    builder.Append('%');
+                    pos = specBegin + 2;
+                    continue;
+                }
+
+                char spec[32];
+                int numStars = 0;
+                const char* specEnd = LogEntryBuilder::ParsePrintfSpec(specBegin, spec, numStars);
+                if (!specEnd) {
+                    builder.Write(specBegin);
+                    return false;
+                }
+                pos = specEnd + 1;
+
+                int stars[2] = { 0, 0 };
+                for (int i = 0; i < numStars; ++i) {
+                    int32_t star = 0;
+                    if (argIndex >= types.size() || types[argIndex] != LogArgType::Int32 || !ReadValue(data, offset, star)) {
+                        return false;
+                    }
+
+                    stars[i] = star;
+                    ++argIndex;
+                }
+
+                if (argIndex >= types.size()
+                    || !MatchSpec(spec, types[argIndex])
+                    || !DecodeArg(builder, spec, stars, numStars, types[argIndex], data, offset)) {
+                    return false;
+                }
+                ++argIndex;
+            }
+
+            return argIndex == types.size();
+        }
+
+    private:
+        template<typename T>
+        static char* EncodeValue(char* out, T value) noexcept {
+            memcpy(out, &value, sizeof(value));
+            return out + sizeof(value);
+        }
+
+        template<typename T>
+        static bool ReadValue(std::span<const char> data, size_t& offset, T& value) noexcept {
+            if (offset + sizeof(T) > data.size()) {
+                return false;
+            }
+
+            memcpy(&value, data.data() + offset, sizeof(T));
+            offset += sizeof(T);
+            return true;
+        }
+
+        static size_t GetStringSize(const char* str, size_t maxStringSize) noexcept {
+            return str ? strnlen(str, maxStringSize) : 0;
+        }
+
+        static constexpr size_t GetFixedSize(LogArgType type) noexcept {
+            switch (type) {
+            case LogArgType::Int32:
+            case LogArgType::UInt32:
+                return sizeof(uint32_t);
+            case LogArgType::String:
+                return 0;
+            default:
+                return sizeof(uint64_t);
+            }
+        }
+
+        static size_t GetValueSize(LogArgType type, std::span<const char> data) noexcept {
+            if (type != LogArgType::String) {
+                size_t size = GetFixedSize(type);
+                return size <= data.size() ? size : 0;
+            }
+
+            uint32_t size = 0;
+            if (data.size() < sizeof(size)) {
+                return 0;
+            }
+
+            memcpy(&size, data.data(), sizeof(size));
+            size_t total = sizeof(size) + size + 1;
+            return total <= data.size() && data[total - 1] == '\0' ? total : 0;
+        }
+
+        //False if the conversion doesn't take the type. Otherwise the length modifier is replaced by the one
+        //of the encoded type, so snprintf always reads the argument it is given.
+        static bool MatchSpec(char (&spec)[32], LogArgType type) noexcept {
+            size_t specSize = strlen(spec);
+            char conversion = spec[specSize - 1];
+            const char* length = "";
+            switch (type) {
+            case LogArgType::Int32:
+            case LogArgType::UInt32:
+                if (!strchr("diouxXc", conversion)) {
+                    return false;
+                }
+                if (conversion != 'c') {
+                    //the value was promoted from a narrower type, h and hh still apply
+                    size_t numH = std::count(spec, spec + specSize, 'h');
+                    length = numH == 1 ? "h" : numH == 2 ? "hh" : "";
+                }
+                break;
+            case LogArgType::Int64:
+            case LogArgType::UInt64:
+                if (!strchr("diouxX", conversion)) {
+                    return false;
+                }
+                length = "ll";
+                break;
+            case LogArgType::Double:
+                if (!strchr("eEfFgGaA", conversion)) {
+                    return false;
+                }
+                break;
+            case LogArgType::String:
+                if (conversion != 's') {
+                    return false;
+                }
+                break;
+            case LogArgType::Pointer:
+                if (conversion != 'p') {
+                    return false;
+                }
+                break;
+            default:
+                return false;
+            }
+
+            char matched[32];
+            size_t matchedSize = 0;
+            for (size_t i = 0; i + 1 < specSize; ++i) {
+                if (!strchr("hljztL", spec[i])) {
+                    matched[matchedSize++] = spec[i];
+                }
+            }
+
+            size_t lengthSize = strlen(length);
+            if (matchedSize + lengthSize + 1 >= sizeof(matched)) {
+                return false;
+            }
+
+            memcpy(matched + matchedSize, length, lengthSize);
+            matched[matchedSize + lengthSize] = conversion;
+            matched[matchedSize + lengthSize + 1] = '\0';
+            memcpy(spec, matched, sizeof(matched));
+            return true;
+        }
+
+        //%d, %llu, %s etc. without flags, width or precision
+        static char GetPlainConversion(const char* spec) noexcept {
+            const char* pos = spec + 1;
+            while (*pos && strchr("ljzt", *pos)) {
+                ++pos;
+            }
+            return pos[0] && !pos[1] ? pos[0] : 0;
+        }
+
+        template<typename T>
+        static void WriteSpec(LogEntryBuilder& builder, const char* spec, const int* stars, int numStars, T value) noexcept {
+            //skip snprintf for the common specs
+            if (numStars == 0) {
+                char conversion = GetPlainConversion(spec);
+                if constexpr (std::is_integral_v<T>) {
+                    if (conversion == 'd' || conversion == 'i') {
+                        builder.Append(static_cast<std::make_signed_t<T>>(value));
+                        return;
+                    }
+                    if (conversion == 'u') {
+                        builder.Append(static_cast<std::make_unsigned_t<T>>(value));
+                        return;
+                    }
+                    if (conversion == 'x') {
+                        builder.AppendHex(value);
+                        return;
+                    }
+                } else if constexpr (std::is_same_v<T, const char*>) {
+                    if (conversion == 's') {
+                        builder.Append(value);
+                        return;
+                    }
+                }
+            }
+
+            switch (numStars) {
+            case 0: builder.Write(spec, value); break;
+            case 1: builder.Write(spec, stars[0], value); break;
+            default: builder.Write(spec, stars[0], stars[1], value); break;
+            }
+        }
+
+        static bool DecodeArg(
+            LogEntryBuilder& builder,
+            const char* spec,
+            const int* stars,
+            int numStars,
+            LogArgType type,
+            std::span<const char> data,
+            size_t& offset
+        ) noexcept {
+            switch (type) {
+            case LogArgType::Int32: {
+                int32_t value;
+                if (!ReadValue(data, offset, value)) return false;
+                WriteSpec(builder, spec, stars, numStars, value);
+                return true;
+            }
+            case LogArgType::UInt32: {
+                uint32_t value;
+                if (!ReadValue(data, offset, value)) return false;
+                WriteSpec(builder, spec, stars, numStars, value);
+                return true;
+            }
+            case LogArgType::Int64: {
+                int64_t value;
+                if (!ReadValue(data, offset, value)) return false;
+                WriteSpec(builder, spec, stars, numStars, value);
+                return true;
+            }
+            case LogArgType::UInt64: {
+                uint64_t value;
+                if (!ReadValue(data, offset, value)) return false;
+                WriteSpec(builder, spec, stars, numStars, value);
+                return true;
+            }
+            case LogArgType::Double: {
+                double value;
+                if (!ReadValue(data, offset, value)) return false;
+                WriteSpec(builder, spec, stars, numStars, value);
+                return true;
+            }
+            case LogArgType::Pointer: {
+                uint64_t value;
+                if (!ReadValue(data, offset, value)) return false;
+                WriteSpec(builder, spec, stars, numStars, reinterpret_cast<const void*>(static_cast<uintptr_t>(value)));
+                return true;
+            }
+            case LogArgType::String: {
+                size_t size = GetValueSize(type, data.subspan(std::min(offset, data.size())));
+                if (!size) return false;
+                WriteSpec(builder, spec, stars, numStars, data.data() + offset + sizeof(uint32_t));
+                offset += size;
+                return true;
+            }
+            default:
+                return false;
+            }
+        }
+    };
+}
@@ -0,0 +1,251 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "LogLevel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace AGT {
+    //A named group of log statements with its own runtime level. Names are hierarchical, "net.replication" is a child
+    //of "net". Categories are defined at namespace scope and register themselves during static initialization:
+    //
+    //  AGT::LogCategory g_logReplication("net.replication");
+    //  AGT_DEBUG_CAT(g_logReplication, "Sent %u bytes", size);
+    //
+    //Levels are assigned to names and apply to the named category and all its descendants that have no more specific
+    //level. "*" matches every category. A category without a level follows the logger's level. The effective level
+    //is resolved on every change and stored in the category, so the macros only do a relaxed load.
+    class LogCategory {
+    public:
+        explicit LogCategory(const char* name) : m_name(name) {
+            Registry& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.lock);
+            m_next = registry.head;
+            registry.head = this;
+            Resolve(registry);
+        }
+
+        ~LogCategory() {
+            Registry& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.lock);
+            for (LogCategory** pos = &registry.head; *pos; pos = &(*pos)->m_next) {
+                if (*pos == this) {
+                    *pos = m_next;
+                    break;
+                }
+            }
+        }
+
+        const char* GetName() const noexcept { return m_name; }
+
+        //False if the category follows the logger's level
+        bool GetLevel(LogLevel& level) const noexcept {
+            int levelSlot = m_levelSlot.load(std::memory_order_relaxed);
+            if (!levelSlot) {
+                return false;
+            }
+
+            level = static_cast<LogLevel>(levelSlot - 1);
+            return true;
+        }
+
+        //Takes effect on the next call from any thread. Categories registered later pick it up as well.
+        static void SetLevel(std::string_view name, LogLevel level) {
+            Registry& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.lock);
+            bool found = false;
+            for (auto& rule : registry.rules) {
+                if (rule.name == name) {
+                    rule.level = level;
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                registry.rules.push_back({ std::string(name), level });
+            }
+            ResolveAll(registry);
+        }
+
+        //The category and its descendants fall back to the level of the nearest ancestor that has one
+        static void ResetLevel(std::string_view name) {
+            Registry& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.lock);
+            std::erase_if(registry.rules, [name](const Rule& rule) { return rule.name == name; });
+            ResolveAll(registry);
+        }
+
+        static void ResetAllLevels() {
+            Registry& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.lock);
+            registry.rules.clear();
+            ResolveAll(registry);
+        }
+
+        //Applies "name=level" lines, e.g. the contents of a config file or a console command such as
+        //"net.replication=Debug". "name=Default" resets the name. Empty lines and lines starting with '#' are skipped.
+        //Lines before a malformed one are applied, the malformed one is described in error.
+        static bool ApplyConfig(std::string_view config, std::string* error = nullptr) {
+            size_t lineNumber = 0;
+            while (!config.empty()) {
+                size_t lineEnd = config.find('\n');
+                std::string_view line = Trim(config.substr(0, lineEnd));
+                config = lineEnd == std::string_view::npos ? std::string_view() : config.substr(lineEnd + 1);
+                ++lineNumber;
+
+                if (line.empty() || line[0] == '#') {
+                    continue;
+                }
+
+                size_t separator = line.find('=');
+                std::string_view name = separator == std::string_view::npos ? std::string_view() : Trim(line.substr(0, separator));
+                std::string_view value = separator == std::string_view::npos ? std::string_view() : Trim(line.substr(separator + 1));
+                LogLevel level;
+                if (name.empty()) {
+                    return SetError(error, lineNumber, "expected name=level");
+                } else if (EqualsNoCase(value, "default")) {
+                    ResetLevel(name);
+                } else if (LogLevelFromString(value, level)) {
+                    SetLevel(name, level);
+                } else {
+                    return SetError(error, lineNumber, "unknown level");
+                }
+            }
+            return true;
+        }
+
+        static bool LoadConfigFile(const char* path, std::string* error = nullptr) {
+            std::ifstream file(path);
+            if (!file) {
+                if (error) {
+                    *error = std::string("cannot open ") + path;
+                }
+                return false;
+            }
+
+            std::stringstream contents;
+            contents << file.rdbuf();
+            return ApplyConfig(contents.str(), error);
+        }
+
+        //f(const LogCategory&) for every registered category, under the registry lock
+        template<typename F>
+        static void ForEach(F&& f) {
+            Registry& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.lock);
+            for (const LogCategory* category = registry.head; category; category = category->m_next) {
+                f(*category);
+            }
+        }
+
+    private:
+        LogCategory(const LogCategory&) = delete;
+        LogCategory& operator=(const LogCategory&) = delete;
+
+        struct Rule {
+            std::string name;
+            LogLevel level;
+        };
+
+        struct Registry {
+            std::mutex lock;
+            LogCategory* head{ nullptr };
+            std::vector<Rule> rules;
+        };
+
+        //Constructed by the first category, so it is destroyed after the last one
+        static Registry& GetRegistry() {
+            static Registry s_registry;
+            return s_registry;
+        }
+
+        //Called under the registry lock
+        static void ResolveAll(Registry& registry) noexcept {
+            for (LogCategory* category = registry.head; category; category = category->m_next) {
+                category->Resolve(registry);
+            }
+        }
+
+        //The most specific rule wins: an exact match, then the longest ancestor, then "*"
+        void Resolve(const Registry& registry) noexcept {
+            std::string_view name(m_name);
+            const Rule* match = nullptr;
+            size_t matchSize = 0;
+            for (const Rule& rule : registry.rules) {
+                size_t specificity = 0;
+                if (rule.name != "*") {
+                    size_t ruleSize = rule.name.size();
+                    if (!name.starts_with(rule.name) || (name.size() != ruleSize && name[ruleSize] != '.')) {
+                        continue;
+                    }
+                    specificity = ruleSize + 1;
+                }
+
+                if (!match || specificity > matchSize) {
+                    match = &rule;
+                    matchSize = specificity;
+                }
+            }
+
+            m_levelSlot.store(match ? static_cast<int>(match->level) + 1 : 0, std::memory_order_relaxed);
+        }
+
+        static std::string_view Trim(std::string_view text) noexcept {
+            while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front()))) {
+                text.remove_prefix(1);
+            }
+            while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back()))) {
+                text.remove_suffix(1);
+            }
+            return text;
+        }
+
+        static bool EqualsNoCase(std::string_view a, std::string_view b) noexcept {
+            return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+                return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+            });
+        }
+
+        static bool SetError(std::string* error, size_t lineNumber, const char* message) {
+            if (error) {
+                *error = "line " + std::to_string(lineNumber) + ": " + message;
+            }
+            return false;
+        }
+
+        const char* m_name;
+        LogCategory* m_next{ nullptr };
+        std::atomic<int> m_levelSlot{ 0 }; // effective level + 1, zero when following the logger
+    };
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "LogLevel.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace AGT {
+    //Identity of a formatted entry without its timestamp and thread fields, plus what is needed to report a repeat run
+    struct LogEntryKey {
+        uint64_t hash{ 0 };
+        uint64_t timestampNs{ 0 };
+        LogLevel level{ LogLevel::Debug };
+        const char* fileName{ nullptr };
+        const char* function{ nullptr };
+        int lineNumber{ 0 };
+    };
+
+    //Collapses runs of identical consecutive entries. A run lasts at most one window from its first entry,
+    //so a line repeating forever is still written once per window. Not thread safe, used under the logger lock.
+    class LogCoalescer {
+    public:
+        static uint64_t Hash(std::string_view data, uint64_t seed = 0) noexcept {
+            uint64_t hash = seed ^ (data.size() * PRIME);
+            const char* pos = data.data();
+            size_t numLeft = data.size();
+            for (; numLeft >= sizeof(uint64_t); numLeft -= sizeof(uint64_t), pos += sizeof(uint64_t)) {
+                uint64_t block;
+                memcpy(&block, pos, sizeof(block));
+                hash = Mix(hash ^ block);
+            }
+
+            uint64_t tail = 0;
+            if (numLeft) {
+                memcpy(&tail, pos, numLeft);
+            }
+            return Mix(hash ^ tail);
+        }
+
+        //Returns true if the entry repeats the current run and must not be written.
+        //Otherwise the previous run ends; its repeat count is available from TakeRepeats before the entry is written.
+        bool Add(const LogEntryKey& key, uint64_t windowNs) noexcept {
+            if (m_hasRun && key.hash == m_run.hash && key.timestampNs - m_run.timestampNs < windowNs) {
+                ++m_numRepeats;
+                return true;
+            }
+
+            m_endedRun = m_run;
+            m_numEndedRepeats = m_numRepeats;
+            m_run = key;
+            m_numRepeats = 0;
+            m_hasRun = true;
+            return false;
+        }
+
+        //Repeats of the run that ended with the last Add, reset once taken
+        uint64_t TakeRepeats(LogEntryKey& key) noexcept {
+            uint64_t numRepeats = m_numEndedRepeats;
+            key = m_endedRun;
+            m_numEndedRepeats = 0;
+            return numRepeats;
+        }
+
+        //Repeats counted so far in the current run, e.g. on flush. The run itself continues.
+        uint64_t TakeCurrentRepeats(LogEntryKey& key) noexcept {
+            uint64_t numRepeats = m_numRepeats;
+            key = m_run;
+            m_numRepeats = 0;
+            return numRepeats;
+        }
+
+    private:
+        static constexpr uint64_t PRIME = 0x9E3779B97F4A7C15ull;
+
+        static uint64_t Mix(uint64_t value) noexcept {
+            value *= PRIME;
+            return value ^ (value >> 32);
+        }
+
+        bool m_hasRun{ false };
+        LogEntryKey m_run;
+        uint64_t m_numRepeats{ 0 };
+        LogEntryKey m_endedRun;
+        uint64_t m_numEndedRepeats{ 0 };
+    };
+}
\ No newline at end of file
@@ -0,0 +1,225 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "../platform/Socket.h"
+#include "LogShippingFormat.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace AGT {
+    //Reference receiver for LoggerSocketSink, used by the tests and as a starting point for a host-local aggregator.
+    //Single threaded: Poll accepts new senders, reads what arrived and hands over complete entries.
+    class LogCollector {
+    public:
+        //A stale socket file at the endpoint's path is replaced
+        static std::unique_ptr<LogCollector> Create(const LogShippingEndpoint& endpoint) {
+            auto collector = std::unique_ptr<LogCollector>(new LogCollector());
+            if (collector && collector->Init(endpoint)) {
+                return collector;
+            }
+
+            return nullptr;
+        }
+
+        ~LogCollector() noexcept {
+            if (m_type == SocketType::UnixStream && m_socket) {
+                m_socket.reset();
+                std::remove(m_path.c_str());
+            }
+        }
+
+        //Waits up to timeout for data and calls fEntry(std::string_view) for every complete entry, in the order
+        //each sender wrote them. Returns the number of entries.
+        template<typename F>
+        size_t Poll(std::chrono::milliseconds timeout, F&& fEntry) {
+            m_pollSockets.clear();
+            m_pollSockets.push_back(m_socket.get());
+            for (auto& connection : m_connections) {
+                m_pollSockets.push_back(connection.socket.get());
+            }
+
+            bool readable[Socket::MAX_WAIT_SOCKETS] = {};
+            if (!Socket::WaitReadable(m_pollSockets, std::span<bool>(readable, m_pollSockets.size()), timeout)) {
+                return 0;
+            }
+
+            size_t numEntries = 0;
+            for (size_t i = m_connections.size(); i-- > 0;) {
+                if (readable[i + 1] && !ReadConnection(m_connections[i], fEntry, numEntries)) {
+                    m_connections.erase(m_connections.begin() + i);
+                }
+            }
+
+            if (readable[0]) {
+                if (m_type == SocketType::Udp) {
+                    ReadDatagrams(fEntry, numEntries);
+                } else {
+                    AcceptConnections();
+                }
+            }
+
+            return numEntries;
+        }
+
+        size_t GetNumConnections() const noexcept { return m_connections.size(); }
+
+        //The bound UDP port, useful when the endpoint asked for port 0
+        uint16_t GetPort() const noexcept { return m_type == SocketType::Udp ? m_socket->GetLocalPort() : 0; }
+
+        //Streams closed because of a frame larger than LogShippingFormat::MAX_FRAME_SIZE,
+        //or datagrams with a cut off frame
+        uint64_t GetCorruptCount() const noexcept { return m_corruptCount; }
+
+    private:
+        LogCollector(const LogCollector&) = delete;
+        LogCollector& operator=(const LogCollector&) = delete;
+
+        LogCollector() noexcept = default;
+
+        struct Connection {
+            std::unique_ptr<Socket> socket;
+            std::vector<char> buffer;
+            size_t size{ 0 };
+        };
+
+        static constexpr size_t READ_SIZE = 64 * 1024;
+
+        bool Init(const LogShippingEndpoint& endpoint) {
+            m_type = endpoint.type;
+            m_path = endpoint.path;
+            m_socket = Socket::Create(endpoint.type);
+            if (!m_socket) {
+                return false;
+            }
+
+            if (m_type == SocketType::UnixStream) {
+                std::remove(m_path.c_str());
+                if (!m_socket->Bind(endpoint.GetAddress()) || !m_socket->Listen(16)) {
+                    m_socket.reset();
+                    return false;
+                }
+            } else if (!m_socket->Bind(endpoint.GetAddress())) {
+                return false;
+            }
+
+            m_datagram.resize(LogShippingFormat::MAX_DATAGRAM_SIZE);
+            return true;
+        }
+
+        void AcceptConnections() {
+            //further senders wait in the backlog until a connection closes
+            while (m_connections.size() + 1 < Socket::MAX_WAIT_SOCKETS) {
+                std::unique_ptr<Socket> socket = m_socket->Accept();
+                if (!socket) {
+                    return;
+                }
+
+                Connection connection;
+                connection.socket = std::move(socket);
+                connection.buffer.resize(READ_SIZE);
+                m_connections.push_back(std::move(connection));
+            }
+        }
+
+        //False once the connection is closed or corrupt. Bytes of an incomplete frame are dropped with it.
+        template<typename F>
+        bool ReadConnection(Connection& connection, F& fEntry, size_t& numEntries) {
+            for (;;) {
+                if (connection.buffer.size() - connection.size < READ_SIZE) {
+                    connection.buffer.resize(connection.size + READ_SIZE);
+                }
+
+                size_t numReceived = 0;
+                SocketResult result = connection.socket->Receive(connection.buffer.data() + connection.size, READ_SIZE, numReceived);
+                if (result == SocketResult::WouldBlock) {
+                    return true;
+                }
+                if (result != SocketResult::Ok) {
+                    return false;
+                }
+
+                connection.size += numReceived;
+                size_t offset = 0;
+                if (!ReadFrames(std::string_view(connection.buffer.data(), connection.size), offset, fEntry, numEntries)) {
+                    ++m_corruptCount;
+                    return false;
+                }
+
+                memmove(connection.buffer.data(), connection.buffer.data() + offset, connection.size - offset);
+                connection.size -= offset;
+            }
+        }
+
+        template<typename F>
+        void ReadDatagrams(F& fEntry, size_t& numEntries) {
+            for (;;) {
+                size_t numReceived = 0;
+                if (m_socket->Receive(m_datagram.data(), m_datagram.size(), numReceived) != SocketResult::Ok) {
+                    return;
+                }
+
+                size_t offset = 0;
+                if (!ReadFrames(std::string_view(m_datagram.data(), numReceived), offset, fEntry, numEntries) || offset != numReceived) {
+                    ++m_corruptCount;
+                }
+            }
+        }
+
+        //Hands over the complete frames, offset ends at the first incomplete one
+        template<typename F>
+        static bool ReadFrames(std::string_view data, size_t& offset, F& fEntry, size_t& numEntries) {
+            while (data.size() - offset >= LogShippingFormat::FRAME_HEADER_SIZE) {
+                size_t size = LogShippingFormat::ReadFrameHeader(data.data() + offset);
+                if (size > LogShippingFormat::MAX_FRAME_SIZE) {
+                    return false;
+                }
+                if (data.size() - offset - LogShippingFormat::FRAME_HEADER_SIZE < size) {
+                    break;
+                }
+
+                fEntry(data.substr(offset + LogShippingFormat::FRAME_HEADER_SIZE, size));
+                offset += LogShippingFormat::FRAME_HEADER_SIZE + size;
+                ++numEntries;
+            }
+            return true;
+        }
+
+        SocketType m_type{ SocketType::UnixStream };
+        std::string m_path;
+        std::unique_ptr<Socket> m_socket; // the listener, or the bound UDP socket
+        std::vector<Connection> m_connections;
+        std::vector<char> m_datagram;
+        std::vector<Socket*> m_pollSockets;
+        uint64_t m_corruptCount{ 0 };
+    };
+}
\ No newline at end of file
@@ -24,22 +24,48 @@ SOFTWARE.
 
 #pragma once
 
+#include "LogFormatString.h"
+#include "LogSegmentPool.h"
+
+#include <algorithm>
 #include <assert.h>
+#include <charconv>
+#include <concepts>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <span>
+#include <string_view>
+#include <type_traits>
 
 namespace AGT {
+    //Writes log entries into a fixed buffer. The content is always null terminated. When it doesn't fit,
+    //the content is truncated and the size written becomes the buffer size.
+    //With a spill pool the rest of an oversized entry continues in chained segments from the pool instead,
+    //and only runs out when the pool does. Entries that fit never touch the pool.
     class LogEntryBuilder {
     public:
-        LogEntryBuilder(std::span<char> buffer) noexcept : m_buffer(buffer) {
+        LogEntryBuilder(std::span<char> buffer, LogSegmentPool* spillPool = nullptr) noexcept
+            : m_buffer(buffer), m_spillPool(spillPool) {
             assert(buffer.size() > 1);
         }
 
+        //Returns segments that were not taken
+        ~LogEntryBuilder() {
+            if (m_spillHead) {
+                m_spillPool->Release(m_spillHead);
+            }
+        }
+
+        //With force the line break replaces the last character of a truncated entry
         void EndLine(bool force = false) noexcept {
             size_t numLeft = m_buffer.size() - m_offset;
-            if (force && !numLeft) {
+            if (force && numLeft <= 1 && (numLeft == 0 || !Spill())) {
                 m_buffer[m_buffer.size() - 2] = '\n';
+                m_buffer[m_buffer.size() - 1] = '\0';
+                m_offset = m_buffer.size();
             } else {
-                m_offset += snprintf(m_buffer.data() + m_offset, m_buffer.size() - m_offset, "\n");
+                Append('\n');
             }
         }
 
@@ -50,16 +76,22 @@ namespace AGT {
                 m_buffer.data() + m_offset, numLeft,
                 format, std::forward<Args>(args)...);
 
-            m_offset += std::min(numRequired, numLeft);
+            if (numRequired < numLeft || !m_spillPool || !numLeft) {
+                m_offset += std::min(numRequired, numLeft);
+                return;
+            }
+
+            //drop the cut off output and expand the format piece by piece, so each piece can continue in a segment
+            m_buffer[m_offset] = '\0';
+            SpilledFormat state{ format };
+            (WriteSpilledArg(state, args), ...);
+            while (NextSpilledSpec(state)) {
+                Append(std::string_view(state.spec));
+            }
         }
 
         void Write(const char* str) noexcept {
-            size_t numLeft = m_buffer.size() - m_offset;
-            size_t numRequired = snprintf(
-                m_buffer.data() + m_offset, numLeft,
-                "%s", str);
-
-            m_offset += std::min(numRequired, numLeft);
+            Append(str);
         }
 
         template<typename... Args>
@@ -73,12 +105,308 @@ namespace AGT {
             EndLine(true);
         }
 
-        size_t GetSizeWritten() const noexcept { return m_offset; }
+        //"{}" style formatting, checked at compile time and written with the Append overloads
+        template<typename... Args>
+        void Format(LogFormatString<Args...> format, Args&&... args) noexcept {
+            size_t pos = 0;
+            size_t argIndex = 0;
+            (AppendFormatArg(format, pos, argIndex++, std::forward<Args>(args)), ...);
+            AppendFormatLiteral(format, format.Get().substr(pos));
+        }
+
+        void Append(std::string_view str) noexcept {
+            for (;;) {
+                size_t numLeft = m_buffer.size() - m_offset;
+                if (!numLeft) {
+                    return;
+                }
+
+                size_t numCopied = std::min(str.size(), numLeft - 1);
+                memcpy(m_buffer.data() + m_offset, str.data(), numCopied);
+                m_buffer[m_offset + numCopied] = '\0';
+                if (numCopied == str.size()) {
+                    m_offset += numCopied;
+                    return;
+                }
+
+                m_offset += numCopied;
+                str.remove_prefix(numCopied);
+                if (!Spill()) {
+                    m_offset = m_buffer.size();
+                    return;
+                }
+            }
+        }
+
+        void Append(const char* str) noexcept {
+            Append(std::string_view(str ? str : "(null)"));
+        }
+
+        void Append(char c) noexcept {
+            Append(std::string_view(&c, 1));
+        }
+
+        void Append(bool value) noexcept {
+            Append(std::string_view(value ? "true" : "false"));
+        }
+
+        template<std::integral T> requires (!std::same_as<T, bool> && !std::same_as<T, char>)
+        void Append(T value) noexcept {
+            AppendChars([value](char* first, char* last) { return std::to_chars(first, last, value); });
+        }
+
+        template<std::integral T> requires (!std::same_as<T, bool>)
+        void AppendHex(T value) noexcept {
+            auto unsignedValue = static_cast<std::make_unsigned_t<T>>(value);
+            AppendChars([unsignedValue](char* first, char* last) { return std::to_chars(first, last, unsignedValue, 16); });
+        }
+
+        void Append(const void* ptr) noexcept {
+            Append(std::string_view("0x"));
+            AppendHex(reinterpret_cast<uintptr_t>(ptr));
+        }
+
+        //Shortest representation that round trips
+        template<std::floating_point T>
+        void Append(T value) noexcept {
+            AppendChars([value](char* first, char* last) { return std::to_chars(first, last, value); });
+        }
+
+        //Fixed notation, like %.*f
+        template<std::floating_point T>
+        void Append(T value, int precision) noexcept {
+            precision = std::clamp(precision, 0, MAX_FLOAT_PRECISION);
+            AppendChars([value, precision](char* first, char* last) {
+                return std::to_chars(first, last, value, std::chars_format::fixed, precision);
+            });
+        }
+
+        //Copies the conversion starting at specBegin, e.g. "%-8.3f", into spec. Returns its last character, or null
+        //if it is unterminated, too long, has more than two '*' or anything but flags, width, precision and length.
+        static const char* ParsePrintfSpec(const char* specBegin, char (&spec)[32], int& numStars) noexcept {
+            numStars = 0;
+            const char* specEnd = specBegin + 1;
+            while (*specEnd && !strchr("diouxXeEfFgGaAcsp", *specEnd)) {
+                if (!strchr("-+ #0123456789.*hljztL", *specEnd)) {
+                    return nullptr;
+                }
+
+                numStars += *specEnd == '*';
+                ++specEnd;
+            }
+
+            size_t specSize = specEnd - specBegin + 1;
+            if (!*specEnd || specSize >= sizeof(spec) || numStars > 2) {
+                return nullptr;
+            }
+
+            memcpy(spec, specBegin, specSize);
+            spec[specSize] = '\0';
+            return specEnd;
+        }
+
+        //Total size, including the spilled part
+        size_t GetSizeWritten() const noexcept { return m_spilledSize + GetLastPartSize(); }
+
+        //Pool the entry spills into, null if it is truncated instead
+        LogSegmentPool* GetSpillPool() const noexcept { return m_spillPool; }
+
+        //Room before the builder spills or truncates, the terminator included
+        size_t GetNumLeft() const noexcept { return m_buffer.size() - m_offset; }
+
+        //Size of the part in the buffer passed to the constructor
+        size_t GetInlineSize() const noexcept { return m_spillTail ? m_inlineSize : m_offset; }
+
+        //Segments holding the rest of a completed entry, null if it fit in the buffer. The builder keeps them.
+        const LogSegment* GetSpilled() noexcept {
+            if (m_spillTail) {
+                m_spillTail->size = GetLastPartSize();
+            }
+            return m_spillHead;
+        }
+
+        //Same as GetSpilled, but the caller releases the segments to the pool
+        LogSegment* TakeSpilled() noexcept {
+            GetSpilled();
+            LogSegment* spilled = m_spillHead;
+            m_spillHead = nullptr;
+            return spilled;
+        }
     private:
         LogEntryBuilder(const LogEntryBuilder&) = delete;
         LogEntryBuilder& operator=(const LogEntryBuilder&) = delete;
 
-        std::span<char> m_buffer;
+        static constexpr int MAX_FLOAT_PRECISION = 64;
+
+        struct SpilledFormat {
+            const char* pos;
+            char spec[32]{};
+            int numStars{ 0 };
+            int numStarsRead{ 0 };
+            int stars[2]{ 0, 0 };
+            bool hasSpec{ false };
+        };
+
+        //A truncated segment doesn't count its terminator, unlike a truncated entry without segments
+        size_t GetLastPartSize() const noexcept {
+            return m_spillTail ? std::min(m_offset, m_buffer.size() - 1) : m_offset;
+        }
+
+        //Continues the entry in a new segment once the current part is full
+        bool Spill() noexcept {
+            LogSegment* segment = m_spillPool ? m_spillPool->TryAcquire() : nullptr;
+            if (!segment) {
+                return false;
+            }
+
+            if (m_spillTail) {
+                m_spillTail->size = m_offset;
+                m_spillTail->next = segment;
+            } else {
+                m_inlineSize = m_offset;
+                m_spillHead = segment;
+            }
+
+            m_spillTail = segment;
+            m_spilledSize += m_offset;
+            m_buffer = std::span<char>(segment->data, segment->capacity);
+            m_offset = 0;
+            return true;
+        }
+
+        //Appends the literal text up to the next conversion and reads the conversion into state.spec
+        bool NextSpilledSpec(SpilledFormat& state) noexcept {
+            for (;;) {
+                const char* specBegin = strchr(state.pos, '%');
+                if (!specBegin) {
+                    Append(std::string_view(state.pos));
+                    state.pos += strlen(state.pos);
+                    return false;
+                }
+
+                Append(std::string_view(state.pos, specBegin - state.pos));
+                if (specBegin[1] == '%') {
+                    Append('%');
+                    state.pos = specBegin + 2;
+                    continue;
+                }
+
+                const char* specEnd = ParsePrintfSpec(specBegin, state.spec, state.numStars);
+                if (!specEnd) {
+                    Append(std::string_view(specBegin));
+                    state.pos = specBegin + strlen(specBegin);
+                    return false;
+                }
+
+                state.pos = specEnd + 1;
+                state.numStarsRead = 0;
+                state.hasSpec = true;
+                return true;
+            }
+        }
+
+        //Plain "%s" strings are appended directly, other conversions are small enough for a scratch buffer
+        template<typename T>
+        void WriteSpilledArg(SpilledFormat& state, const T& arg) noexcept {
+            if (!state.hasSpec && !NextSpilledSpec(state)) {
+                return;
+            }
+
+            if (state.numStarsRead < state.numStars) {
+                if constexpr (std::is_integral_v<T>) {
+                    state.stars[state.numStarsRead] = static_cast<int>(arg);
+                }
+                ++state.numStarsRead;
+                return;
+            }
+            state.hasSpec = false;
+
+            if constexpr (std::is_convertible_v<const T&, const char*>) {
+                if (!strcmp(state.spec, "%s")) {
+                    Append(static_cast<const char*>(arg));
+                    return;
+                }
+            }
+
+            char scratch[512];
+            int size;
+            switch (state.numStars) {
+            case 0: size = snprintf(scratch, sizeof(scratch), state.spec, arg); break;
+            case 1: size = snprintf(scratch, sizeof(scratch), state.spec, state.stars[0], arg); break;
+            default: size = snprintf(scratch, sizeof(scratch), state.spec, state.stars[0], state.stars[1], arg); break;
+            }
+
+            if (size > 0) {
+                Append(std::string_view(scratch, std::min(static_cast<size_t>(size), sizeof(scratch) - 1)));
+            }
+        }
+
+        //Converts in place when the result fits, otherwise through a scratch buffer so it is truncated like strings
+        template<typename TConvert>
+        void AppendChars(TConvert&& fConvert) noexcept {
+            size_t numLeft = m_buffer.size() - m_offset;
+            if (numLeft > 1) {
+                char* first = m_buffer.data() + m_offset;
+                auto result = fConvert(first, first + numLeft - 1);
+                if (result.ec == std::errc{}) {
+                    *result.ptr = '\0';
+                    m_offset += result.ptr - first;
+                    return;
+                }
+            }
+
+            //largest fixed notation double: 309 digits, sign, point and the precision
+            char scratch[320 + MAX_FLOAT_PRECISION];
+            auto result = fConvert(scratch, scratch + sizeof(scratch));
+            if (result.ec == std::errc{}) {
+                Append(std::string_view(scratch, result.ptr - scratch));
+            }
+        }
+
+        template<typename TFormat>
+        void AppendFormatLiteral(const TFormat& format, std::string_view literal) noexcept {
+            if (!format.HasEscapes()) {
+                Append(literal);
+                return;
+            }
+
+            LogFormatSpec spec;
+            size_t pos = 0;
+            LogFormatParser::Next(literal, pos, spec, [this](std::string_view part) { Append(part); });
+        }
+
+        template<typename TFormat, typename T>
+        void AppendFormatArg(const TFormat& format, size_t& pos, size_t argIndex, T&& arg) noexcept {
+            const LogFormatPlaceholder& placeholder = format.GetPlaceholder(argIndex);
+            AppendFormatLiteral(format, format.Get().substr(pos, placeholder.begin - pos));
+            pos = placeholder.end;
+
+            using U = std::decay_t<T>;
+            if constexpr (std::is_integral_v<U> && !std::is_same_v<U, bool>) {
+                if (placeholder.spec.hex) {
+                    AppendHex(arg);
+                } else {
+                    Append(arg);
+                }
+            } else if constexpr (std::is_floating_point_v<U>) {
+                if (placeholder.spec.precision >= 0) {
+                    Append(arg, placeholder.spec.precision);
+                } else {
+                    Append(arg);
+                }
+            } else if constexpr (std::is_pointer_v<U> && !std::is_same_v<std::remove_cv_t<std::remove_pointer_t<U>>, char>) {
+                Append(static_cast<const void*>(arg));
+            } else {
+                Append(arg);
+            }
+        }
+
+        std::span<char> m_buffer; // the part being written, the constructor's buffer or the last segment
         size_t m_offset{ 0 };
+        LogSegmentPool* m_spillPool{ nullptr };
+        LogSegment* m_spillHead{ nullptr };
+        LogSegment* m_spillTail{ nullptr };
+        size_t m_inlineSize{ 0 };
+        size_t m_spilledSize{ 0 }; // bytes in the parts before m_buffer
     };
 }
\ No newline at end of file
@@ -0,0 +1,189 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+
+namespace AGT {
+    struct LogFormatSpec {
+        bool hex{ false };
+        int precision{ -1 };
+    };
+
+    enum class LogFormatToken {
+        End,
+        Placeholder,
+        Error
+    };
+
+    //Not constexpr on purpose, calling it while checking a format string at compile time fails the build
+    inline void LogFormatError(const char* /*reason*/) noexcept {}
+
+    //Parser for "{}" style formats. Supports {}, {:x} for integers and pointers, {:.N} for floating point
+    //and {{ }} for literal braces.
+    class LogFormatParser {
+    public:
+        //Reports the literal text up to the next placeholder through fLiteral and reads the placeholder spec
+        template<typename TLiteral>
+        static constexpr LogFormatToken Next(std::string_view format, size_t& pos, LogFormatSpec& spec, TLiteral&& fLiteral) {
+            while (pos < format.size()) {
+                size_t brace = format.find_first_of("{}", pos);
+                if (brace == std::string_view::npos) {
+                    fLiteral(format.substr(pos));
+                    pos = format.size();
+                    break;
+                }
+
+                if (brace > pos) {
+                    fLiteral(format.substr(pos, brace - pos));
+                }
+
+                if (brace + 1 < format.size() && format[brace + 1] == format[brace]) {
+                    fLiteral(format.substr(brace, 1));
+                    pos = brace + 2;
+                    continue;
+                }
+
+                size_t end = format.find('}', brace);
+                if (format[brace] == '}' || end == std::string_view::npos) {
+                    return LogFormatToken::Error;
+                }
+
+                pos = end + 1;
+                return ParseSpec(format.substr(brace + 1, end - brace - 1), spec) ? LogFormatToken::Placeholder : LogFormatToken::Error;
+            }
+
+            return LogFormatToken::End;
+        }
+
+    private:
+        static constexpr bool ParseSpec(std::string_view str, LogFormatSpec& spec) noexcept {
+            spec = LogFormatSpec{};
+            if (str.empty()) {
+                return true;
+            }
+
+            if (str == ":x") {
+                spec.hex = true;
+                return true;
+            }
+
+            if (str.size() < 3 || str.size() > 4 || str[0] != ':' || str[1] != '.') {
+                return false;
+            }
+
+            spec.precision = 0;
+            for (char c : str.substr(2)) {
+                if (c < '0' || c > '9') {
+                    return false;
+                }
+                spec.precision = spec.precision * 10 + (c - '0');
+            }
+            return true;
+        }
+    };
+
+    struct LogFormatPlaceholder {
+        size_t begin{ 0 }; // position of '{'
+        size_t end{ 0 }; // position after '}'
+        LogFormatSpec spec;
+    };
+
+    //Format string checked at compile time against the types of the arguments. The placeholders are located
+    //at compile time too, so formatting only copies the literal parts and appends the arguments.
+    template<typename... Args>
+    class BasicLogFormatString {
+    public:
+        template<typename T> requires std::convertible_to<const T&, std::string_view>
+        consteval BasicLogFormatString(const T& format) : m_format(format) {
+            constexpr std::array<bool, sizeof...(Args)> isInteger{ (std::is_integral_v<std::remove_cvref_t<Args>> || IsNonStringPointer<Args>)... };
+            constexpr std::array<bool, sizeof...(Args)> isFloat{ std::is_floating_point_v<std::remove_cvref_t<Args>>... };
+
+            size_t pos = 0;
+            size_t argIndex = 0;
+            LogFormatSpec spec;
+            for (;;) {
+                size_t placeholderBegin = m_format.find_first_of("{}", pos);
+                LogFormatToken token = LogFormatParser::Next(m_format, pos, spec, [this](std::string_view literal) {
+                    m_hasEscapes |= literal == "{" || literal == "}";
+                });
+
+                if (token == LogFormatToken::End) {
+                    break;
+                }
+
+                if (token == LogFormatToken::Error) {
+                    LogFormatError("Invalid placeholder, expected {}, {:x} or {:.N}");
+                    break;
+                }
+
+                if (argIndex >= sizeof...(Args)) {
+                    LogFormatError("More placeholders than arguments");
+                    break;
+                }
+
+                if (spec.hex && !isInteger[argIndex]) {
+                    LogFormatError("{:x} requires an integer or pointer argument");
+                }
+
+                if (spec.precision >= 0 && !isFloat[argIndex]) {
+                    LogFormatError("{:.N} requires a floating point argument");
+                }
+
+                //skip escaped braces preceding the placeholder
+                while (m_format[placeholderBegin] == m_format[placeholderBegin + 1]) {
+                    placeholderBegin = m_format.find_first_of("{}", placeholderBegin + 2);
+                }
+
+                m_placeholders[argIndex] = { placeholderBegin, pos, spec };
+                ++argIndex;
+            }
+
+            if (argIndex != sizeof...(Args)) {
+                LogFormatError("More arguments than placeholders");
+            }
+        }
+
+        constexpr std::string_view Get() const noexcept { return m_format; }
+        constexpr const LogFormatPlaceholder& GetPlaceholder(size_t index) const noexcept { return m_placeholders[index]; }
+        constexpr bool HasEscapes() const noexcept { return m_hasEscapes; }
+
+    private:
+        template<typename T>
+        static constexpr bool IsNonStringPointer = std::is_pointer_v<std::decay_t<T>>
+            && !std::is_same_v<std::remove_cv_t<std::remove_pointer_t<std::decay_t<T>>>, char>;
+
+        std::string_view m_format;
+        std::array<LogFormatPlaceholder, sizeof...(Args)> m_placeholders{};
+        bool m_hasEscapes{ false };
+    };
+
+    template<typename... Args>
+    using LogFormatString = BasicLogFormatString<std::type_identity_t<Args>...>;
+}
\ No newline at end of file
@@ -24,14 +24,25 @@ SOFTWARE.
 
 #pragma once
 
+#include <cctype>
+#include <string_view>
+
+//numeric values for use in preprocessor conditions, e.g. -DAGT_MAX_LOG_LEVEL=AGT_LOG_LEVEL_INFO_V1
+#define AGT_LOG_LEVEL_ERROR     0
+#define AGT_LOG_LEVEL_WARNING   1
+#define AGT_LOG_LEVEL_INFO_V1   2
+#define AGT_LOG_LEVEL_INFO_V2   3
+#define AGT_LOG_LEVEL_INFO_V3   4
+#define AGT_LOG_LEVEL_DEBUG     5
+
 namespace AGT {
     enum class LogLevel {
-        Error = 0,
-        Warning = 1,
-        InfoV1 = 2, // low noise
-        InfoV2 = 3, // medium noise
-        InfoV3 = 4, // high noise
-        Debug = 5
+        Error = AGT_LOG_LEVEL_ERROR,
+        Warning = AGT_LOG_LEVEL_WARNING,
+        InfoV1 = AGT_LOG_LEVEL_INFO_V1, // low noise
+        InfoV2 = AGT_LOG_LEVEL_INFO_V2, // medium noise
+        InfoV3 = AGT_LOG_LEVEL_INFO_V3, // high noise
+        Debug = AGT_LOG_LEVEL_DEBUG
     };
 
     static const char* LogLevelToString(LogLevel level) noexcept {
@@ -46,4 +57,21 @@ namespace AGT {
             return "Unknown";
         }
     }
+
+    //Accepts the names returned by LogLevelToString in any case, or the numeric value
+    static bool LogLevelFromString(std::string_view text, LogLevel& level) noexcept {
+        for (int value = AGT_LOG_LEVEL_ERROR; value <= AGT_LOG_LEVEL_DEBUG; ++value) {
+            std::string_view name = LogLevelToString(static_cast<LogLevel>(value));
+            bool equal = text.size() == name.size();
+            for (size_t i = 0; equal && i < name.size(); ++i) {
+                equal = std::tolower(static_cast<unsigned char>(text[i])) == std::tolower(static_cast<unsigned char>(name[i]));
+            }
+
+            if (equal || (text.size() == 1 && text[0] == '0' + value)) {
+                level = static_cast<LogLevel>(value);
+                return true;
+            }
+        }
+        return false;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,195 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "../thread/BoundedQueue.h"
+#include "LoggerAsyncConfig.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace AGT {
+    //A bounded queue of preallocated entries and the thread that drains it. Applies the overflow policy,
+    //counts what was written and dropped, and only wakes the thread when it is asleep.
+    //Used by the async DefaultLogger backend and by LoggerSinkWorker.
+    template<typename TEntry>
+    class LogQueueWorker {
+    public:
+        //fInit(TEntry&) prepares every slot once. fDrain(LogQueueWorker&) runs on the worker thread, pops entries
+        //with TryPop, reports them through MarkProcessed and returns how many it popped.
+        template<typename TInit>
+        static std::unique_ptr<LogQueueWorker<TEntry>> Create(
+            size_t queueSize,
+            LogOverflowPolicy overflowPolicy,
+            TInit&& fInit,
+            std::function<size_t(LogQueueWorker<TEntry>&)> fDrain
+        ) {
+            auto worker = std::unique_ptr<LogQueueWorker<TEntry>>(new LogQueueWorker<TEntry>());
+            if (worker && worker->Init(queueSize, overflowPolicy, std::forward<TInit>(fInit), std::move(fDrain))) {
+                return worker;
+            }
+
+            return nullptr;
+        }
+
+        ~LogQueueWorker() {
+            Stop();
+        }
+
+        //Drains whatever is still queued, then joins the thread
+        void Stop() {
+            if (!m_thread.joinable()) {
+                return;
+            }
+
+            m_running.store(false, std::memory_order_release);
+            Wake();
+            m_thread.join();
+        }
+
+        //Calls fFill(TEntry&) on a free slot. When the queue is full the overflow policy applies and
+        //fDiscard(TEntry&) is called on an entry DropOldest throws away. False if the entry was dropped.
+        template<typename TFill, typename TDiscard>
+        bool Push(TFill&& fFill, TDiscard&& fDiscard) {
+            while (!m_queue->TryPush(fFill)) {
+                switch (m_overflowPolicy) {
+                case LogOverflowPolicy::DropNewest:
+                    m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                case LogOverflowPolicy::DropOldest:
+                    if (m_queue->TryPop(fDiscard)) {
+                        m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+                        m_processedCount.fetch_add(1, std::memory_order_release);
+                    } else {
+                        std::this_thread::yield();
+                    }
+                    break;
+                case LogOverflowPolicy::Block:
+                default:
+                    Wake();
+                    std::this_thread::yield();
+                    break;
+                }
+            }
+
+            //only pay for the notification when the worker is actually asleep
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (m_waiting.load(std::memory_order_relaxed)) {
+                Wake();
+            }
+            return true;
+        }
+
+        //For fDrain
+        template<typename TConsume>
+        bool TryPop(TConsume&& fConsume) {
+            return m_queue->TryPop(fConsume);
+        }
+
+        //For fDrain, once the popped entries have been written
+        void MarkProcessed(uint64_t numEntries) noexcept {
+            m_processedCount.fetch_add(numEntries, std::memory_order_release);
+        }
+
+        //Waits until every entry pushed before the call has been processed. Slots claimed by pushes that are
+        //still filling count too, entries pushed after them are only popped once they are done.
+        void WaitProcessed() {
+            uint64_t target = m_queue->GetEnqueuedCount();
+            while (m_processedCount.load(std::memory_order_acquire) < target) {
+                Wake();
+                std::this_thread::yield();
+            }
+        }
+
+        uint64_t GetDroppedCount() const noexcept {
+            return m_droppedCount.load(std::memory_order_relaxed);
+        }
+
+    private:
+        LogQueueWorker(const LogQueueWorker&) = delete;
+        LogQueueWorker& operator=(const LogQueueWorker&) = delete;
+
+        LogQueueWorker() noexcept = default;
+
+        template<typename TInit>
+        bool Init(size_t queueSize, LogOverflowPolicy overflowPolicy, TInit&& fInit, std::function<size_t(LogQueueWorker<TEntry>&)> fDrain) {
+            if (queueSize == 0 || !fDrain) {
+                return false;
+            }
+
+            m_overflowPolicy = overflowPolicy;
+            m_drain = std::move(fDrain);
+            m_queue = std::make_unique<BoundedQueue<TEntry>>(queueSize, std::forward<TInit>(fInit));
+
+            m_running.store(true, std::memory_order_release);
+            m_thread = std::thread([this]() { WorkerLoop(); });
+            return true;
+        }
+
+        void Wake() {
+            std::lock_guard<std::mutex> lock(m_wakeLock);
+            m_wakeCondition.notify_one();
+        }
+
+        void WorkerLoop() {
+            for (;;) {
+                bool running = m_running.load(std::memory_order_acquire);
+                if (m_drain(*this) > 0) {
+                    continue;
+                }
+
+                if (!running) {
+                    return;
+                }
+
+                std::unique_lock<std::mutex> lock(m_wakeLock);
+                m_waiting.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (m_queue->IsEmpty() && m_running.load(std::memory_order_acquire)) {
+                    m_wakeCondition.wait_for(lock, std::chrono::milliseconds(10));
+                }
+                m_waiting.store(false, std::memory_order_relaxed);
+            }
+        }
+
+        std::unique_ptr<BoundedQueue<TEntry>> m_queue;
+        LogOverflowPolicy m_overflowPolicy{ LogOverflowPolicy::Block };
+        std::function<size_t(LogQueueWorker<TEntry>&)> m_drain;
+
+        std::thread m_thread;
+        std::atomic<bool> m_running{ false };
+        std::atomic<bool> m_waiting{ false };
+        std::mutex m_wakeLock;
+        std::condition_variable m_wakeCondition;
+        std::atomic<uint64_t> m_processedCount{ 0 };
+        std::atomic<uint64_t> m_droppedCount{ 0 };
+    };
+}
\ No newline at end of file
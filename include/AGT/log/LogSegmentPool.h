@@ -0,0 +1,133 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace AGT {
+    //One part of a log entry that outgrew its line buffer. Segments of an entry are chained through next
+    //and each part is null terminated, the terminator is not counted in size.
+    struct LogSegment {
+        LogSegment* next{ nullptr };
+        char* data{ nullptr };
+        size_t size{ 0 };
+        size_t capacity{ 0 }; // including the terminator
+        std::atomic<uint32_t> nextFree{ 0 }; // index + 1 of the next free segment, owned by the pool
+    };
+
+    //Preallocated segments handed out without locks or allocation. The free list head carries a tag
+    //that changes on every update, so a segment released and reacquired between a load and a CAS is detected.
+    class LogSegmentPool {
+    public:
+        static std::unique_ptr<LogSegmentPool> Create(size_t segmentSize, size_t numSegments) {
+            auto pool = std::unique_ptr<LogSegmentPool>(new LogSegmentPool());
+            if (pool && pool->Init(segmentSize, numSegments)) {
+                return pool;
+            }
+
+            return nullptr;
+        }
+
+        //Null when every segment is in use
+        LogSegment* TryAcquire() noexcept {
+            uint64_t head = m_freeHead.load(std::memory_order_acquire);
+            for (;;) {
+                uint32_t index = static_cast<uint32_t>(head);
+                if (!index) {
+                    m_exhaustedCount.fetch_add(1, std::memory_order_relaxed);
+                    return nullptr;
+                }
+
+                LogSegment& segment = m_segments[index - 1];
+                uint64_t next = MakeHead(segment.nextFree.load(std::memory_order_relaxed), head);
+                if (m_freeHead.compare_exchange_weak(head, next, std::memory_order_acquire, std::memory_order_acquire)) {
+                    segment.next = nullptr;
+                    segment.size = 0;
+                    segment.data[0] = '\0';
+                    return &segment;
+                }
+            }
+        }
+
+        //Returns a whole chain
+        void Release(LogSegment* chain) noexcept {
+            while (chain) {
+                LogSegment* next = chain->next;
+                uint32_t index = static_cast<uint32_t>(chain - m_segments.get()) + 1;
+                uint64_t head = m_freeHead.load(std::memory_order_relaxed);
+                do {
+                    chain->nextFree.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+                } while (!m_freeHead.compare_exchange_weak(head, MakeHead(index, head), std::memory_order_release, std::memory_order_relaxed));
+                chain = next;
+            }
+        }
+
+        size_t GetSegmentSize() const noexcept { return m_segmentSize; }
+
+        //Number of times an entry needed a segment and none was free. Such entries are truncated.
+        uint64_t GetExhaustedCount() const noexcept {
+            return m_exhaustedCount.load(std::memory_order_relaxed);
+        }
+
+    private:
+        LogSegmentPool(const LogSegmentPool&) = delete;
+        LogSegmentPool& operator=(const LogSegmentPool&) = delete;
+
+        LogSegmentPool() noexcept = default;
+
+        bool Init(size_t segmentSize, size_t numSegments) {
+            if (segmentSize < 2 || numSegments == 0 || numSegments >= UINT32_MAX) {
+                return false;
+            }
+
+            m_segmentSize = segmentSize;
+            m_arena.resize(segmentSize * numSegments);
+            m_segments.reset(new LogSegment[numSegments]);
+            for (size_t i = 0; i < numSegments; ++i) {
+                m_segments[i].data = m_arena.data() + i * segmentSize;
+                m_segments[i].capacity = segmentSize;
+                m_segments[i].nextFree.store(i + 1 < numSegments ? static_cast<uint32_t>(i + 2) : 0, std::memory_order_relaxed);
+            }
+
+            m_freeHead.store(MakeHead(1, 0), std::memory_order_release);
+            return true;
+        }
+
+        //Low half: index + 1 of the first free segment, high half: tag
+        static uint64_t MakeHead(uint32_t index, uint64_t previousHead) noexcept {
+            return ((previousHead >> 32) + 1) << 32 | index;
+        }
+
+        size_t m_segmentSize{ 0 };
+        std::vector<char> m_arena;
+        std::unique_ptr<LogSegment[]> m_segments;
+        std::atomic<uint64_t> m_freeHead{ 0 };
+        std::atomic<uint64_t> m_exhaustedCount{ 0 };
+    };
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "../platform/Socket.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace AGT {
+    //Where LoggerSocketSink sends and LogCollector listens
+    struct LogShippingEndpoint {
+        SocketType type{ SocketType::UnixStream };
+        std::string path;   // socket file, for SocketType::UnixStream
+        uint16_t port{ 0 }; // on 127.0.0.1, for SocketType::Udp
+
+        SocketAddress GetAddress() const noexcept {
+            return type == SocketType::UnixStream ? SocketAddress::FromUnixPath(path) : SocketAddress::FromLoopbackPort(port);
+        }
+    };
+
+    //Framing between LoggerSocketSink and LogCollector. Every entry is a frame:
+    //
+    //  uint32 size (little endian), size bytes of formatted entry text
+    //
+    //On a Unix stream the frames follow each other. Over UDP a datagram holds one or more whole frames.
+    class LogShippingFormat {
+    public:
+        static constexpr size_t FRAME_HEADER_SIZE = 4;
+        static constexpr size_t MAX_DATAGRAM_SIZE = 65507; // largest UDP payload over IPv4
+        static constexpr size_t MAX_FRAME_SIZE = 16 << 20; // larger sizes are treated as a corrupt stream
+
+        static void WriteFrameHeader(char* out, uint32_t size) noexcept {
+            for (size_t i = 0; i < FRAME_HEADER_SIZE; ++i) {
+                out[i] = static_cast<char>(size >> (8 * i));
+            }
+        }
+
+        static uint32_t ReadFrameHeader(const char* data) noexcept {
+            uint32_t size = 0;
+            for (size_t i = 0; i < FRAME_HEADER_SIZE; ++i) {
+                size |= static_cast<uint32_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+            }
+            return size;
+        }
+    };
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "../platform/Compiler.h"
+#include "LogCategory.h"
+#include "LogLevel.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <string_view>
+
+namespace AGT {
+    //Strips the directory from a path. Evaluated at compile time when given __FILE__ in a constant expression.
+    constexpr const char* GetLogFileName(const char* path) noexcept {
+        const char* fileName = path;
+        for (const char* pos = path; *pos; ++pos) {
+            if (*pos == '/' || *pos == '\\') {
+                fileName = pos + 1;
+            }
+        }
+        return fileName;
+    }
+
+    //Constant metadata of a log statement. The AGT_* macros keep one static instance per statement,
+    //so the "[file | function() | line]" part of the header is rendered once instead of on every call.
+    //Sites of a category append "[category]" and are enabled by the category's level.
+    class LogSite {
+    public:
+        static constexpr size_t MAX_PREFIX_SIZE = 128;
+
+        LogSite(LogLevel level, const char* fileName, const char* function, int lineNumber, const LogCategory* category = nullptr) noexcept
+            : m_level(level), m_fileName(fileName), m_function(function), m_lineNumber(lineNumber), m_category(category) {
+            int size = category ?
+                snprintf(m_prefix, sizeof(m_prefix), "[%s | %s() | %i][%s]", fileName, function, lineNumber, category->GetName()) :
+                snprintf(m_prefix, sizeof(m_prefix), "[%s | %s() | %i]", fileName, function, lineNumber);
+            m_prefixSize = size < 0 ? 0 : std::min(static_cast<size_t>(size), sizeof(m_prefix) - 1);
+        }
+
+        LogLevel GetLevel() const noexcept { return m_level; }
+        const char* GetFileName() const noexcept { return m_fileName; }
+        const char* GetFunction() const noexcept { return m_function; }
+        int GetLineNumber() const noexcept { return m_lineNumber; }
+        const LogCategory* GetCategory() const noexcept { return m_category; }
+        std::string_view GetPrefix() const noexcept { return std::string_view(m_prefix, m_prefixSize); }
+
+    private:
+        LogSite(const LogSite&) = delete;
+        LogSite& operator=(const LogSite&) = delete;
+
+        LogLevel m_level;
+        const char* m_fileName;
+        const char* m_function;
+        int m_lineNumber;
+        const LogCategory* m_category;
+        size_t m_prefixSize{ 0 };
+        char m_prefix[MAX_PREFIX_SIZE];
+    };
+
+    //Never called. Referenced from the AGT_* macros so the compiler checks the format string against the arguments.
+    AGT_PRINTF_FORMAT(1, 2) inline void CheckLogFormat(AGT_PRINTF_FORMAT_STRING const char* /*format*/, ...) noexcept {}
+}
@@ -0,0 +1,114 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "LogArgs.h"
+#include "LogLevel.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <span>
+
+namespace AGT {
+    //Per call site slot holding the registered site id, 0 until the site is first used
+    struct LogSiteHandle {
+        std::atomic<uint32_t> id{ 0 };
+    };
+
+    struct LogSiteDescriptor {
+        uint32_t id{ 0 };
+        LogLevel level{ LogLevel::Debug };
+        const char* file{ nullptr };
+        const char* function{ nullptr };
+        int lineNumber{ 0 };
+        const char* format{ nullptr };
+        std::span<const LogArgType> argTypes;
+    };
+
+    //Process wide table of log call sites. Registration takes a lock once per site, lookups are lock-free.
+    //The strings are referenced, not copied, so they must be literals or otherwise outlive the process.
+    class LogSiteRegistry {
+    public:
+        static constexpr uint32_t CHUNK_SIZE = 1024;
+        static constexpr uint32_t MAX_CHUNKS = 64;
+
+        template<typename... Args>
+        static uint32_t Register(LogSiteHandle& handle, LogLevel level, const char* file, const char* function, int lineNumber, const char* format) noexcept {
+            static constexpr std::array<LogArgType, sizeof...(Args)> ARG_TYPES{ GetLogArgType<Args>()... };
+
+            std::lock_guard<std::mutex> lock(s_lock);
+
+            uint32_t id = handle.id.load(std::memory_order_relaxed);
+            if (id) {
+                return id;
+            }
+
+            uint32_t index = s_numSites;
+            uint32_t chunkIndex = index / CHUNK_SIZE;
+            if (chunkIndex >= MAX_CHUNKS) {
+                return 0;
+            }
+
+            LogSiteDescriptor* chunk = s_chunks[chunkIndex].load(std::memory_order_relaxed);
+            if (!chunk) {
+                chunk = new LogSiteDescriptor[CHUNK_SIZE];
+                s_chunks[chunkIndex].store(chunk, std::memory_order_release);
+            }
+
+            id = index + 1;
+            LogSiteDescriptor& site = chunk[index % CHUNK_SIZE];
+            site.id = id;
+            site.level = level;
+            site.file = file;
+            site.function = function;
+            site.lineNumber = lineNumber;
+            site.format = format;
+            site.argTypes = ARG_TYPES;
+
+            ++s_numSites;
+            handle.id.store(id, std::memory_order_release);
+            return id;
+        }
+
+        static const LogSiteDescriptor* Get(uint32_t id) noexcept {
+            if (id == 0 || id > CHUNK_SIZE * MAX_CHUNKS) {
+                return nullptr;
+            }
+
+            uint32_t index = id - 1;
+            LogSiteDescriptor* chunk = s_chunks[index / CHUNK_SIZE].load(std::memory_order_acquire);
+            return chunk ? &chunk[index % CHUNK_SIZE] : nullptr;
+        }
+
+    private:
+        LogSiteRegistry() = delete;
+
+        static inline std::mutex s_lock;
+        static inline uint32_t s_numSites{ 0 };
+        static inline std::atomic<LogSiteDescriptor*> s_chunks[MAX_CHUNKS]{};
+    };
+}
@@ -0,0 +1,185 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "../time/TscClock.h"
+#include "LogLevel.h"
+#include "LogSiteRegistry.h"
+
+#include <atomic>
+#include <cstdint>
+
+namespace AGT {
+    enum class LogThrottleMode : uint8_t {
+        EveryN,     //1st, N+1th, 2N+1th... call
+        FirstN,     //first N calls, then silence
+        Rate        //token bucket refilled with N tokens per second, bursts of up to N
+    };
+
+    //Per call site limiter kept as a static by the AGT_*_EVERY_N / _FIRST_N / _RATE macros.
+    //The checks are lock-free and a suppressed call costs one atomic increment (Rate adds a clock read).
+    //Suppressed counts are reported once the site logs again, or by ForEachSuppressed for sites that stay quiet.
+    class LogThrottle {
+    public:
+        constexpr LogThrottle(
+            LogThrottleMode mode,
+            uint64_t limit,
+            LogLevel level,
+            const char* fileName,
+            const char* function,
+            int lineNumber
+        ) noexcept
+            : m_mode(mode),
+            m_limit(limit ? limit : 1),
+            m_level(level),
+            m_fileName(fileName),
+            m_function(function),
+            m_lineNumber(lineNumber) {
+            m_intervalNs = NS_PER_SECOND / m_limit;
+        }
+
+        bool ShouldLog() noexcept {
+            switch (m_mode) {
+            case LogThrottleMode::EveryN:
+                if (m_count.fetch_add(1, std::memory_order_relaxed) % m_limit == 0) {
+                    return true;
+                }
+                break;
+            case LogThrottleMode::FirstN:
+                if (m_count.fetch_add(1, std::memory_order_relaxed) < m_limit) {
+                    return true;
+                }
+                break;
+            case LogThrottleMode::Rate:
+                if (TryTakeToken()) {
+                    return true;
+                }
+                m_count.fetch_add(1, std::memory_order_relaxed);
+                break;
+            }
+
+            if (!m_registered.load(std::memory_order_relaxed)) {
+                Register();
+            }
+            return false;
+        }
+
+        //Number of calls suppressed since the last report. Concurrent callers never report the same call twice.
+        uint64_t TakeSuppressedCount() noexcept {
+            uint64_t total = GetTotalSuppressed();
+            uint64_t reported = m_reported.load(std::memory_order_relaxed);
+            while (reported < total) {
+                if (m_reported.compare_exchange_weak(reported, total, std::memory_order_relaxed)) {
+                    return total - reported;
+                }
+            }
+            return 0;
+        }
+
+        //Calls f(throttle, count) for every site with unreported suppressed calls
+        template<typename F>
+        static void ForEachSuppressed(F&& f) {
+            for (LogThrottle* throttle = s_head.load(std::memory_order_acquire); throttle; throttle = throttle->m_next) {
+                if (uint64_t count = throttle->TakeSuppressedCount()) {
+                    f(*throttle, count);
+                }
+            }
+        }
+
+        LogLevel GetLevel() const noexcept { return m_level; }
+        const char* GetFileName() const noexcept { return m_fileName; }
+        const char* GetFunction() const noexcept { return m_function; }
+        int GetLineNumber() const noexcept { return m_lineNumber; }
+        LogSiteHandle& GetSummarySite() noexcept { return m_summarySite; }
+
+    private:
+        LogThrottle(const LogThrottle&) = delete;
+        LogThrottle& operator=(const LogThrottle&) = delete;
+
+        static constexpr uint64_t NS_PER_SECOND = 1'000'000'000;
+
+        //GCRA form of the token bucket: m_nextTokenNs is when the bucket would be empty-but-refilled,
+        //a call conforms while it is less than a full bucket ahead of now
+        bool TryTakeToken() noexcept {
+            uint64_t now = TscClock::GetMonotonicNs();
+            uint64_t burstNs = (m_limit - 1) * m_intervalNs;
+            uint64_t next = m_nextTokenNs.load(std::memory_order_relaxed);
+            for (;;) {
+                if (next > now + burstNs) {
+                    return false;
+                }
+
+                uint64_t newNext = (next > now ? next : now) + m_intervalNs;
+                if (m_nextTokenNs.compare_exchange_weak(next, newNext, std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+        }
+
+        uint64_t GetTotalSuppressed() const noexcept {
+            uint64_t count = m_count.load(std::memory_order_relaxed);
+            switch (m_mode) {
+            case LogThrottleMode::EveryN:
+                return count - (count + m_limit - 1) / m_limit;
+            case LogThrottleMode::FirstN:
+                return count > m_limit ? count - m_limit : 0;
+            case LogThrottleMode::Rate:
+                return count;
+            }
+            return 0;
+        }
+
+        void Register() noexcept {
+            bool expected = false;
+            if (!m_registered.compare_exchange_strong(expected, true, std::memory_order_relaxed)) {
+                return;
+            }
+
+            LogThrottle* head = s_head.load(std::memory_order_relaxed);
+            do {
+                m_next = head;
+            } while (!s_head.compare_exchange_weak(head, this, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        static inline std::atomic<LogThrottle*> s_head{ nullptr };
+
+        LogThrottleMode m_mode;
+        uint64_t m_limit;
+        uint64_t m_intervalNs;
+        LogLevel m_level;
+        const char* m_fileName;
+        const char* m_function;
+        int m_lineNumber;
+
+        //calls for EveryN/FirstN, suppressed calls for Rate
+        std::atomic<uint64_t> m_count{ 0 };
+        std::atomic<uint64_t> m_reported{ 0 };
+        std::atomic<uint64_t> m_nextTokenNs{ 0 };
+
+        std::atomic<bool> m_registered{ false };
+        LogThrottle* m_next{ nullptr };
+        LogSiteHandle m_summarySite;
+    };
+}
\ No newline at end of file
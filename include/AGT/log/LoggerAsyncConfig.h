@@ -0,0 +1,74 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "ILoggerSink.h"
+#include "LogLevel.h"
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+
+namespace AGT {
+    enum class LogOverflowPolicy {
+        Block,      // producer waits for a free slot
+        DropNewest, // the entry being written is discarded
+        DropOldest  // the oldest queued entry is discarded to make room
+    };
+
+    struct LoggerAsyncConfig {
+        size_t queueSize{ 4096 };
+        LogOverflowPolicy overflowPolicy{ LogOverflowPolicy::Block };
+    };
+
+    struct LoggerSinkConfig {
+        std::shared_ptr<ILoggerSink> sink;
+        LogLevel maxLevel{ LogLevel::Debug };
+        //0 writes to the sink from the logging thread, or the backend in async mode.
+        //Otherwise the sink gets a queue of this size and its own worker thread, Block is not supported there.
+        size_t queueSize{ 0 };
+        LogOverflowPolicy overflowPolicy{ LogOverflowPolicy::DropNewest };
+    };
+
+    //Entries longer than maxLineSize continue in segments from a pool of numSegments preallocated segments
+    //instead of being cut. Zero segments keeps the truncation.
+    struct LoggerSpillConfig {
+        size_t segmentSize{ 4096 };
+        size_t numSegments{ 0 };
+    };
+
+    enum class DeferredLogOutput {
+        Text,   // the backend formats entries and writes text to the sinks
+        Binary  // the sinks receive the binary stream, see BinaryLogReader
+    };
+
+    struct DeferredLoggerConfig {
+        size_t threadBufferSize{ 1 << 20 };
+        //DropOldest behaves like DropNewest, only the backend may consume from a staging buffer
+        LogOverflowPolicy overflowPolicy{ LogOverflowPolicy::Block };
+        DeferredLogOutput output{ DeferredLogOutput::Text };
+        std::chrono::microseconds pollInterval{ 1000 };
+    };
+}
@@ -0,0 +1,245 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "../compression/LzCodec.h"
+#include "../platform/File.h"
+#include "../time/TscClock.h"
+#include "CompressedLogFormat.h"
+#include "ILoggerSink.h"
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace AGT {
+    //Collects entries into blocks of a fixed size. Full blocks are compressed and written by a background thread,
+    //so the writing thread only copies. It waits only if all maxPendingBlocks blocks are still queued for compression.
+    //Use CompressedLogReader to read the file.
+    class LoggerCompressedFileSink : public ILoggerSink {
+    public:
+        static constexpr size_t DEFAULT_BLOCK_SIZE = 256 * 1024;
+        static constexpr size_t DEFAULT_MAX_PENDING_BLOCKS = 4;
+
+        ~LoggerCompressedFileSink() noexcept {
+            if (!m_worker.joinable()) {
+                return;
+            }
+
+            Flush();
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_running = false;
+            }
+            m_workAvailable.notify_one();
+            m_worker.join();
+        }
+
+        static std::unique_ptr<LoggerCompressedFileSink> Create(
+            const char* path,
+            size_t blockSize = DEFAULT_BLOCK_SIZE,
+            size_t maxPendingBlocks = DEFAULT_MAX_PENDING_BLOCKS
+        ) {
+            auto sink = std::unique_ptr<LoggerCompressedFileSink>(new LoggerCompressedFileSink());
+            if (sink && sink->Init(path, blockSize, maxPendingBlocks)) {
+                return sink;
+            }
+
+            return nullptr;
+        }
+
+        void Write(const char* msg, size_t size) override {
+            IoBuffer entry{ msg, size };
+            WriteBatch({ &entry, 1 });
+        }
+
+        void WriteBatch(std::span<const IoBuffer> entries) override {
+            uint64_t timestampNs = TscClock::GetTimeSinceEpochNs();
+            for (const IoBuffer& entry : entries) {
+                AppendEntry(static_cast<const char*>(entry.data), entry.size, timestampNs);
+            }
+        }
+
+        //Compresses the partially filled block and waits until everything is written
+        void Flush() override {
+            std::unique_lock<std::mutex> lock(m_lock);
+            if (m_current && m_current->size > 0) {
+                SealBlock(lock);
+            }
+            m_stateChanged.wait(lock, [this]() { return m_pending.empty() && !m_compressing; });
+        }
+
+    private:
+        LoggerCompressedFileSink(const LoggerCompressedFileSink&) = delete;
+        LoggerCompressedFileSink& operator=(const LoggerCompressedFileSink&) = delete;
+
+        LoggerCompressedFileSink() noexcept = default;
+
+        struct Block {
+            std::vector<char> data;
+            size_t size{ 0 };
+            uint32_t numEntries{ 0 };
+            uint64_t firstTimestampNs{ 0 };
+            uint64_t lastTimestampNs{ 0 };
+        };
+
+        bool Init(const char* path, size_t blockSize, size_t maxPendingBlocks) {
+            if (blockSize == 0 || blockSize > CompressedLogFormat::MAX_BLOCK_SIZE || maxPendingBlocks == 0) {
+                return false;
+            }
+
+            m_file = File::Create(path);
+            if (!m_file) {
+                return false;
+            }
+
+            CompressedLogFileHeader header{ CompressedLogFormat::MAGIC, CompressedLogFormat::VERSION };
+            if (!m_file->Write(&header, sizeof(header))) {
+                return false;
+            }
+
+            m_blockSize = blockSize;
+            m_compressed.resize(LzCodec::GetMaxCompressedSize(blockSize));
+
+            //one block is filled while the others wait for the compressor
+            for (size_t i = 0; i < maxPendingBlocks + 1; ++i) {
+                auto block = std::make_unique<Block>();
+                block->data.resize(blockSize);
+                m_free.push_back(std::move(block));
+            }
+
+            m_running = true;
+            m_worker = std::thread([this]() { WorkerLoop(); });
+            return true;
+        }
+
+        void AppendEntry(const char* data, size_t size, uint64_t timestampNs) {
+            bool entryStarted = false;
+            while (size > 0) {
+                if (!m_current) {
+                    std::unique_lock<std::mutex> lock(m_lock);
+                    m_stateChanged.wait(lock, [this]() { return !m_free.empty(); });
+                    m_current = std::move(m_free.back());
+                    m_free.pop_back();
+                }
+
+                //keep entries whole unless they are larger than a block
+                size_t numLeft = m_blockSize - m_current->size;
+                if (numLeft == 0 || (size > numLeft && m_current->size > 0 && size <= m_blockSize)) {
+                    std::unique_lock<std::mutex> lock(m_lock);
+                    SealBlock(lock);
+                    continue;
+                }
+
+                if (!entryStarted) {
+                    if (m_current->numEntries++ == 0) {
+                        m_current->firstTimestampNs = timestampNs;
+                    }
+                    m_current->lastTimestampNs = timestampNs;
+                    entryStarted = true;
+                }
+
+                size_t numCopied = std::min(size, numLeft);
+                memcpy(m_current->data.data() + m_current->size, data, numCopied);
+                m_current->size += numCopied;
+                data += numCopied;
+                size -= numCopied;
+            }
+        }
+
+        void SealBlock(std::unique_lock<std::mutex>&) {
+            m_pending.push_back(std::move(m_current));
+            m_workAvailable.notify_one();
+        }
+
+        void WorkerLoop() {
+            std::unique_lock<std::mutex> lock(m_lock);
+            for (;;) {
+                m_workAvailable.wait(lock, [this]() { return !m_pending.empty() || !m_running; });
+                if (m_pending.empty()) {
+                    return;
+                }
+
+                std::unique_ptr<Block> block = std::move(m_pending.front());
+                m_pending.pop_front();
+                m_compressing = true;
+
+                lock.unlock();
+                WriteBlock(*block);
+                block->size = 0;
+                block->numEntries = 0;
+                lock.lock();
+
+                m_free.push_back(std::move(block));
+                m_compressing = false;
+                m_stateChanged.notify_all();
+            }
+        }
+
+        void WriteBlock(const Block& block) {
+            CompressedLogBlockHeader header{};
+            header.size = static_cast<uint32_t>(block.size);
+            header.numEntries = block.numEntries;
+            header.firstTimestampNs = block.firstTimestampNs;
+            header.lastTimestampNs = block.lastTimestampNs;
+
+            size_t compressedSize = m_codec.Compress({ block.data.data(), block.size }, m_compressed);
+            std::array<IoBuffer, 2> buffers = { IoBuffer{ &header, sizeof(header) }, IoBuffer{ m_compressed.data(), compressedSize } };
+
+            //stored raw if compression doesn't help
+            if (compressedSize == 0 || compressedSize >= block.size) {
+                compressedSize = block.size;
+                buffers[1] = { block.data.data(), block.size };
+            }
+
+            header.compressedSize = static_cast<uint32_t>(compressedSize);
+            m_file->Write(buffers);
+        }
+
+        std::unique_ptr<File> m_file;
+        size_t m_blockSize{ 0 };
+        std::unique_ptr<Block> m_current; // only used by the writing thread
+
+        std::mutex m_lock;
+        std::condition_variable m_workAvailable;
+        std::condition_variable m_stateChanged;
+        std::deque<std::unique_ptr<Block>> m_pending;
+        std::vector<std::unique_ptr<Block>> m_free;
+        bool m_compressing{ false };
+        bool m_running{ false };
+        std::thread m_worker;
+
+        //compressor state, only used by the worker
+        LzCodec m_codec;
+        std::vector<char> m_compressed;
+    };
+}
\ No newline at end of file
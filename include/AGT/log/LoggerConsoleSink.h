@@ -24,17 +24,26 @@ SOFTWARE.
 
 #pragma once
 
+#include "../platform/File.h"
 #include "ILoggerSink.h"
 
-#include <cstdio>
+#include <span>
 
 namespace AGT {
     class LoggerConsoleSink : public ILoggerSink {
     public:
         LoggerConsoleSink() noexcept = default;
 
-        void Write(const char* msg, size_t /*size*/) noexcept override {
-            printf(msg);
+        void Write(const char* msg, size_t size) noexcept override {
+            File::GetStandardOutput().Write(msg, size);
+        }
+
+        void WriteBatch(std::span<const IoBuffer> entries) noexcept override {
+            File::GetStandardOutput().Write(entries);
+        }
+
+        void WriteScattered(std::span<const IoBuffer> parts) noexcept override {
+            File::GetStandardOutput().Write(parts);
         }
 
     private:
@@ -24,22 +24,24 @@ SOFTWARE.
 
 #pragma once
 
+#include "../platform/File.h"
 #include "ILoggerSink.h"
 
-#include <filesystem>
-#include <fstream>
+#include <cstring>
 #include <memory>
+#include <span>
 #include <vector>
 
 namespace AGT {
     class LoggerFileSink : public ILoggerSink {
     public:
+        static constexpr size_t DEFAULT_BUFFER_SIZE = 8 * 1024;
+
         ~LoggerFileSink() noexcept {
-            if (m_file.is_open()) {
-                m_file.close();
-            }
+            FlushBuffer();
         }
 
+        //Entries are collected in a buffer of buffSize bytes, anything that doesn't fit goes out with one writev
         static std::unique_ptr<LoggerFileSink> Create(const char* path, size_t buffSize = 0) {
             auto sink = std::unique_ptr<LoggerFileSink>(new LoggerFileSink());
             if (sink && sink->Init(path, buffSize)) {
@@ -50,15 +52,38 @@ namespace AGT {
         }
 
         void Write(const char* msg, size_t size) override {
-            if (!m_file.is_open()) {
+            IoBuffer entry{ msg, size };
+            WriteBatch({ &entry, 1 });
+        }
+
+        void WriteBatch(std::span<const IoBuffer> entries) override {
+            size_t totalSize = 0;
+            for (const IoBuffer& entry : entries) {
+                totalSize += entry.size;
+            }
+
+            if (totalSize <= m_buffer.size() - m_bufferSize) {
+                for (const IoBuffer& entry : entries) {
+                    memcpy(m_buffer.data() + m_bufferSize, entry.data, entry.size);
+                    m_bufferSize += entry.size;
+                }
                 return;
             }
 
-            m_file.write(msg, size);
+            m_batch.clear();
+            m_batch.push_back({ m_buffer.data(), m_bufferSize });
+            m_batch.insert(m_batch.end(), entries.begin(), entries.end());
+            m_file->Write(m_batch);
+            m_bufferSize = 0;
+        }
+
+        //The parts are contiguous in the file, so they are written like a batch
+        void WriteScattered(std::span<const IoBuffer> parts) override {
+            WriteBatch(parts);
         }
 
         void Flush() override {
-            m_file.flush();
+            FlushBuffer();
         }
     private:
         LoggerFileSink(const LoggerFileSink&) = delete;
@@ -67,16 +92,21 @@ namespace AGT {
         LoggerFileSink() noexcept = default;
 
         bool Init(const char* path, size_t buffSize) {
-            if (buffSize > 0) {
-                m_buffer.resize(buffSize);
-                m_file.rdbuf()->pubsetbuf(&m_buffer.front(), m_buffer.size());
-            }
+            m_buffer.resize(buffSize > 0 ? buffSize : DEFAULT_BUFFER_SIZE);
+            m_file = File::Create(path);
+            return m_file != nullptr;
+        }
 
-            m_file.open(path, std::ios::trunc);
-            return m_file.is_open();
+        void FlushBuffer() noexcept {
+            if (m_file && m_bufferSize > 0) {
+                m_file->Write(m_buffer.data(), m_bufferSize);
+            }
+            m_bufferSize = 0;
         }
 
-        std::ofstream m_file;
+        std::unique_ptr<File> m_file;
         std::vector<char> m_buffer;
+        size_t m_bufferSize{ 0 };
+        std::vector<IoBuffer> m_batch;
     };
 }
\ No newline at end of file
@@ -0,0 +1,232 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "../platform/MappedFile.h"
+#include "ILoggerSink.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+
+namespace AGT {
+    //Writes into memory mapped, preallocated segments of a fixed size. When a segment is full, it is cut to the
+    //size used and renamed, "game.log" becomes "game.1.log", "game.1.log" becomes "game.2.log" and so on.
+    //Entries are never split across segments unless they are larger than a segment.
+    //A background thread creates and faults in the next segment as "game.next.log" ahead of time, so a rotation
+    //only swaps the mappings. The same thread then cuts and renames the full segment and moves the new one
+    //to "game.log", until it is done the newest entries are in "game.next.log".
+    class LoggerMappedFileSink : public ILoggerSink {
+    public:
+        static constexpr size_t DEFAULT_SEGMENT_SIZE = 16 * 1024 * 1024;
+
+        ~LoggerMappedFileSink() noexcept {
+            if (m_worker.joinable()) {
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    m_running = false;
+                }
+                m_workAvailable.notify_one();
+                m_worker.join();
+            }
+
+            if (m_file) {
+                m_file->Close(m_offset);
+            }
+            if (m_prepared) {
+                m_prepared.reset();
+                std::error_code error;
+                std::filesystem::remove(m_preparedPath, error);
+            }
+        }
+
+        //Logs of a previous run are rotated as well, numRetainedFiles counts the files kept besides the active one
+        static std::unique_ptr<LoggerMappedFileSink> Create(const char* path, size_t segmentSize = DEFAULT_SEGMENT_SIZE, size_t numRetainedFiles = 4) {
+            auto sink = std::unique_ptr<LoggerMappedFileSink>(new LoggerMappedFileSink());
+            if (sink && sink->Init(path, segmentSize, numRetainedFiles)) {
+                return sink;
+            }
+
+            return nullptr;
+        }
+
+        void Write(const char* msg, size_t size) override {
+            while (size > 0 && m_file) {
+                size_t numLeft = m_file->GetSize() - m_offset;
+                if (numLeft == 0 || (size > numLeft && size <= m_file->GetSize())) {
+                    Rotate();
+                    continue;
+                }
+
+                size_t numCopied = std::min(size, numLeft);
+                memcpy(m_file->GetData() + m_offset, msg, numCopied);
+                m_offset += numCopied;
+                msg += numCopied;
+                size -= numCopied;
+            }
+        }
+
+        void Flush() override {
+            if (m_file) {
+                m_file->Flush();
+            }
+        }
+
+        //index 0 is the active segment
+        static std::filesystem::path GetSegmentPath(const std::filesystem::path& path, size_t index) {
+            if (index == 0) {
+                return path;
+            }
+
+            std::filesystem::path segmentPath = path;
+            segmentPath.replace_filename(path.stem().string() + "." + std::to_string(index) + path.extension().string());
+            return segmentPath;
+        }
+
+        //Where the next segment is prepared
+        static std::filesystem::path GetPreparedSegmentPath(const std::filesystem::path& path) {
+            std::filesystem::path preparedPath = path;
+            preparedPath.replace_filename(path.stem().string() + ".next" + path.extension().string());
+            return preparedPath;
+        }
+
+    private:
+        LoggerMappedFileSink(const LoggerMappedFileSink&) = delete;
+        LoggerMappedFileSink& operator=(const LoggerMappedFileSink&) = delete;
+
+        LoggerMappedFileSink() noexcept = default;
+
+        bool Init(const char* path, size_t segmentSize, size_t numRetainedFiles) {
+            m_path = path;
+            m_preparedPath = GetPreparedSegmentPath(m_path);
+            m_segmentSize = segmentSize;
+            m_numRetainedFiles = numRetainedFiles;
+
+            std::error_code error;
+            if (std::filesystem::exists(m_path, error)) {
+                ShiftSegments();
+            }
+
+            //a run that stopped during a rotation left its newest entries in the prepared segment
+            if (HasEntries(m_preparedPath)) {
+                std::filesystem::rename(m_preparedPath, m_path, error);
+                ShiftSegments();
+            }
+            std::filesystem::remove(m_preparedPath, error);
+
+            m_file = MappedFile::Create(m_path, m_segmentSize);
+            if (!m_file) {
+                return false;
+            }
+
+            m_running = true;
+            m_worker = std::thread([this]() { WorkerLoop(); });
+            return true;
+        }
+
+        //Swaps in the prepared segment, waits only if the worker is still preparing it
+        void Rotate() {
+            std::unique_lock<std::mutex> lock(m_lock);
+            m_stateChanged.wait(lock, [this]() { return m_prepared || m_prepareFailed; });
+
+            m_retired = std::move(m_file);
+            m_retiredSize = m_offset;
+            //null if preparing failed, the sink stops writing then
+            m_file = std::move(m_prepared);
+            m_offset = 0;
+            m_workAvailable.notify_one();
+        }
+
+        void WorkerLoop() {
+            std::unique_lock<std::mutex> lock(m_lock);
+            for (;;) {
+                m_workAvailable.wait(lock, [this]() { return m_retired || !m_running || (!m_prepared && !m_prepareFailed); });
+                if (m_retired) {
+                    std::unique_ptr<MappedFile> retired = std::move(m_retired);
+                    size_t retiredSize = m_retiredSize;
+                    lock.unlock();
+
+                    retired->Close(retiredSize);
+                    ShiftSegments();
+                    std::error_code error;
+                    std::filesystem::rename(m_preparedPath, m_path, error);
+
+                    lock.lock();
+                    continue;
+                }
+
+                if (!m_running) {
+                    return;
+                }
+
+                lock.unlock();
+                std::unique_ptr<MappedFile> prepared = MappedFile::Create(m_preparedPath, m_segmentSize);
+                lock.lock();
+
+                m_prepareFailed = !prepared;
+                m_prepared = std::move(prepared);
+                m_stateChanged.notify_all();
+            }
+        }
+
+        //Prepared segments are zero filled, entries never start with a null character
+        static bool HasEntries(const std::filesystem::path& path) {
+            std::ifstream file(path, std::ios::binary);
+            return file && file.peek() > 0;
+        }
+
+        void ShiftSegments() {
+            std::error_code error;
+            std::filesystem::remove(GetSegmentPath(m_path, m_numRetainedFiles), error);
+            for (size_t i = m_numRetainedFiles; i > 0; --i) {
+                std::filesystem::rename(GetSegmentPath(m_path, i - 1), GetSegmentPath(m_path, i), error);
+            }
+        }
+
+        std::filesystem::path m_path;
+        std::filesystem::path m_preparedPath;
+        std::unique_ptr<MappedFile> m_file; // only used by the writing thread
+        size_t m_segmentSize{ 0 };
+        size_t m_numRetainedFiles{ 0 };
+        size_t m_offset{ 0 };
+
+        std::mutex m_lock;
+        std::condition_variable m_workAvailable;
+        std::condition_variable m_stateChanged;
+        std::unique_ptr<MappedFile> m_prepared;
+        std::unique_ptr<MappedFile> m_retired;
+        size_t m_retiredSize{ 0 };
+        bool m_prepareFailed{ false };
+        bool m_running{ false };
+        std::thread m_worker;
+    };
+}
\ No newline at end of file
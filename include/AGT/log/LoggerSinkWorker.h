@@ -0,0 +1,262 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "../platform/IoBuffer.h"
+#include "ILoggerSink.h"
+#include "LogQueueWorker.h"
+#include "LogSegmentPool.h"
+#include "LoggerAsyncConfig.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace AGT {
+    //Delivers formatted entries to one sink from its own queue and thread, so a slow sink only delays itself.
+    //When the queue is full the overflow policy applies to this sink alone. Block is rejected, entries are pushed
+    //under the logger's lock and waiting there for a slow sink would stall every logging thread.
+    //Entries longer than maxEntrySize continue in segments of a spill pool of the worker's own, sized like the logger's.
+    class LoggerSinkWorker {
+    public:
+        static std::unique_ptr<LoggerSinkWorker> Create(
+            std::shared_ptr<ILoggerSink> sink,
+            size_t queueSize,
+            size_t maxEntrySize,
+            LogOverflowPolicy overflowPolicy,
+            const LoggerSpillConfig& spillConfig = {}
+        ) {
+            auto worker = std::unique_ptr<LoggerSinkWorker>(new LoggerSinkWorker());
+            if (worker && worker->Init(std::move(sink), queueSize, maxEntrySize, overflowPolicy, spillConfig)) {
+                return worker;
+            }
+
+            return nullptr;
+        }
+
+        //Writes out whatever is still queued
+        ~LoggerSinkWorker() {
+            if (m_queue) {
+                m_queue->Stop();
+            }
+        }
+
+        //Entries larger than maxEntrySize are cut
+        void Push(const char* data, size_t size) {
+            size = std::min(size, m_maxEntrySize);
+            PushEntry([data, size](Entry& entry) {
+                memcpy(entry.buffer.data(), data, size);
+                entry.size = size;
+            });
+        }
+
+        //An entry given in parts, the sink receives it as one scatter list. What does not fit in maxEntrySize
+        //is copied to spill segments up front, if there are not enough free ones the entry is cut.
+        void PushScattered(std::span<const IoBuffer> parts) {
+            size_t totalSize = 0;
+            for (const IoBuffer& part : parts) {
+                totalSize += part.size;
+            }
+
+            size_t inlineSize = std::min(totalSize, m_maxEntrySize);
+            LogSegment* spilled = totalSize > inlineSize ? Spill(parts, inlineSize, totalSize - inlineSize) : nullptr;
+            bool pushed = PushEntry([parts, inlineSize, spilled](Entry& entry) {
+                entry.size = CopyParts(parts, 0, entry.buffer.data(), inlineSize);
+                entry.spilled = spilled;
+            });
+
+            if (!pushed) {
+                ReleaseSpilled(spilled);
+            }
+        }
+
+        //Waits until every entry pushed before the call has been written, then flushes the sink
+        void Flush() {
+            m_queue->WaitProcessed();
+
+            std::lock_guard<std::mutex> lock(m_sinkLock);
+            m_sink->Flush();
+        }
+
+        uint64_t GetDroppedCount() const noexcept {
+            return m_queue->GetDroppedCount();
+        }
+
+    private:
+        LoggerSinkWorker(const LoggerSinkWorker&) = delete;
+        LoggerSinkWorker& operator=(const LoggerSinkWorker&) = delete;
+
+        LoggerSinkWorker() noexcept = default;
+
+        struct Entry {
+            std::vector<char> buffer;
+            size_t size{ 0 };
+            LogSegment* spilled{ nullptr }; // the rest of an entry longer than the buffer
+        };
+
+        static constexpr size_t MAX_BATCH_SIZE = 64;
+
+        bool Init(
+            std::shared_ptr<ILoggerSink> sink,
+            size_t queueSize,
+            size_t maxEntrySize,
+            LogOverflowPolicy overflowPolicy,
+            const LoggerSpillConfig& spillConfig
+        ) {
+            if (!sink || queueSize == 0 || maxEntrySize == 0 || overflowPolicy == LogOverflowPolicy::Block) {
+                return false;
+            }
+
+            if (spillConfig.numSegments > 0) {
+                m_spillPool = LogSegmentPool::Create(spillConfig.segmentSize, spillConfig.numSegments);
+                if (!m_spillPool) {
+                    return false;
+                }
+                m_scatterParts.reserve(spillConfig.numSegments + 1);
+            }
+
+            m_sink = std::move(sink);
+            m_maxEntrySize = maxEntrySize;
+            m_lineBuffer.resize(maxEntrySize * MAX_BATCH_SIZE);
+            m_batch.reserve(MAX_BATCH_SIZE);
+            m_queue = LogQueueWorker<Entry>::Create(
+                queueSize,
+                overflowPolicy,
+                [maxEntrySize](Entry& entry) { entry.buffer.resize(maxEntrySize); },
+                [this](LogQueueWorker<Entry>& queue) { return Drain(queue); }
+            );
+            return m_queue != nullptr;
+        }
+
+        //False if the overflow policy dropped the entry
+        template<typename TFill>
+        bool PushEntry(TFill&& fFill) {
+            return m_queue->Push(fFill, [this](Entry& entry) { ReleaseSpilled(entry.spilled); });
+        }
+
+        //Copies up to size bytes of the parts taken as one, starting at offset
+        static size_t CopyParts(std::span<const IoBuffer> parts, size_t offset, char* dst, size_t size) noexcept {
+            size_t numCopied = 0;
+            for (const IoBuffer& part : parts) {
+                if (numCopied == size) {
+                    break;
+                }
+
+                if (offset >= part.size) {
+                    offset -= part.size;
+                    continue;
+                }
+
+                size_t partSize = std::min(part.size - offset, size - numCopied);
+                memcpy(dst + numCopied, static_cast<const char*>(part.data) + offset, partSize);
+                numCopied += partSize;
+                offset = 0;
+            }
+            return numCopied;
+        }
+
+        //Null unless every segment needed for the size bytes at offset could be acquired
+        LogSegment* Spill(std::span<const IoBuffer> parts, size_t offset, size_t size) noexcept {
+            LogSegment* head = nullptr;
+            LogSegment** tail = &head;
+            while (size > 0) {
+                LogSegment* segment = m_spillPool ? m_spillPool->TryAcquire() : nullptr;
+                if (!segment) {
+                    ReleaseSpilled(head);
+                    return nullptr;
+                }
+
+                segment->size = CopyParts(parts, offset, segment->data, std::min(size, segment->capacity - 1));
+                segment->data[segment->size] = '\0';
+                offset += segment->size;
+                size -= segment->size;
+                *tail = segment;
+                tail = &segment->next;
+            }
+            return head;
+        }
+
+        void ReleaseSpilled(LogSegment*& spilled) noexcept {
+            if (spilled) {
+                m_spillPool->Release(spilled);
+                spilled = nullptr;
+            }
+        }
+
+        size_t Drain(LogQueueWorker<Entry>& queue) {
+            size_t batchSize = 0;
+            LogSegment* spilled = nullptr;
+            auto fConsume = [this, &batchSize, &spilled](Entry& entry) {
+                memcpy(m_lineBuffer.data() + batchSize, entry.buffer.data(), entry.size);
+                m_batch.push_back({ m_lineBuffer.data() + batchSize, entry.size });
+                batchSize += entry.size;
+                spilled = entry.spilled;
+                entry.spilled = nullptr;
+            };
+
+            m_batch.clear();
+            //a spilled entry ends the batch, it goes to the sink on its own
+            while (m_batch.size() < MAX_BATCH_SIZE && !spilled && queue.TryPop(fConsume)) {}
+
+            size_t numPopped = m_batch.size();
+            if (numPopped > 0) {
+                std::lock_guard<std::mutex> lock(m_sinkLock);
+                if (spilled) {
+                    m_scatterParts.clear();
+                    m_scatterParts.push_back(m_batch.back());
+                    m_batch.pop_back();
+                    for (const LogSegment* segment = spilled; segment; segment = segment->next) {
+                        m_scatterParts.push_back({ segment->data, segment->size });
+                    }
+                }
+
+                if (!m_batch.empty()) {
+                    m_sink->WriteBatch(m_batch);
+                }
+
+                if (spilled) {
+                    m_sink->WriteScattered(m_scatterParts);
+                    ReleaseSpilled(spilled);
+                }
+            }
+
+            queue.MarkProcessed(numPopped);
+            return numPopped;
+        }
+
+        std::shared_ptr<ILoggerSink> m_sink;
+        std::mutex m_sinkLock; // Flush may run on another thread than the worker
+        size_t m_maxEntrySize{ 0 };
+        std::vector<char> m_lineBuffer;
+        std::vector<IoBuffer> m_batch;
+        std::unique_ptr<LogSegmentPool> m_spillPool;
+        std::vector<IoBuffer> m_scatterParts;
+        std::unique_ptr<LogQueueWorker<Entry>> m_queue;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,258 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "../platform/IoBuffer.h"
+#include "../platform/Socket.h"
+#include "ILoggerSink.h"
+#include "LogShippingFormat.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace AGT {
+    struct LoggerSocketConfig {
+        LogShippingEndpoint endpoint;
+        //Framed entries wait here until the collector takes them. When it is full, new entries are dropped.
+        size_t spillBufferSize{ 1 << 20 };
+        std::chrono::milliseconds reconnectInterval{ 500 };
+        //Frames are packed into datagrams of up to this size over UDP, larger entries are dropped
+        size_t maxDatagramSize{ 16 * 1024 };
+    };
+
+    //Streams entries to a local collector, see LogShippingFormat and LogCollector. Entries are framed into a bounded
+    //spill buffer and sent with non-blocking calls, so a slow or missing collector never blocks the logging threads.
+    //While it is down, reconnects are attempted at most once per reconnectInterval, on the next write or Flush.
+    //Over UDP a collector that went away is only noticed on the send after the first lost datagram.
+    class LoggerSocketSink : public ILoggerSink {
+    public:
+        static std::unique_ptr<LoggerSocketSink> Create(const LoggerSocketConfig& config) {
+            auto sink = std::unique_ptr<LoggerSocketSink>(new LoggerSocketSink());
+            if (sink && sink->Init(config)) {
+                return sink;
+            }
+
+            return nullptr;
+        }
+
+        ~LoggerSocketSink() noexcept {
+            Send();
+        }
+
+        void Write(const char* msg, size_t size) override {
+            IoBuffer entry{ msg, size };
+            Enqueue({ &entry, 1 });
+            Send();
+        }
+
+        void WriteBatch(std::span<const IoBuffer> entries) override {
+            for (const IoBuffer& entry : entries) {
+                Enqueue({ &entry, 1 });
+            }
+            Send();
+        }
+
+        void WriteScattered(std::span<const IoBuffer> parts) override {
+            Enqueue(parts);
+            Send();
+        }
+
+        //Sends what the socket takes without waiting, the rest stays in the spill buffer
+        void Flush() override {
+            Send();
+        }
+
+        bool IsConnected() const noexcept { return m_socket != nullptr; }
+
+        //Bytes waiting in the spill buffer, frame headers included
+        size_t GetPendingSize() const noexcept { return m_end - m_frameBegin; }
+
+        //Entries that didn't fit in the spill buffer or a datagram
+        uint64_t GetDroppedCount() const noexcept { return m_droppedCount; }
+
+    private:
+        LoggerSocketSink(const LoggerSocketSink&) = delete;
+        LoggerSocketSink& operator=(const LoggerSocketSink&) = delete;
+
+        LoggerSocketSink() noexcept = default;
+
+        bool Init(const LoggerSocketConfig& config) {
+            m_type = config.endpoint.type;
+            m_address = config.endpoint.GetAddress();
+            m_reconnectInterval = config.reconnectInterval;
+            m_maxDatagramSize = std::min(config.maxDatagramSize, LogShippingFormat::MAX_DATAGRAM_SIZE);
+            if (!m_address.IsValid() || config.spillBufferSize <= LogShippingFormat::FRAME_HEADER_SIZE ||
+                m_maxDatagramSize <= LogShippingFormat::FRAME_HEADER_SIZE) {
+                return false;
+            }
+
+            m_buffer.resize(config.spillBufferSize);
+            Connect();
+            return true;
+        }
+
+        void Enqueue(std::span<const IoBuffer> parts) noexcept {
+            size_t size = 0;
+            for (const IoBuffer& part : parts) {
+                size += part.size;
+            }
+
+            size_t frameSize = LogShippingFormat::FRAME_HEADER_SIZE + size;
+            bool fitsDatagram = m_type != SocketType::Udp || frameSize <= m_maxDatagramSize;
+            if (!fitsDatagram || size > LogShippingFormat::MAX_FRAME_SIZE || frameSize > m_buffer.size() - (m_end - m_frameBegin)) {
+                ++m_droppedCount;
+                return;
+            }
+
+            if (frameSize > m_buffer.size() - m_end) {
+                Compact();
+            }
+
+            LogShippingFormat::WriteFrameHeader(m_buffer.data() + m_end, static_cast<uint32_t>(size));
+            m_end += LogShippingFormat::FRAME_HEADER_SIZE;
+            for (const IoBuffer& part : parts) {
+                memcpy(m_buffer.data() + m_end, part.data, part.size);
+                m_end += part.size;
+            }
+        }
+
+        //Moves the unsent frames to the front of the buffer
+        void Compact() noexcept {
+            size_t size = m_end - m_frameBegin;
+            memmove(m_buffer.data(), m_buffer.data() + m_frameBegin, size);
+            m_sent -= m_frameBegin;
+            m_frameBegin = 0;
+            m_end = size;
+        }
+
+        void Send() noexcept {
+            if (m_frameBegin == m_end || (!m_socket && !Connect())) {
+                return;
+            }
+
+            if (m_type == SocketType::Udp) {
+                SendDatagrams();
+            } else {
+                SendStream();
+            }
+
+            if (m_frameBegin == m_end) {
+                m_frameBegin = m_sent = m_end = 0;
+            }
+        }
+
+        //A stream may take part of a frame, m_sent runs ahead of m_frameBegin until the frame is complete
+        void SendStream() noexcept {
+            while (m_sent < m_end) {
+                size_t numSent = 0;
+                SocketResult result = m_socket->Send(m_buffer.data() + m_sent, m_end - m_sent, numSent);
+                if (result == SocketResult::WouldBlock) {
+                    break;
+                }
+                if (result != SocketResult::Ok) {
+                    Disconnect();
+                    return;
+                }
+
+                m_sent += numSent;
+            }
+
+            while (m_end - m_frameBegin >= LogShippingFormat::FRAME_HEADER_SIZE) {
+                size_t frameEnd = m_frameBegin + LogShippingFormat::FRAME_HEADER_SIZE + LogShippingFormat::ReadFrameHeader(m_buffer.data() + m_frameBegin);
+                if (frameEnd > m_sent) {
+                    break;
+                }
+                m_frameBegin = frameEnd;
+            }
+        }
+
+        //Packs as many whole frames as fit into each datagram
+        void SendDatagrams() noexcept {
+            while (m_frameBegin < m_end) {
+                size_t datagramEnd = m_frameBegin;
+                while (datagramEnd < m_end) {
+                    size_t frameEnd = datagramEnd + LogShippingFormat::FRAME_HEADER_SIZE + LogShippingFormat::ReadFrameHeader(m_buffer.data() + datagramEnd);
+                    if (frameEnd - m_frameBegin > m_maxDatagramSize) {
+                        break;
+                    }
+                    datagramEnd = frameEnd;
+                }
+
+                size_t numSent = 0;
+                SocketResult result = m_socket->Send(m_buffer.data() + m_frameBegin, datagramEnd - m_frameBegin, numSent);
+                if (result == SocketResult::WouldBlock) {
+                    return;
+                }
+                if (result != SocketResult::Ok) {
+                    Disconnect();
+                    return;
+                }
+
+                m_frameBegin = m_sent = datagramEnd;
+            }
+        }
+
+        bool Connect() noexcept {
+            auto now = std::chrono::steady_clock::now();
+            if (now < m_nextConnectTime) {
+                return false;
+            }
+            m_nextConnectTime = now + m_reconnectInterval;
+
+            std::unique_ptr<Socket> socket = Socket::Create(m_type);
+            if (!socket || !socket->Connect(m_address)) {
+                return false;
+            }
+
+            m_socket = std::move(socket);
+            return true;
+        }
+
+        //A partly sent frame is sent again from its start on the next connection
+        void Disconnect() noexcept {
+            m_socket.reset();
+            m_sent = m_frameBegin;
+            m_nextConnectTime = std::chrono::steady_clock::now() + m_reconnectInterval;
+        }
+
+        SocketType m_type{ SocketType::UnixStream };
+        SocketAddress m_address;
+        std::unique_ptr<Socket> m_socket;
+        std::chrono::milliseconds m_reconnectInterval{ 0 };
+        std::chrono::steady_clock::time_point m_nextConnectTime{};
+        size_t m_maxDatagramSize{ 0 };
+
+        std::vector<char> m_buffer;
+        size_t m_frameBegin{ 0 }; // first frame not completely sent
+        size_t m_sent{ 0 };
+        size_t m_end{ 0 };
+        uint64_t m_droppedCount{ 0 };
+    };
+}
\ No newline at end of file
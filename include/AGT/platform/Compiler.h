@@ -36,4 +36,21 @@ SOFTWARE.
 #elif defined(_MSC_VER)
 #define AGT_COMPILER_MSVC
 
+#endif
+
+//Lets the compiler check printf style format strings against the arguments.
+//GCC/Clang check with -Wformat, MSVC checks the annotated parameter under /analyze.
+#if defined(AGT_COMPILER_GCC) || defined(AGT_COMPILER_CLANG) || defined(AGT_COMPILER_INTEL)
+#define AGT_PRINTF_FORMAT(formatIndex, firstArgIndex) __attribute__((format(printf, formatIndex, firstArgIndex)))
+#define AGT_PRINTF_FORMAT_STRING
+
+#elif defined(AGT_COMPILER_MSVC)
+#include <sal.h>
+#define AGT_PRINTF_FORMAT(formatIndex, firstArgIndex)
+#define AGT_PRINTF_FORMAT_STRING _Printf_format_string_
+
+#else
+#define AGT_PRINTF_FORMAT(formatIndex, firstArgIndex)
+#define AGT_PRINTF_FORMAT_STRING
+
 #endif
\ No newline at end of file
@@ -0,0 +1,184 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "IoBuffer.h"
+#include "Platform.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <span>
+
+#ifdef AGT_PLAT_WINDOWS
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace AGT {
+    //Unbuffered file on top of the native handle. Writes of several buffers are gathered into one writev where available.
+    class File {
+    public:
+        ~File() noexcept {
+            if (!m_owned) {
+                return;
+            }
+
+#ifdef AGT_PLAT_WINDOWS
+            CloseHandle(m_handle);
+#else
+            close(m_handle);
+#endif
+        }
+
+        //Creates or truncates the file
+        static std::unique_ptr<File> Create(const std::filesystem::path& path) {
+            auto file = std::unique_ptr<File>(new File());
+            if (file && file->Init(path)) {
+                return file;
+            }
+
+            return nullptr;
+        }
+
+        static File& GetStandardOutput() noexcept {
+#ifdef AGT_PLAT_WINDOWS
+            static File s_stdout(GetStdHandle(STD_OUTPUT_HANDLE));
+#else
+            static File s_stdout(STDOUT_FILENO);
+#endif
+            return s_stdout;
+        }
+
+        bool Write(const void* data, size_t size) noexcept {
+            const char* pos = static_cast<const char*>(data);
+            while (size > 0) {
+#ifdef AGT_PLAT_WINDOWS
+                DWORD numWritten = 0;
+                DWORD numToWrite = static_cast<DWORD>(std::min<size_t>(size, MAXDWORD));
+                if (!WriteFile(m_handle, pos, numToWrite, &numWritten, nullptr)) {
+                    return false;
+                }
+#else
+                ssize_t numWritten = write(m_handle, pos, size);
+                if (numWritten < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    return false;
+                }
+#endif
+                pos += numWritten;
+                size -= numWritten;
+            }
+
+            return true;
+        }
+
+        bool Write(std::span<const IoBuffer> buffers) noexcept {
+#ifdef AGT_PLAT_WINDOWS
+            for (const IoBuffer& buffer : buffers) {
+                if (!Write(buffer.data, buffer.size)) {
+                    return false;
+                }
+            }
+            return true;
+#else
+            static_assert(sizeof(IoBuffer) == sizeof(iovec)
+                && offsetof(IoBuffer, data) == offsetof(iovec, iov_base)
+                && offsetof(IoBuffer, size) == offsetof(iovec, iov_len), "IoBuffer must match iovec");
+
+            const iovec* iov = reinterpret_cast<const iovec*>(buffers.data());
+            size_t numLeft = buffers.size();
+            while (numLeft > 0) {
+                size_t numBuffers = std::min(numLeft, MAX_BUFFERS_PER_CALL);
+                ssize_t numWritten = writev(m_handle, iov, static_cast<int>(numBuffers));
+                if (numWritten < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    return false;
+                }
+
+                size_t numBytes = static_cast<size_t>(numWritten);
+                while (numBuffers > 0 && numBytes >= iov->iov_len) {
+                    numBytes -= iov->iov_len;
+                    ++iov;
+                    --numBuffers;
+                    --numLeft;
+                }
+
+                //short write, finish the partially written buffer before gathering again
+                if (numBytes > 0) {
+                    if (!Write(static_cast<const char*>(iov->iov_base) + numBytes, iov->iov_len - numBytes)) {
+                        return false;
+                    }
+                    ++iov;
+                    --numLeft;
+                }
+            }
+            return true;
+#endif
+        }
+
+    private:
+        File(const File&) = delete;
+        File& operator=(const File&) = delete;
+
+        static constexpr size_t MAX_BUFFERS_PER_CALL = 1024; // IOV_MAX on Linux and macOS
+
+#ifdef AGT_PLAT_WINDOWS
+        using NativeHandle = HANDLE;
+#else
+        using NativeHandle = int;
+#endif
+
+        File() noexcept = default;
+        explicit File(NativeHandle handle) noexcept : m_handle(handle), m_owned(false) {}
+
+        bool Init(const std::filesystem::path& path) {
+#ifdef AGT_PLAT_WINDOWS
+            m_handle = CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+            m_owned = m_handle != INVALID_HANDLE_VALUE;
+#else
+            m_handle = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            m_owned = m_handle >= 0;
+#endif
+            return m_owned;
+        }
+
+        NativeHandle m_handle{};
+        bool m_owned{ false };
+    };
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "Platform.h"
+
+#include <atomic>
+#include <cstdint>
+
+#ifdef AGT_PLAT_WINDOWS
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
+#pragma comment(lib, "Synchronization.lib")
+#elif defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace AGT {
+    //Parks threads on a 32 bit word: a futex on Linux, WaitOnAddress on Windows and std::atomic::wait elsewhere.
+    //Waits can return spuriously, callers re-check the word in a loop.
+    class Futex {
+    public:
+        static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
+
+        //Sleeps while the word holds expected
+        static void Wait(std::atomic<uint32_t>& word, uint32_t expected) noexcept {
+#ifdef AGT_PLAT_WINDOWS
+            WaitOnAddress(&word, &expected, sizeof(expected), INFINITE);
+#elif defined(__linux__)
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+#else
+            word.wait(expected, std::memory_order_relaxed);
+#endif
+        }
+
+        static void WakeOne(std::atomic<uint32_t>& word) noexcept {
+#ifdef AGT_PLAT_WINDOWS
+            WakeByAddressSingle(&word);
+#elif defined(__linux__)
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#else
+            word.notify_one();
+#endif
+        }
+
+        static void WakeAll(std::atomic<uint32_t>& word) noexcept {
+#ifdef AGT_PLAT_WINDOWS
+            WakeByAddressAll(&word);
+#elif defined(__linux__)
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+#else
+            word.notify_all();
+#endif
+        }
+    };
+}
\ No newline at end of file
@@ -0,0 +1,191 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "Platform.h"
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+
+#ifdef AGT_PLAT_WINDOWS
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace AGT {
+    //File created with a fixed size, preallocated on disk and mapped for writing.
+    //Data written to the mapping is in the page cache right away, so it survives a crash of the process.
+    class MappedFile {
+    public:
+        ~MappedFile() noexcept {
+            Close(m_size);
+        }
+
+        //Creates or truncates the file
+        static std::unique_ptr<MappedFile> Create(const std::filesystem::path& path, size_t size) {
+            auto file = std::unique_ptr<MappedFile>(new MappedFile());
+            if (file && file->Init(path, size)) {
+                return file;
+            }
+
+            return nullptr;
+        }
+
+        char* GetData() const noexcept { return m_data; }
+        size_t GetSize() const noexcept { return m_size; }
+
+        //Starts writing dirty pages back to disk, with wait it also blocks until they are written
+        void Flush(bool wait = false) noexcept {
+            if (!m_data) {
+                return;
+            }
+
+#ifdef AGT_PLAT_WINDOWS
+            FlushViewOfFile(m_data, 0);
+            if (wait) {
+                FlushFileBuffers(m_file);
+            }
+#else
+            msync(m_data, m_size, wait ? MS_SYNC : MS_ASYNC);
+#endif
+        }
+
+        //Unmaps the file and cuts it to the size actually used
+        void Close(size_t usedSize) noexcept {
+            if (!m_data) {
+                return;
+            }
+
+#ifdef AGT_PLAT_WINDOWS
+            UnmapViewOfFile(m_data);
+            CloseHandle(m_mapping);
+
+            LARGE_INTEGER fileSize;
+            fileSize.QuadPart = static_cast<LONGLONG>(usedSize);
+            SetFilePointerEx(m_file, fileSize, nullptr, FILE_BEGIN);
+            SetEndOfFile(m_file);
+            CloseHandle(m_file);
+
+            m_mapping = nullptr;
+            m_file = INVALID_HANDLE_VALUE;
+#else
+            munmap(m_data, m_size);
+            //on failure the file keeps its preallocated size with a zero filled tail
+            [[maybe_unused]] int result = ftruncate(m_file, static_cast<off_t>(usedSize));
+            close(m_file);
+
+            m_file = -1;
+#endif
+            m_data = nullptr;
+            m_size = 0;
+        }
+
+    private:
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        MappedFile() noexcept = default;
+
+        bool Init(const std::filesystem::path& path, size_t size) {
+            if (size == 0) {
+                return false;
+            }
+
+#ifdef AGT_PLAT_WINDOWS
+            //sharing delete access lets the file be renamed while it is mapped
+            m_file = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (m_file == INVALID_HANDLE_VALUE) {
+                return false;
+            }
+
+            LARGE_INTEGER fileSize;
+            fileSize.QuadPart = static_cast<LONGLONG>(size);
+            if (!SetFilePointerEx(m_file, fileSize, nullptr, FILE_BEGIN) || !SetEndOfFile(m_file)) {
+                CloseHandle(m_file);
+                return false;
+            }
+
+            m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READWRITE, fileSize.HighPart, fileSize.LowPart, nullptr);
+            if (!m_mapping) {
+                CloseHandle(m_file);
+                return false;
+            }
+
+            m_data = static_cast<char*>(MapViewOfFile(m_mapping, FILE_MAP_WRITE, 0, 0, size));
+            if (!m_data) {
+                CloseHandle(m_mapping);
+                CloseHandle(m_file);
+                return false;
+            }
+#else
+            m_file = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (m_file < 0) {
+                return false;
+            }
+
+            //reserve the blocks now so writes can't fail with SIGBUS on a full disk
+            bool allocated = false;
+#ifdef __linux__
+            allocated = posix_fallocate(m_file, 0, static_cast<off_t>(size)) == 0;
+#endif
+            if (!allocated && ftruncate(m_file, static_cast<off_t>(size)) != 0) {
+                close(m_file);
+                return false;
+            }
+
+            int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+            flags |= MAP_POPULATE; // fault the pages in now instead of on the write path
+#endif
+            void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, m_file, 0);
+            if (data == MAP_FAILED) {
+                close(m_file);
+                return false;
+            }
+
+            m_data = static_cast<char*>(data);
+#endif
+            m_size = size;
+            return true;
+        }
+
+#ifdef AGT_PLAT_WINDOWS
+        HANDLE m_file{ INVALID_HANDLE_VALUE };
+        HANDLE m_mapping{ nullptr };
+#else
+        int m_file{ -1 };
+#endif
+        char* m_data{ nullptr };
+        size_t m_size{ 0 };
+    };
+}
\ No newline at end of file
@@ -45,3 +45,14 @@ SOFTWARE.
 #define AGT_PLAT_ANDROID
 
 #endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(_M_AMD64)
+#define AGT_ARCH_X64
+
+#elif defined(__i386__) || defined(_M_IX86)
+#define AGT_ARCH_X86
+
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define AGT_ARCH_ARM64
+
+#endif
\ No newline at end of file
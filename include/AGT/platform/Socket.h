@@ -0,0 +1,329 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "Platform.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <string_view>
+
+#ifdef AGT_PLAT_WINDOWS
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#define WIN32_LEAN_AND_MEAN
+#include <WinSock2.h>
+#include <WS2tcpip.h>
+#include <afunix.h>
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace AGT {
+    enum class SocketType {
+        UnixStream, // AF_UNIX, SOCK_STREAM
+        Udp         // AF_INET, SOCK_DGRAM
+    };
+
+    enum class SocketResult {
+        Ok,
+        WouldBlock,
+        Closed, // the peer closed a stream
+        Failed
+    };
+
+    struct SocketAddress {
+        sockaddr_storage storage{};
+        int size{ 0 }; // zero if invalid
+
+        //Invalid if the path doesn't fit in sockaddr_un
+        static SocketAddress FromUnixPath(std::string_view path) noexcept {
+            SocketAddress address;
+            sockaddr_un* unixAddress = reinterpret_cast<sockaddr_un*>(&address.storage);
+            if (path.empty() || path.size() >= sizeof(unixAddress->sun_path)) {
+                return address;
+            }
+
+            unixAddress->sun_family = AF_UNIX;
+            memcpy(unixAddress->sun_path, path.data(), path.size());
+            address.size = static_cast<int>(offsetof(sockaddr_un, sun_path) + path.size() + 1);
+            return address;
+        }
+
+        static SocketAddress FromLoopbackPort(uint16_t port) noexcept {
+            SocketAddress address;
+            sockaddr_in* inetAddress = reinterpret_cast<sockaddr_in*>(&address.storage);
+            inetAddress->sin_family = AF_INET;
+            inetAddress->sin_port = htons(port);
+            inetAddress->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            address.size = static_cast<int>(sizeof(sockaddr_in));
+            return address;
+        }
+
+        bool IsValid() const noexcept { return size > 0; }
+    };
+
+    //Non-blocking socket, closed on destruction. Sends never raise SIGPIPE.
+    class Socket {
+    public:
+        static constexpr size_t MAX_WAIT_SOCKETS = 64;
+
+        ~Socket() noexcept {
+#ifdef AGT_PLAT_WINDOWS
+            closesocket(m_handle);
+#else
+            close(m_handle);
+#endif
+        }
+
+        static std::unique_ptr<Socket> Create(SocketType type) {
+            if (!InitNetworking()) {
+                return nullptr;
+            }
+
+            int family = type == SocketType::UnixStream ? AF_UNIX : AF_INET;
+            int socketType = type == SocketType::UnixStream ? SOCK_STREAM : SOCK_DGRAM;
+            NativeHandle handle = socket(family, socketType, 0);
+            if (handle == INVALID_NATIVE_HANDLE) {
+                return nullptr;
+            }
+
+            auto result = std::unique_ptr<Socket>(new Socket(handle));
+            if (!result->Init()) {
+                return nullptr;
+            }
+            return result;
+        }
+
+        //Completes at once for AF_UNIX and UDP. A listener with a full backlog counts as a failure, the caller retries later.
+        bool Connect(const SocketAddress& address) noexcept {
+            return address.IsValid() && connect(m_handle, reinterpret_cast<const sockaddr*>(&address.storage), address.size) == 0;
+        }
+
+        bool Bind(const SocketAddress& address) noexcept {
+            return address.IsValid() && bind(m_handle, reinterpret_cast<const sockaddr*>(&address.storage), address.size) == 0;
+        }
+
+        bool Listen(int backlog) noexcept {
+            return listen(m_handle, backlog) == 0;
+        }
+
+        //Port of a socket bound to an AF_INET address, e.g. the one picked for port 0
+        uint16_t GetLocalPort() const noexcept {
+            sockaddr_in address{};
+#ifdef AGT_PLAT_WINDOWS
+            int size = sizeof(address);
+#else
+            socklen_t size = sizeof(address);
+#endif
+            if (getsockname(m_handle, reinterpret_cast<sockaddr*>(&address), &size) != 0 || address.sin_family != AF_INET) {
+                return 0;
+            }
+            return ntohs(address.sin_port);
+        }
+
+        //Null if no connection is pending
+        std::unique_ptr<Socket> Accept() {
+            NativeHandle handle = accept(m_handle, nullptr, nullptr);
+            if (handle == INVALID_NATIVE_HANDLE) {
+                return nullptr;
+            }
+
+            auto result = std::unique_ptr<Socket>(new Socket(handle));
+            if (!result->Init()) {
+                return nullptr;
+            }
+            return result;
+        }
+
+        //A datagram socket sends data as one datagram. Streams may send part of it.
+        SocketResult Send(const void* data, size_t size, size_t& numSent) noexcept {
+            numSent = 0;
+            for (;;) {
+#ifdef AGT_PLAT_WINDOWS
+                int result = send(m_handle, static_cast<const char*>(data), static_cast<int>(std::min<size_t>(size, INT_MAX)), 0);
+#else
+                ssize_t result = send(m_handle, data, size, SEND_FLAGS);
+#endif
+                if (result >= 0) {
+                    numSent = static_cast<size_t>(result);
+                    return SocketResult::Ok;
+                }
+
+                if (!IsInterrupted()) {
+                    return GetLastError();
+                }
+            }
+        }
+
+        //A datagram socket receives one datagram, cut to size
+        SocketResult Receive(void* data, size_t size, size_t& numReceived) noexcept {
+            numReceived = 0;
+            for (;;) {
+#ifdef AGT_PLAT_WINDOWS
+                int result = recv(m_handle, static_cast<char*>(data), static_cast<int>(std::min<size_t>(size, INT_MAX)), 0);
+#else
+                ssize_t result = recv(m_handle, data, size, 0);
+#endif
+                if (result > 0 || (result == 0 && m_type == SOCK_DGRAM)) {
+                    numReceived = static_cast<size_t>(result);
+                    return SocketResult::Ok;
+                }
+                if (result == 0) {
+                    return SocketResult::Closed;
+                }
+
+                if (!IsInterrupted()) {
+                    return GetLastError();
+                }
+            }
+        }
+
+        //Waits until one of the first MAX_WAIT_SOCKETS sockets has data or a pending connection.
+        //Sets readable[i] for each socket that has. False on timeout or error.
+        static bool WaitReadable(std::span<Socket* const> sockets, std::span<bool> readable, std::chrono::milliseconds timeout) {
+            size_t numSockets = std::min(sockets.size(), MAX_WAIT_SOCKETS);
+#ifdef AGT_PLAT_WINDOWS
+            WSAPOLLFD fds[MAX_WAIT_SOCKETS];
+#else
+            pollfd fds[MAX_WAIT_SOCKETS];
+#endif
+            for (size_t i = 0; i < numSockets; ++i) {
+                fds[i].fd = sockets[i]->m_handle;
+                fds[i].events = POLLIN;
+                fds[i].revents = 0;
+            }
+
+#ifdef AGT_PLAT_WINDOWS
+            int result = WSAPoll(fds, static_cast<ULONG>(numSockets), static_cast<INT>(timeout.count()));
+#else
+            int result = poll(fds, static_cast<nfds_t>(numSockets), static_cast<int>(timeout.count()));
+#endif
+            for (size_t i = 0; i < readable.size(); ++i) {
+                readable[i] = result > 0 && i < numSockets && (fds[i].revents & (POLLIN | POLLHUP | POLLERR));
+            }
+            return result > 0;
+        }
+
+    private:
+        Socket(const Socket&) = delete;
+        Socket& operator=(const Socket&) = delete;
+
+#ifdef AGT_PLAT_WINDOWS
+        using NativeHandle = SOCKET;
+        static constexpr NativeHandle INVALID_NATIVE_HANDLE = INVALID_SOCKET;
+#else
+        using NativeHandle = int;
+        static constexpr NativeHandle INVALID_NATIVE_HANDLE = -1;
+#ifdef MSG_NOSIGNAL
+        static constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+        static constexpr int SEND_FLAGS = 0; // SO_NOSIGPIPE is set instead
+#endif
+#endif
+
+        explicit Socket(NativeHandle handle) noexcept : m_handle(handle) {}
+
+        static bool InitNetworking() noexcept {
+#ifdef AGT_PLAT_WINDOWS
+            static const bool s_initialized = []() {
+                WSADATA data;
+                return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+            }();
+            return s_initialized;
+#else
+            return true;
+#endif
+        }
+
+        bool Init() noexcept {
+#ifdef AGT_PLAT_WINDOWS
+            u_long nonBlocking = 1;
+            int type = 0;
+            int typeSize = sizeof(type);
+            if (ioctlsocket(m_handle, FIONBIO, &nonBlocking) != 0 ||
+                getsockopt(m_handle, SOL_SOCKET, SO_TYPE, reinterpret_cast<char*>(&type), &typeSize) != 0) {
+                return false;
+            }
+#else
+            int flags = fcntl(m_handle, F_GETFL, 0);
+            int type = 0;
+            socklen_t typeSize = sizeof(type);
+            if (flags < 0 || fcntl(m_handle, F_SETFL, flags | O_NONBLOCK) != 0 ||
+                fcntl(m_handle, F_SETFD, FD_CLOEXEC) != 0 ||
+                getsockopt(m_handle, SOL_SOCKET, SO_TYPE, &type, &typeSize) != 0) {
+                return false;
+            }
+#if !defined(MSG_NOSIGNAL) && defined(SO_NOSIGPIPE)
+            int noSigPipe = 1;
+            setsockopt(m_handle, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+#endif
+            m_type = type;
+            return true;
+        }
+
+        static SocketResult GetLastError() noexcept {
+#ifdef AGT_PLAT_WINDOWS
+            int error = WSAGetLastError();
+            if (error == WSAEWOULDBLOCK) {
+                return SocketResult::WouldBlock;
+            }
+            return error == WSAECONNRESET || error == WSAECONNABORTED ? SocketResult::Closed : SocketResult::Failed;
+#else
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) {
+                return SocketResult::WouldBlock;
+            }
+            return errno == EPIPE || errno == ECONNRESET ? SocketResult::Closed : SocketResult::Failed;
+#endif
+        }
+
+        static bool IsInterrupted() noexcept {
+#ifdef AGT_PLAT_WINDOWS
+            return false;
+#else
+            return errno == EINTR;
+#endif
+        }
+
+        NativeHandle m_handle;
+        int m_type{ 0 };
+    };
+}
\ No newline at end of file
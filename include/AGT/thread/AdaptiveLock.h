@@ -0,0 +1,90 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "../platform/Futex.h"
+#include "Backoff.h"
+
+#include <atomic>
+#include <cstdint>
+
+namespace AGT {
+    //Drop-in replacement for SpinLock when there can be more threads than cores. Waiters spin with bounded
+    //exponential backoff, then park in the kernel, so a descheduled owner doesn't keep them burning a core.
+    //unlock only makes a syscall when a thread is parked. The lock fills its own cache line.
+    //See "Futexes Are Tricky" by Ulrich Drepper, mutex take 2.
+    class alignas(64) AdaptiveLock {
+    public:
+        //Pauses of the last backoff step before parking, about 255 pauses in total
+        static constexpr uint32_t MAX_SPIN_PAUSES = 128;
+
+        AdaptiveLock() noexcept = default;
+
+        void lock() noexcept {
+            uint32_t state = UNLOCKED;
+            if (m_state.compare_exchange_strong(state, LOCKED, std::memory_order_acquire, std::memory_order_relaxed)) {
+                return;
+            }
+
+            Backoff backoff(MAX_SPIN_PAUSES);
+            while (backoff.Spin()) {
+                state = m_state.load(std::memory_order_relaxed);
+                if (state == UNLOCKED
+                    && m_state.compare_exchange_weak(state, LOCKED, std::memory_order_acquire, std::memory_order_relaxed)) {
+                    return;
+                }
+            }
+
+            //from here on the lock is taken as contended, so the unlock that follows wakes the next waiter
+            while (m_state.exchange(CONTENDED, std::memory_order_acquire) != UNLOCKED) {
+                Futex::Wait(m_state, CONTENDED);
+            }
+        }
+
+        bool try_lock() noexcept {
+            uint32_t state = UNLOCKED;
+            return m_state.load(std::memory_order_relaxed) == UNLOCKED
+                && m_state.compare_exchange_strong(state, LOCKED, std::memory_order_acquire, std::memory_order_relaxed);
+        }
+
+        void unlock() noexcept {
+            if (m_state.exchange(UNLOCKED, std::memory_order_release) == CONTENDED) {
+                Futex::WakeOne(m_state);
+            }
+        }
+
+    private:
+        AdaptiveLock(const AdaptiveLock&) noexcept = delete;
+        AdaptiveLock& operator=(const AdaptiveLock&) noexcept = delete;
+
+        static constexpr uint32_t UNLOCKED = 0;
+        static constexpr uint32_t LOCKED = 1;
+        static constexpr uint32_t CONTENDED = 2; // locked, threads may be parked
+
+        std::atomic<uint32_t> m_state{ UNLOCKED };
+    };
+
+    static_assert(sizeof(AdaptiveLock) == 64);
+}
\ No newline at end of file
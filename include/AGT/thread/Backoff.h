@@ -0,0 +1,76 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "../platform/Platform.h"
+
+#include <cstdint>
+
+#if defined(AGT_ARCH_X64) || defined(AGT_ARCH_X86)
+#include <immintrin.h>
+#elif defined(AGT_ARCH_ARM64) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace AGT {
+    //Bounded exponential backoff for spin-wait loops. Each Spin pauses twice as long as the previous one,
+    //until the limit is reached and the caller should stop spinning, e.g. to park the thread.
+    class Backoff {
+    public:
+        explicit Backoff(uint32_t maxPauses = 128) noexcept
+            : m_maxPauses(maxPauses) {}
+
+        //Hint to the CPU that this is a spin-wait loop, so the sibling hyperthread gets the core
+        //https://stackoverflow.com/questions/5833527/how-do-you-use-the-pause-assembly-instruction-in-64-bit-c-code
+        static void Pause() noexcept {
+#if defined(AGT_ARCH_X64) || defined(AGT_ARCH_X86)
+            _mm_pause();
+#elif defined(AGT_ARCH_ARM64) && defined(_MSC_VER)
+            __yield();
+#elif defined(AGT_ARCH_ARM64)
+            asm volatile("yield");
+#endif
+        }
+
+        //Returns false without pausing once the limit was reached
+        bool Spin() noexcept {
+            if (m_numPauses > m_maxPauses) {
+                return false;
+            }
+
+            for (uint32_t i = 0; i < m_numPauses; ++i) {
+                Pause();
+            }
+            m_numPauses <<= 1;
+            return true;
+        }
+
+        void Reset() noexcept { m_numPauses = 1; }
+
+    private:
+        uint32_t m_numPauses{ 1 };
+        uint32_t m_maxPauses;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,135 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace AGT {
+    //Bounded lock-free queue based on Dmitry Vyukov's MPMC ring buffer.
+    //See https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+    //Elements are constructed once up front and filled/consumed in place, so pushing and popping never allocate.
+    template<typename T>
+    class BoundedQueue {
+    public:
+        static constexpr size_t CACHE_LINE_SIZE = 64;
+
+        template<typename TInit>
+        BoundedQueue(size_t capacity, TInit&& fInit) {
+            size_t size = 2;
+            while (size < capacity) {
+                size <<= 1;
+            }
+
+            m_mask = size - 1;
+            m_cells.reset(new Cell[size]);
+            for (size_t i = 0; i < size; ++i) {
+                m_cells[i].sequence.store(i, std::memory_order_relaxed);
+                fInit(m_cells[i].value);
+            }
+        }
+
+        //Claims a free slot and calls fFill(T&) on it. Returns false if the queue is full.
+        template<typename TFunc>
+        bool TryPush(TFunc&& fFill) {
+            size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+            Cell* cell;
+            for (;;) {
+                cell = &m_cells[pos & m_mask];
+                size_t seq = cell->sequence.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+                if (diff == 0) {
+                    if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = m_enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+
+            fFill(cell->value);
+            cell->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        //Takes the oldest element and calls fConsume(T&) on it. Returns false if the queue is empty.
+        template<typename TFunc>
+        bool TryPop(TFunc&& fConsume) {
+            size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+            Cell* cell;
+            for (;;) {
+                cell = &m_cells[pos & m_mask];
+                size_t seq = cell->sequence.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+                if (diff == 0) {
+                    if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = m_dequeuePos.load(std::memory_order_relaxed);
+                }
+            }
+
+            fConsume(cell->value);
+            cell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+            return true;
+        }
+
+        //Approximate when called concurrently with producers or consumers
+        bool IsEmpty() const noexcept {
+            return m_enqueuePos.load(std::memory_order_acquire) == m_dequeuePos.load(std::memory_order_acquire);
+        }
+
+        //Slots claimed by TryPush so far, including those still being filled
+        size_t GetEnqueuedCount() const noexcept {
+            return m_enqueuePos.load(std::memory_order_acquire);
+        }
+
+        size_t GetCapacity() const noexcept {
+            return m_mask + 1;
+        }
+
+    private:
+        BoundedQueue(const BoundedQueue&) = delete;
+        BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+        struct Cell {
+            std::atomic<size_t> sequence;
+            T value;
+        };
+
+        std::unique_ptr<Cell[]> m_cells;
+        size_t m_mask{ 0 };
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_enqueuePos{ 0 };
+        alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_dequeuePos{ 0 };
+    };
+}
@@ -0,0 +1,347 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "../platform/Futex.h"
+#include "Backoff.h"
+#include "BoundedQueue.h"
+#include "ThreadInfo.h"
+#include "WorkStealingDeque.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace AGT {
+    //Number of jobs started with it that haven't finished yet
+    class JobCounter {
+    public:
+        JobCounter() noexcept = default;
+
+        bool IsDone() const noexcept {
+            return m_numPending.load(std::memory_order_acquire) == 0;
+        }
+
+    private:
+        JobCounter(const JobCounter&) = delete;
+        JobCounter& operator=(const JobCounter&) = delete;
+
+        friend class JobSystem;
+
+        std::atomic<uint32_t> m_numPending{ 0 };
+    };
+
+    //Work-stealing job system with one worker thread per core. Each worker keeps the jobs it starts in its own
+    //Chase-Lev deque and steals from the others when it runs dry. Threads outside the system submit through a
+    //shared queue, jobs started by jobs never touch it.
+    //Dependencies are expressed with JobCounter: Wait runs other jobs until the counter drops to zero, so waiting,
+    //also inside a job, never blocks a worker. Idle workers spin briefly, then sleep until a job is pushed.
+    //Jobs live in a pool allocated up front. Their callables are stored inline, so starting a job doesn't allocate.
+    //When the pool or a deque is full, the job runs right away on the calling thread.
+    class JobSystem {
+    public:
+        static constexpr size_t MAX_JOB_SIZE = 64; // size of a job's callable and its captures
+
+        //numWorkers 0 starts one worker per hardware thread
+        static std::unique_ptr<JobSystem> Create(size_t numWorkers = 0, size_t maxJobs = 4096) {
+            auto jobSystem = std::unique_ptr<JobSystem>(new JobSystem());
+            if (!jobSystem->Init(numWorkers, maxJobs)) {
+                return nullptr;
+            }
+            return jobSystem;
+        }
+
+        //Runs the jobs that are still queued, then stops the workers
+        ~JobSystem() {
+            m_running.store(false, std::memory_order_release);
+            m_wakeEpoch.fetch_add(1, std::memory_order_release);
+            Futex::WakeAll(m_wakeEpoch);
+            for (auto& worker : m_workers) {
+                if (worker->thread.joinable()) {
+                    worker->thread.join();
+                }
+            }
+
+            for (Job* job = FindJob(NO_WORKER); job; job = FindJob(NO_WORKER)) {
+                Execute(*job);
+            }
+        }
+
+        //Starts f() as a job. With a counter, the counter is only done once the job finished.
+        template<typename F>
+        void Run(F&& f, JobCounter* counter = nullptr) noexcept {
+            using TCallable = std::decay_t<F>;
+            static_assert(sizeof(TCallable) <= MAX_JOB_SIZE, "Job captures don't fit, capture by reference or pointer instead");
+            static_assert(alignof(TCallable) <= alignof(std::max_align_t));
+
+            Job* job = nullptr;
+            if (!m_freeJobs->TryPop([&job](Job*& freeJob) { job = freeJob; })) {
+                f();
+                return;
+            }
+
+            new (job->storage) TCallable(std::forward<F>(f));
+            job->fExecute = [](Job& self) {
+                TCallable* callable = std::launder(reinterpret_cast<TCallable*>(self.storage));
+                (*callable)();
+                callable->~TCallable();
+            };
+            job->counter = counter;
+            if (counter) {
+                counter->m_numPending.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            Push(*job);
+        }
+
+        //Runs other jobs until every job started with counter has finished
+        void Wait(const JobCounter& counter) noexcept {
+            size_t workerIndex = GetWorkerIndex();
+            Backoff backoff;
+            while (!counter.IsDone()) {
+                if (Job* job = FindJob(workerIndex)) {
+                    Execute(*job);
+                    backoff.Reset();
+                } else if (!backoff.Spin()) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        //Calls f(i) for every i in [begin, end) across the workers and returns once all calls are done.
+        //The range is split in halves as workers steal it, down to grainSize indices per job. With grainSize 0
+        //a thread gets about GRAIN_SPLITS_PER_THREAD pieces, enough to balance uneven work without
+        //scheduling a job per index.
+        template<typename F>
+        void ParallelFor(size_t begin, size_t end, F&& f, size_t grainSize = 0) noexcept {
+            if (begin >= end) {
+                return;
+            }
+
+            size_t numThreads = m_workers.size() + 1;
+            if (!grainSize) {
+                grainSize = std::max<size_t>((end - begin) / (numThreads * GRAIN_SPLITS_PER_THREAD), 1);
+            }
+
+            JobCounter counter;
+            ParallelForRange(begin, end, grainSize, f, counter);
+            Wait(counter);
+        }
+
+        size_t GetNumWorkers() const noexcept { return m_workers.size(); }
+
+    private:
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        JobSystem() noexcept = default;
+
+        static constexpr size_t NO_WORKER = SIZE_MAX;
+        static constexpr size_t GRAIN_SPLITS_PER_THREAD = 8;
+
+        struct Job {
+            void (*fExecute)(Job& job){ nullptr };
+            JobCounter* counter{ nullptr };
+            alignas(std::max_align_t) unsigned char storage[MAX_JOB_SIZE];
+        };
+
+        struct Worker {
+            explicit Worker(size_t capacity) : jobs(capacity) {}
+
+            WorkStealingDeque<Job*> jobs;
+            std::thread thread;
+        };
+
+        //Which worker of which system the calling thread is
+        struct ThreadWorker {
+            const JobSystem* system{ nullptr };
+            size_t index{ NO_WORKER };
+        };
+
+        static ThreadWorker& GetThreadWorker() noexcept {
+            static thread_local ThreadWorker s_worker;
+            return s_worker;
+        }
+
+        bool Init(size_t numWorkers, size_t maxJobs) {
+            if (!maxJobs) {
+                return false;
+            }
+
+            if (!numWorkers) {
+                numWorkers = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+            }
+
+            m_jobs.reset(new Job[maxJobs]);
+            m_freeJobs = std::make_unique<BoundedQueue<Job*>>(maxJobs, [](Job*& job) { job = nullptr; });
+            m_submitted = std::make_unique<BoundedQueue<Job*>>(maxJobs, [](Job*& job) { job = nullptr; });
+            for (size_t i = 0; i < maxJobs; ++i) {
+                Job* job = &m_jobs[i];
+                m_freeJobs->TryPush([job](Job*& freeJob) { freeJob = job; });
+            }
+
+            for (size_t i = 0; i < numWorkers; ++i) {
+                m_workers.push_back(std::make_unique<Worker>(maxJobs));
+            }
+            for (size_t i = 0; i < numWorkers; ++i) {
+                m_workers[i]->thread = std::thread([this, i]() { WorkerMain(i); });
+            }
+            return true;
+        }
+
+        void WorkerMain(size_t index) noexcept {
+            char name[ThreadInfo::MAX_THREAD_NAME_SIZE];
+            snprintf(name, sizeof(name), "JobWorker%zu", index);
+            ThreadInfo::SetThreadName(name);
+            GetThreadWorker() = ThreadWorker{ this, index };
+
+            Backoff backoff;
+            while (m_running.load(std::memory_order_acquire)) {
+                if (Job* job = FindJob(index)) {
+                    Execute(*job);
+                    backoff.Reset();
+                    continue;
+                }
+
+                if (backoff.Spin()) {
+                    continue;
+                }
+
+                //pairs with the fence in Push, either the pusher sees this sleeper or this worker sees the job
+                uint32_t epoch = m_wakeEpoch.load(std::memory_order_acquire);
+                m_numSleeping.fetch_add(1, std::memory_order_seq_cst);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (!HasJobs() && m_running.load(std::memory_order_acquire)) {
+                    Futex::Wait(m_wakeEpoch, epoch);
+                }
+                m_numSleeping.fetch_sub(1, std::memory_order_relaxed);
+                backoff.Reset();
+            }
+        }
+
+        size_t GetWorkerIndex() const noexcept {
+            const ThreadWorker& worker = GetThreadWorker();
+            return worker.system == this ? worker.index : NO_WORKER;
+        }
+
+        void Push(Job& job) noexcept {
+            Job* jobPtr = &job;
+            size_t workerIndex = GetWorkerIndex();
+            bool pushed = workerIndex != NO_WORKER ?
+                m_workers[workerIndex]->jobs.Push(jobPtr) :
+                m_submitted->TryPush([jobPtr](Job*& submitted) { submitted = jobPtr; });
+            if (!pushed) {
+                Execute(job);
+                return;
+            }
+
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (m_numSleeping.load(std::memory_order_relaxed)) {
+                m_wakeEpoch.fetch_add(1, std::memory_order_release);
+                Futex::WakeOne(m_wakeEpoch);
+            }
+        }
+
+        //The own deque first, then submitted jobs, then the other workers starting at a random one
+        Job* FindJob(size_t workerIndex) noexcept {
+            Job* job = nullptr;
+            if (workerIndex != NO_WORKER && m_workers[workerIndex]->jobs.Pop(job)) {
+                return job;
+            }
+
+            if (m_submitted->TryPop([&job](Job*& submitted) { job = submitted; })) {
+                return job;
+            }
+
+            size_t numWorkers = m_workers.size();
+            size_t first = NextRandom() % numWorkers;
+            for (size_t i = 0; i < numWorkers; ++i) {
+                size_t victim = (first + i) % numWorkers;
+                if (victim != workerIndex && m_workers[victim]->jobs.Steal(job)) {
+                    return job;
+                }
+            }
+            return nullptr;
+        }
+
+        bool HasJobs() const noexcept {
+            if (!m_submitted->IsEmpty()) {
+                return true;
+            }
+            return std::any_of(m_workers.begin(), m_workers.end(), [](const auto& worker) { return !worker->jobs.IsEmpty(); });
+        }
+
+        void Execute(Job& job) noexcept {
+            JobCounter* counter = job.counter;
+            job.fExecute(job);
+
+            Job* jobPtr = &job;
+            m_freeJobs->TryPush([jobPtr](Job*& freeJob) { freeJob = jobPtr; });
+            if (counter) {
+                counter->m_numPending.fetch_sub(1, std::memory_order_release);
+            }
+        }
+
+        template<typename F>
+        void ParallelForRange(size_t begin, size_t end, size_t grainSize, F& f, JobCounter& counter) noexcept {
+            //hand the upper half to a job, whoever steals it splits it further
+            while (end - begin > grainSize) {
+                size_t middle = begin + (end - begin) / 2;
+                Run([this, middle, end, grainSize, &f, &counter]() {
+                    ParallelForRange(middle, end, grainSize, f, counter);
+                }, &counter);
+                end = middle;
+            }
+
+            for (size_t i = begin; i < end; ++i) {
+                f(i);
+            }
+        }
+
+        static uint32_t NextRandom() noexcept {
+            static thread_local uint32_t s_state = static_cast<uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id())) | 1;
+            s_state ^= s_state << 13;
+            s_state ^= s_state >> 17;
+            s_state ^= s_state << 5;
+            return s_state;
+        }
+
+        std::unique_ptr<Job[]> m_jobs;
+        std::unique_ptr<BoundedQueue<Job*>> m_freeJobs;
+        std::unique_ptr<BoundedQueue<Job*>> m_submitted; // jobs started by threads that aren't workers
+        std::vector<std::unique_ptr<Worker>> m_workers;
+        std::atomic<bool> m_running{ true };
+        alignas(64) std::atomic<uint32_t> m_wakeEpoch{ 0 };
+        std::atomic<uint32_t> m_numSleeping{ 0 };
+    };
+}
\ No newline at end of file
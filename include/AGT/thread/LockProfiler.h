@@ -0,0 +1,373 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "../time/TscClock.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace AGT {
+    //Contention counters of one named lock, summed over all threads
+    struct LockProfileStats {
+        //Bucket i counts durations below 2^(i+1) ns, the last one everything longer
+        static constexpr size_t NUM_BUCKETS = 32;
+
+        uint64_t numAcquires{ 0 };
+        uint64_t numContended{ 0 }; // acquires that had to wait
+        uint64_t numSpins{ 0 };
+        uint64_t waitNs{ 0 };
+        uint64_t holdNs{ 0 };
+        uint64_t maxWaitNs{ 0 };
+        uint64_t maxHoldNs{ 0 };
+        std::array<uint64_t, NUM_BUCKETS> waitHistogram{};
+        std::array<uint64_t, NUM_BUCKETS> holdHistogram{};
+
+        static size_t GetBucket(uint64_t durationNs) noexcept {
+            return std::min<size_t>(durationNs ? std::bit_width(durationNs) - 1 : 0, NUM_BUCKETS - 1);
+        }
+
+        //Upper bound of the bucket holding the given fraction of the samples, never above maxNs, the longest sample
+        static uint64_t GetPercentileNs(const std::array<uint64_t, NUM_BUCKETS>& histogram, double percentile, uint64_t maxNs) noexcept {
+            uint64_t total = 0;
+            for (uint64_t count : histogram) {
+                total += count;
+            }
+
+            uint64_t rank = static_cast<uint64_t>(percentile * static_cast<double>(total));
+            uint64_t numSeen = 0;
+            for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+                numSeen += histogram[i];
+                if (numSeen > rank) {
+                    return std::min((uint64_t(2) << i) - 1, maxNs);
+                }
+            }
+            return 0;
+        }
+    };
+
+    //Collects the statistics of profiled locks. Every thread records into its own shard, so the fast path
+    //only does relaxed loads and stores of memory no other thread writes. Reports sum the shards up, together
+    //with the shards of threads that have exited.
+    //Locks are identified by name. Locks sharing a name share their statistics. Names beyond
+    //MAX_PROFILED_LOCKS are counted as "(other)". Names are copied, cut to MAX_NAME_SIZE - 1 characters.
+    class LockProfiler {
+    public:
+        static constexpr uint32_t MAX_PROFILED_LOCKS = 32;
+        static constexpr size_t MAX_NAME_SIZE = 64;
+
+        static uint32_t GetLockId(const char* name) noexcept {
+            std::string_view key = std::string_view(name).substr(0, MAX_NAME_SIZE - 1);
+
+            Registry& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.lock);
+            for (uint32_t i = 0; i < registry.numLocks; ++i) {
+                if (key == registry.names[i].data()) {
+                    return i;
+                }
+            }
+
+            if (registry.numLocks == MAX_PROFILED_LOCKS - 1) {
+                SetName(registry.names[registry.numLocks++], "(other)");
+            }
+            if (registry.numLocks == MAX_PROFILED_LOCKS) {
+                return MAX_PROFILED_LOCKS - 1;
+            }
+
+            SetName(registry.names[registry.numLocks], key);
+            return registry.numLocks++;
+        }
+
+        static void RecordAcquire(uint32_t lockId, uint64_t waitNs, uint64_t numSpins, bool contended) noexcept {
+            Shard::Counters& counters = GetThreadShard().locks[lockId];
+            Add(counters[ACQUIRES], 1);
+            Add(counters[CONTENDED], contended ? 1 : 0);
+            Add(counters[SPINS], numSpins);
+            Add(counters[WAIT_NS], waitNs);
+            Max(counters[MAX_WAIT_NS], waitNs);
+            Add(counters[WAIT_BUCKETS + LockProfileStats::GetBucket(waitNs)], 1);
+        }
+
+        static void RecordHold(uint32_t lockId, uint64_t holdNs) noexcept {
+            Shard::Counters& counters = GetThreadShard().locks[lockId];
+            Add(counters[HOLD_NS], holdNs);
+            Max(counters[MAX_HOLD_NS], holdNs);
+            Add(counters[HOLD_BUCKETS + LockProfileStats::GetBucket(holdNs)], 1);
+        }
+
+        //Calls f(std::string_view name, const LockProfileStats&) for every lock acquired so far
+        template<typename F>
+        static void ForEach(F&& f) {
+            Registry& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.lock);
+            for (uint32_t i = 0; i < registry.numLocks; ++i) {
+                LockProfileStats stats;
+                Accumulate(stats, registry.retired.locks[i]);
+                for (const Shard* shard : registry.shards) {
+                    Accumulate(stats, shard->locks[i]);
+                }
+
+                if (stats.numAcquires) {
+                    f(std::string_view(registry.names[i].data()), stats);
+                }
+            }
+        }
+
+        //One line per lock, the ones with the most time spent waiting first. Percentiles are bucket bounds,
+        //the duration the given fraction of the samples stays under.
+        static std::string GetReport() {
+            std::vector<std::pair<std::string, LockProfileStats>> locks;
+            ForEach([&](std::string_view name, const LockProfileStats& stats) {
+                locks.emplace_back(std::string(name), stats);
+            });
+            std::sort(locks.begin(), locks.end(), [](const auto& a, const auto& b) { return a.second.waitNs > b.second.waitNs; });
+
+            std::string report;
+            char line[256];
+            snprintf(line, sizeof(line), "%-24s %12s %10s %12s %10s %10s %12s %10s %10s %12s\n",
+                "lock", "acquires", "contended", "spins", "wait p50<=", "wait p99<=", "wait max", "hold p50<=", "hold p99<=", "hold max");
+            report += line;
+            for (const auto& [name, stats] : locks) {
+                snprintf(line, sizeof(line), "%-24.24s %12llu %9.2f%% %12llu %10s %10s %12s %10s %10s %12s\n",
+                    name.c_str(),
+                    static_cast<unsigned long long>(stats.numAcquires),
+                    100.0 * static_cast<double>(stats.numContended) / static_cast<double>(stats.numAcquires),
+                    static_cast<unsigned long long>(stats.numSpins),
+                    FormatDuration(LockProfileStats::GetPercentileNs(stats.waitHistogram, 0.5, stats.maxWaitNs)).data(),
+                    FormatDuration(LockProfileStats::GetPercentileNs(stats.waitHistogram, 0.99, stats.maxWaitNs)).data(),
+                    FormatDuration(stats.maxWaitNs).data(),
+                    FormatDuration(LockProfileStats::GetPercentileNs(stats.holdHistogram, 0.5, stats.maxHoldNs)).data(),
+                    FormatDuration(LockProfileStats::GetPercentileNs(stats.holdHistogram, 0.99, stats.maxHoldNs)).data(),
+                    FormatDuration(stats.maxHoldNs).data());
+                report += line;
+            }
+            return report;
+        }
+
+    private:
+        enum Counter : size_t {
+            ACQUIRES,
+            CONTENDED,
+            SPINS,
+            WAIT_NS,
+            HOLD_NS,
+            MAX_WAIT_NS,
+            MAX_HOLD_NS,
+            WAIT_BUCKETS,
+            HOLD_BUCKETS = WAIT_BUCKETS + LockProfileStats::NUM_BUCKETS,
+            NUM_COUNTERS = HOLD_BUCKETS + LockProfileStats::NUM_BUCKETS
+        };
+
+        //Written only by its thread, read by reports
+        struct Shard {
+            using Counters = std::array<std::atomic<uint64_t>, NUM_COUNTERS>;
+            std::array<Counters, MAX_PROFILED_LOCKS> locks{};
+        };
+
+        using Name = std::array<char, MAX_NAME_SIZE>;
+
+        struct Registry {
+            std::mutex lock;
+            std::array<Name, MAX_PROFILED_LOCKS> names{};
+            uint32_t numLocks{ 0 };
+            std::vector<Shard*> shards;
+            Shard retired; // sum of the shards of exited threads
+        };
+
+        //Moves the shard into the retired totals when its thread exits
+        struct ThreadShard {
+            ThreadShard() {
+                Registry& registry = GetRegistry();
+                std::lock_guard<std::mutex> lock(registry.lock);
+                registry.shards.push_back(&shard);
+            }
+
+            ~ThreadShard() {
+                Registry& registry = GetRegistry();
+                std::lock_guard<std::mutex> lock(registry.lock);
+                for (size_t i = 0; i < MAX_PROFILED_LOCKS; ++i) {
+                    for (size_t j = 0; j < NUM_COUNTERS; ++j) {
+                        uint64_t value = shard.locks[i][j].load(std::memory_order_relaxed);
+                        std::atomic<uint64_t>& total = registry.retired.locks[i][j];
+                        if (j == MAX_WAIT_NS || j == MAX_HOLD_NS) {
+                            Max(total, value);
+                        } else {
+                            Add(total, value);
+                        }
+                    }
+                }
+                std::erase(registry.shards, &shard);
+            }
+
+            Shard shard;
+        };
+
+        static Registry& GetRegistry() noexcept {
+            static Registry s_registry;
+            return s_registry;
+        }
+
+        static Shard& GetThreadShard() noexcept {
+            static thread_local ThreadShard s_threadShard;
+            return s_threadShard.shard;
+        }
+
+        static void SetName(Name& name, std::string_view value) noexcept {
+            memcpy(name.data(), value.data(), value.size());
+            name[value.size()] = '\0';
+        }
+
+        //Single writer, so a plain load and store is enough
+        static void Add(std::atomic<uint64_t>& counter, uint64_t value) noexcept {
+            counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+
+        static void Max(std::atomic<uint64_t>& counter, uint64_t value) noexcept {
+            if (value > counter.load(std::memory_order_relaxed)) {
+                counter.store(value, std::memory_order_relaxed);
+            }
+        }
+
+        static void Accumulate(LockProfileStats& stats, const Shard::Counters& counters) noexcept {
+            auto fGet = [&counters](size_t index) { return counters[index].load(std::memory_order_relaxed); };
+            stats.numAcquires += fGet(ACQUIRES);
+            stats.numContended += fGet(CONTENDED);
+            stats.numSpins += fGet(SPINS);
+            stats.waitNs += fGet(WAIT_NS);
+            stats.holdNs += fGet(HOLD_NS);
+            stats.maxWaitNs = std::max(stats.maxWaitNs, fGet(MAX_WAIT_NS));
+            stats.maxHoldNs = std::max(stats.maxHoldNs, fGet(MAX_HOLD_NS));
+            for (size_t i = 0; i < LockProfileStats::NUM_BUCKETS; ++i) {
+                stats.waitHistogram[i] += fGet(WAIT_BUCKETS + i);
+                stats.holdHistogram[i] += fGet(HOLD_BUCKETS + i);
+            }
+        }
+
+        static std::array<char, 16> FormatDuration(uint64_t ns) noexcept {
+            std::array<char, 16> text;
+            if (ns < 10000) {
+                snprintf(text.data(), text.size(), "%lluns", static_cast<unsigned long long>(ns));
+            } else if (ns < 10000000) {
+                snprintf(text.data(), text.size(), "%.1fus", static_cast<double>(ns) / 1e3);
+            } else {
+                snprintf(text.data(), text.size(), "%.1fms", static_cast<double>(ns) / 1e6);
+            }
+            return text;
+        }
+    };
+
+    //Times the acquisitions and hold periods of one lock. Only used with AGT_ENABLE_LOCK_PROFILING.
+    class LockProfileRecorder {
+    public:
+        explicit LockProfileRecorder(const char* name) noexcept
+            : m_lockId(LockProfiler::GetLockId(name)) {}
+
+        static uint64_t GetTicks() noexcept { return TscClock::GetTicks(); }
+
+        //Called by the new owner, waitBeginTicks is the GetTicks() before the first attempt
+        void Acquired(uint64_t waitBeginTicks, uint64_t numSpins, bool contended) noexcept {
+            m_acquiredTicks = GetTicks();
+            LockProfiler::RecordAcquire(m_lockId, TscClock::TicksToDurationNs(m_acquiredTicks - waitBeginTicks), numSpins, contended);
+        }
+
+        //Called by the owner before it unlocks
+        void Released() noexcept {
+            LockProfiler::RecordHold(m_lockId, TscClock::TicksToDurationNs(GetTicks() - m_acquiredTicks));
+        }
+
+    private:
+        uint32_t m_lockId;
+        uint64_t m_acquiredTicks{ 0 }; // only touched by the owner
+    };
+
+    //Passes LockProfiler::GetReport() to fReport every interval from a background thread, and once more when destroyed
+    class LockProfileReporter {
+    public:
+        static std::unique_ptr<LockProfileReporter> Create(std::chrono::milliseconds interval, std::function<void(const std::string&)> fReport) {
+            auto reporter = std::unique_ptr<LockProfileReporter>(new LockProfileReporter());
+            if (!reporter->Init(interval, std::move(fReport))) {
+                return nullptr;
+            }
+            return reporter;
+        }
+
+        ~LockProfileReporter() {
+            if (!m_thread.joinable()) {
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_stop = true;
+            }
+            m_wake.notify_one();
+            m_thread.join();
+            m_fReport(LockProfiler::GetReport());
+        }
+
+    private:
+        LockProfileReporter(const LockProfileReporter&) = delete;
+        LockProfileReporter& operator=(const LockProfileReporter&) = delete;
+
+        LockProfileReporter() = default;
+
+        bool Init(std::chrono::milliseconds interval, std::function<void(const std::string&)> fReport) {
+            if (!fReport || interval.count() <= 0) {
+                return false;
+            }
+
+            m_fReport = std::move(fReport);
+            m_thread = std::thread([this, interval]() {
+                std::unique_lock<std::mutex> lock(m_lock);
+                while (!m_wake.wait_for(lock, interval, [this]() { return m_stop; })) {
+                    lock.unlock();
+                    m_fReport(LockProfiler::GetReport());
+                    lock.lock();
+                }
+            });
+            return true;
+        }
+
+        std::function<void(const std::string&)> m_fReport;
+        std::mutex m_lock;
+        std::condition_variable m_wake;
+        bool m_stop{ false };
+        std::thread m_thread;
+    };
+}
\ No newline at end of file
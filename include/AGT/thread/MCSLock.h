@@ -0,0 +1,138 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "Backoff.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+
+namespace AGT {
+    //Mellor-Crummey and Scott queue lock. Waiters form a linked list and each one spins on a flag in its own
+    //node, so a handoff touches only the cache lines of the owner and its successor, and the lock is FIFO.
+    //lock() and unlock() take a node from a small per-thread pool, so the lock can be used like SpinLock.
+    //The overloads taking a Node skip the lookup, the node must stay alive until the matching unlock.
+    //Like SpinLock it assumes a core per waiting thread, see AdaptiveLock otherwise.
+    //See https://www.cs.rochester.edu/u/scott/papers/1991_TOCS_synch.pdf
+    class MCSLock {
+    public:
+        //Locks one thread can hold at the same time through the overloads without a node
+        static constexpr size_t MAX_HELD_LOCKS = 16;
+
+        struct alignas(64) Node {
+            std::atomic<Node*> next{ nullptr };
+            std::atomic<bool> locked{ false };
+            bool inUse{ false }; // only touched by the thread owning the node
+        };
+
+        MCSLock() noexcept = default;
+
+        void lock() noexcept {
+            Node* node = AcquireThreadNode();
+            lock(*node);
+            m_owner = node;
+        }
+
+        bool try_lock() noexcept {
+            if (m_tail.load(std::memory_order_relaxed)) {
+                return false;
+            }
+
+            Node* node = AcquireThreadNode();
+            if (!try_lock(*node)) {
+                node->inUse = false;
+                return false;
+            }
+            m_owner = node;
+            return true;
+        }
+
+        void unlock() noexcept {
+            Node* node = m_owner;
+            unlock(*node);
+            node->inUse = false;
+        }
+
+        void lock(Node& node) noexcept {
+            node.next.store(nullptr, std::memory_order_relaxed);
+            node.locked.store(true, std::memory_order_relaxed);
+
+            Node* predecessor = m_tail.exchange(&node, std::memory_order_acq_rel);
+            if (!predecessor) {
+                return;
+            }
+
+            predecessor->next.store(&node, std::memory_order_release);
+            while (node.locked.load(std::memory_order_acquire)) {
+                Backoff::Pause();
+            }
+        }
+
+        bool try_lock(Node& node) noexcept {
+            node.next.store(nullptr, std::memory_order_relaxed);
+            Node* tail = nullptr;
+            return m_tail.compare_exchange_strong(tail, &node, std::memory_order_acquire, std::memory_order_relaxed);
+        }
+
+        void unlock(Node& node) noexcept {
+            Node* successor = node.next.load(std::memory_order_acquire);
+            if (!successor) {
+                Node* tail = &node;
+                if (m_tail.compare_exchange_strong(tail, nullptr, std::memory_order_release, std::memory_order_relaxed)) {
+                    return;
+                }
+
+                //a thread is enqueued behind us but hasn't linked itself yet
+                while (!(successor = node.next.load(std::memory_order_acquire))) {
+                    Backoff::Pause();
+                }
+            }
+
+            successor->locked.store(false, std::memory_order_release);
+        }
+
+    private:
+        MCSLock(const MCSLock&) noexcept = delete;
+        MCSLock& operator=(const MCSLock&) noexcept = delete;
+
+        static Node* AcquireThreadNode() noexcept {
+            static thread_local Node s_nodes[MAX_HELD_LOCKS];
+            for (Node& node : s_nodes) {
+                if (!node.inUse) {
+                    node.inUse = true;
+                    return &node;
+                }
+            }
+
+            assert(!"MCSLock: too many locks held by one thread");
+            std::abort();
+        }
+
+        alignas(64) std::atomic<Node*> m_tail{ nullptr };
+        Node* m_owner{ nullptr }; // written by the owner after acquiring, read by it in unlock
+    };
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+//Code that only exists in builds with AGT_ENABLE_LOCK_PROFILING. Other builds don't include the profiler.
+#ifdef AGT_ENABLE_LOCK_PROFILING
+#include "LockProfiler.h"
+
+#include <cstdint>
+
+#define AGT_LOCK_PROFILE(...) __VA_ARGS__
+#else
+#define AGT_LOCK_PROFILE(...)
+#endif
+
+namespace AGT {
+    //A lock reported under a name in builds with AGT_ENABLE_LOCK_PROFILING, and just TLock otherwise.
+    //Waiting is detected with try_lock, so spins are only counted by locks instrumented themselves, like SpinLock.
+#ifdef AGT_ENABLE_LOCK_PROFILING
+    template<typename TLock>
+    class ProfiledLock {
+    public:
+        explicit ProfiledLock(const char* name) noexcept
+            : m_profile(name) {}
+
+        void lock() {
+            uint64_t beginTicks = LockProfileRecorder::GetTicks();
+            bool contended = !m_lock.try_lock();
+            if (contended) {
+                m_lock.lock();
+            }
+            m_profile.Acquired(beginTicks, 0, contended);
+        }
+
+        bool try_lock() {
+            uint64_t beginTicks = LockProfileRecorder::GetTicks();
+            if (!m_lock.try_lock()) {
+                return false;
+            }
+            m_profile.Acquired(beginTicks, 0, false);
+            return true;
+        }
+
+        void unlock() {
+            m_profile.Released();
+            m_lock.unlock();
+        }
+
+    private:
+        ProfiledLock(const ProfiledLock&) = delete;
+        ProfiledLock& operator=(const ProfiledLock&) = delete;
+
+        TLock m_lock;
+        LockProfileRecorder m_profile;
+    };
+#else
+    template<typename TLock>
+    class ProfiledLock : public TLock {
+    public:
+        explicit ProfiledLock(const char* /*name*/) noexcept {}
+    };
+#endif
+}
\ No newline at end of file
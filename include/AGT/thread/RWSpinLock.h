@@ -0,0 +1,141 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "Backoff.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+namespace AGT {
+    //Writer preferring reader-writer spin lock for data that is read by many threads and written rarely.
+    //Readers count themselves in one of several cache line sized slots instead of a shared counter, so
+    //concurrent readers don't bounce a cache line between cores. Each thread keeps the slot it was assigned
+    //on its first read, which spreads up to GetNumSlots() threads one per slot. A writer raises its flag,
+    //which stops new readers, then waits until every slot is empty.
+    //Compatible with std::unique_lock and std::shared_lock.
+    class RWSpinLock {
+    public:
+        static constexpr size_t MAX_SLOTS = 64;
+
+        RWSpinLock() noexcept
+            : m_numSlots(std::clamp<size_t>(std::thread::hardware_concurrency(), 1, MAX_SLOTS)) {}
+
+        void lock() noexcept {
+            Backoff backoff(MAX_WRITER_PAUSES);
+            uint32_t writer = 0;
+            while (!m_writer.compare_exchange_weak(writer, 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                writer = 0;
+                if (!backoff.Spin()) {
+                    backoff.Reset();
+                }
+            }
+
+            for (size_t i = 0; i < m_numSlots; ++i) {
+                while (m_slots[i].numReaders.load(std::memory_order_seq_cst)) {
+                    Backoff::Pause();
+                }
+            }
+        }
+
+        bool try_lock() noexcept {
+            uint32_t writer = 0;
+            if (!m_writer.compare_exchange_strong(writer, 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                return false;
+            }
+
+            for (size_t i = 0; i < m_numSlots; ++i) {
+                if (m_slots[i].numReaders.load(std::memory_order_seq_cst)) {
+                    m_writer.store(0, std::memory_order_release);
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void unlock() noexcept {
+            m_writer.store(0, std::memory_order_release);
+        }
+
+        void lock_shared() noexcept {
+            std::atomic<uint32_t>& numReaders = GetThreadSlot();
+            for (;;) {
+                while (m_writer.load(std::memory_order_relaxed)) {
+                    Backoff::Pause();
+                }
+
+                //pairs with the writer raising its flag before it checks the slots
+                numReaders.fetch_add(1, std::memory_order_seq_cst);
+                if (!m_writer.load(std::memory_order_seq_cst)) {
+                    return;
+                }
+                numReaders.fetch_sub(1, std::memory_order_release);
+            }
+        }
+
+        bool try_lock_shared() noexcept {
+            std::atomic<uint32_t>& numReaders = GetThreadSlot();
+            if (m_writer.load(std::memory_order_relaxed)) {
+                return false;
+            }
+
+            numReaders.fetch_add(1, std::memory_order_seq_cst);
+            if (!m_writer.load(std::memory_order_seq_cst)) {
+                return true;
+            }
+            numReaders.fetch_sub(1, std::memory_order_release);
+            return false;
+        }
+
+        void unlock_shared() noexcept {
+            GetThreadSlot().fetch_sub(1, std::memory_order_release);
+        }
+
+        size_t GetNumSlots() const noexcept { return m_numSlots; }
+
+    private:
+        RWSpinLock(const RWSpinLock&) noexcept = delete;
+        RWSpinLock& operator=(const RWSpinLock&) noexcept = delete;
+
+        static constexpr uint32_t MAX_WRITER_PAUSES = 64;
+
+        struct alignas(64) Slot {
+            std::atomic<uint32_t> numReaders{ 0 };
+        };
+
+        std::atomic<uint32_t>& GetThreadSlot() noexcept {
+            static std::atomic<size_t> s_nextThreadIndex{ 0 };
+            static thread_local size_t s_threadIndex = s_nextThreadIndex.fetch_add(1, std::memory_order_relaxed);
+            return m_slots[s_threadIndex % m_numSlots].numReaders;
+        }
+
+        alignas(64) std::atomic<uint32_t> m_writer{ 0 };
+        size_t m_numSlots;
+        Slot m_slots[MAX_SLOTS];
+    };
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "Backoff.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace AGT {
+    //Sequence lock for a small trivially copyable value. Readers never write shared memory: they copy the value
+    //and retry if a writer changed the sequence number in the meantime, so any number of them scale freely.
+    //Writers are serialized by the sequence number itself. Suited to values that are read far more often than
+    //written, since a steady stream of writes can keep readers retrying.
+    //The value is stored as relaxed atomic words, so the racing copy is well defined.
+    //See "Can Seqlocks Get Along With Programming Language Memory Models?" by Hans Boehm.
+    template<typename T>
+    class SeqLock {
+    public:
+        static_assert(std::is_trivially_copyable_v<T>, "SeqLock values are copied while they may be written");
+
+        SeqLock() noexcept : SeqLock(T{}) {}
+
+        explicit SeqLock(const T& value) noexcept {
+            StoreWords(value);
+        }
+
+        T Load() const noexcept {
+            for (;;) {
+                uint32_t sequence = m_sequence.load(std::memory_order_acquire);
+                if (sequence & 1) {
+                    Backoff::Pause();
+                    continue;
+                }
+
+                uint64_t words[NUM_WORDS];
+                for (size_t i = 0; i < NUM_WORDS; ++i) {
+                    words[i] = m_words[i].load(std::memory_order_relaxed);
+                }
+
+                //the copy must complete before the sequence number is checked again
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (m_sequence.load(std::memory_order_relaxed) == sequence) {
+                    T value;
+                    memcpy(&value, words, sizeof(T));
+                    return value;
+                }
+            }
+        }
+
+        void Store(const T& value) noexcept {
+            uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+            for (;;) {
+                if (!(sequence & 1)
+                    && m_sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_relaxed, std::memory_order_relaxed)) {
+                    break;
+                }
+                Backoff::Pause();
+                sequence = m_sequence.load(std::memory_order_relaxed);
+            }
+
+            //the odd sequence number must be visible before any of the new words
+            std::atomic_thread_fence(std::memory_order_release);
+            StoreWords(value);
+            m_sequence.store(sequence + 2, std::memory_order_release);
+        }
+
+    private:
+        SeqLock(const SeqLock&) noexcept = delete;
+        SeqLock& operator=(const SeqLock&) noexcept = delete;
+
+        static constexpr size_t NUM_WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+        void StoreWords(const T& value) noexcept {
+            uint64_t words[NUM_WORDS]{};
+            memcpy(words, &value, sizeof(T));
+            for (size_t i = 0; i < NUM_WORDS; ++i) {
+                m_words[i].store(words[i], std::memory_order_relaxed);
+            }
+        }
+
+        std::atomic<uint32_t> m_sequence{ 0 };
+        std::atomic<uint64_t> m_words[NUM_WORDS];
+    };
+}
\ No newline at end of file
@@ -24,25 +24,31 @@ SOFTWARE.
 
 #pragma once
 
+#include "Backoff.h"
+#include "ProfiledLock.h"
+
 #include <atomic>
-#include <immintrin.h>
 
 namespace AGT {
     class SpinLock {
     public:
-        SpinLock() noexcept = default;
+        SpinLock() noexcept AGT_LOCK_PROFILE(: m_profile("SpinLock")) {}
+
+        //The name is what the lock is reported as with AGT_ENABLE_LOCK_PROFILING, unnamed locks are "SpinLock"
+        explicit SpinLock([[maybe_unused]] const char* name) noexcept AGT_LOCK_PROFILE(: m_profile(name)) {}
 
         void lock() noexcept {
+            AGT_LOCK_PROFILE(uint64_t beginTicks = LockProfileRecorder::GetTicks(); uint64_t numSpins = 0; bool contended = false;)
             for (;;) {
                 if (!m_lock.exchange(true, std::memory_order_acquire)) {
+                    AGT_LOCK_PROFILE(m_profile.Acquired(beginTicks, numSpins, contended);)
                     return;
                 }
 
+                AGT_LOCK_PROFILE(contended = true;)
                 while (m_lock.load(std::memory_order_relaxed)) {
-                    //https://stackoverflow.com/questions/5833527/how-do-you-use-the-pause-assembly-instruction-in-64-bit-c-code
-                    //hint to the compiler that a spin-wait loop is used
-                    //TODO assumes SSE2 support. In the future, detect SSE2 or fail
-                    _mm_pause();
+                    Backoff::Pause();
+                    AGT_LOCK_PROFILE(++numSpins;)
                 }
             }
         }
@@ -52,10 +58,16 @@ namespace AGT {
                 return false;
             }
 
-            return !m_lock.exchange(true, std::memory_order_acquire);
+            AGT_LOCK_PROFILE(uint64_t beginTicks = LockProfileRecorder::GetTicks();)
+            if (m_lock.exchange(true, std::memory_order_acquire)) {
+                return false;
+            }
+            AGT_LOCK_PROFILE(m_profile.Acquired(beginTicks, 0, false);)
+            return true;
         }
 
         void unlock() noexcept {
+            AGT_LOCK_PROFILE(m_profile.Released();)
             m_lock.store(false, std::memory_order_release);
         }
 
@@ -64,5 +76,6 @@ namespace AGT {
         SpinLock& operator=(const SpinLock&) noexcept = delete;
 
         std::atomic<bool> m_lock { false };
+        AGT_LOCK_PROFILE(LockProfileRecorder m_profile;)
     };
 }
\ No newline at end of file
@@ -0,0 +1,142 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "../platform/Platform.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string_view>
+#include <thread>
+
+#ifdef AGT_PLAT_WINDOWS
+#include <process.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+namespace AGT {
+    //Process and thread identity for log headers, looked up once and cached.
+    //The process id is refreshed in a forked child, the thread part is pre-rendered per thread.
+    class ThreadInfo {
+    public:
+        static constexpr size_t MAX_THREAD_NAME_SIZE = 32;
+
+        static int GetProcessId() noexcept {
+            int pid = s_processId.load(std::memory_order_relaxed);
+            if (pid == 0) {
+                pid = RefreshProcessId();
+            }
+            return pid;
+        }
+
+        static uint64_t GetThreadId() noexcept {
+            return GetThreadState().threadId;
+        }
+
+        //Shown in the log header of every entry written by the calling thread, longer names are truncated
+        static void SetThreadName(std::string_view name) noexcept {
+            ThreadState& state = GetThreadState();
+            state.nameSize = std::min(name.size(), MAX_THREAD_NAME_SIZE);
+            memcpy(state.name, name.data(), state.nameSize);
+            state.headerPid = 0;
+        }
+
+        static std::string_view GetThreadName() noexcept {
+            ThreadState& state = GetThreadState();
+            return { state.name, state.nameSize };
+        }
+
+        //"[pid=..][tid=..]" followed by "[name]" if the thread is named
+        static std::string_view GetLogHeader() noexcept {
+            ThreadState& state = GetThreadState();
+            int pid = GetProcessId();
+            if (state.headerPid != pid) {
+                RenderLogHeader(state, pid);
+            }
+            return { state.header, state.headerSize };
+        }
+
+    private:
+        ThreadInfo() = delete;
+
+        static constexpr size_t MAX_HEADER_SIZE = 64 + MAX_THREAD_NAME_SIZE;
+
+        struct ThreadState {
+            uint64_t threadId{ std::hash<std::thread::id>{}(std::this_thread::get_id()) };
+            int headerPid{ 0 }; // pid the header was rendered with, 0 when it has to be rendered again
+            size_t nameSize{ 0 };
+            size_t headerSize{ 0 };
+            char name[MAX_THREAD_NAME_SIZE];
+            char header[MAX_HEADER_SIZE];
+        };
+
+        static ThreadState& GetThreadState() noexcept {
+            static thread_local ThreadState s_state;
+            return s_state;
+        }
+
+        static int RefreshProcessId() noexcept {
+#ifdef AGT_PLAT_WINDOWS
+            int pid = _getpid();
+#else
+            //the child of a fork() would otherwise keep logging the parent's pid
+            static const bool s_atforkRegistered = []() noexcept {
+                return pthread_atfork(nullptr, nullptr, []() { s_processId.store(0, std::memory_order_relaxed); }) == 0;
+            }();
+            (void)s_atforkRegistered;
+
+            int pid = static_cast<int>(getpid());
+#endif
+            s_processId.store(pid, std::memory_order_relaxed);
+            return pid;
+        }
+
+        static void RenderLogHeader(ThreadState& state, int pid) noexcept {
+            int size = 0;
+            if (state.nameSize > 0) {
+                size = snprintf(state.header, MAX_HEADER_SIZE, "[pid=%i][tid=%llu][%.*s]",
+                                pid,
+                                static_cast<unsigned long long>(state.threadId),
+                                static_cast<int>(state.nameSize),
+                                state.name);
+            } else {
+                size = snprintf(state.header, MAX_HEADER_SIZE, "[pid=%i][tid=%llu]",
+                                pid,
+                                static_cast<unsigned long long>(state.threadId));
+            }
+
+            state.headerSize = std::clamp<size_t>(size, 0, MAX_HEADER_SIZE - 1);
+            state.headerPid = pid;
+        }
+
+        static inline std::atomic<int> s_processId{ 0 };
+    };
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "Backoff.h"
+
+#include <atomic>
+#include <cstdint>
+
+namespace AGT {
+    //FIFO spin lock. Each thread takes a ticket and waits until it is served, so no thread can be starved.
+    //The ticket counter and the served counter live on separate cache lines, so arriving threads don't
+    //disturb the ones polling for their turn. Waiters back off in proportion to their place in the queue.
+    //Like SpinLock it assumes a core per waiting thread, see AdaptiveLock otherwise.
+    class TicketLock {
+    public:
+        TicketLock() noexcept = default;
+
+        void lock() noexcept {
+            uint32_t ticket = m_nextTicket.value.fetch_add(1, std::memory_order_relaxed);
+            for (;;) {
+                uint32_t serving = m_serving.value.load(std::memory_order_acquire);
+                if (serving == ticket) {
+                    return;
+                }
+
+                for (uint32_t i = (ticket - serving) * PAUSES_PER_WAITER; i > 0; --i) {
+                    Backoff::Pause();
+                }
+            }
+        }
+
+        bool try_lock() noexcept {
+            uint32_t serving = m_serving.value.load(std::memory_order_relaxed);
+            uint32_t ticket = serving;
+            return m_nextTicket.value.compare_exchange_strong(ticket, serving + 1, std::memory_order_acquire, std::memory_order_relaxed);
+        }
+
+        void unlock() noexcept {
+            //only the owner writes the served counter
+            m_serving.value.store(m_serving.value.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+    private:
+        TicketLock(const TicketLock&) noexcept = delete;
+        TicketLock& operator=(const TicketLock&) noexcept = delete;
+
+        static constexpr uint32_t PAUSES_PER_WAITER = 8;
+
+        struct alignas(64) Counter {
+            std::atomic<uint32_t> value{ 0 };
+        };
+
+        Counter m_nextTicket;
+        Counter m_serving;
+    };
+}
\ No newline at end of file
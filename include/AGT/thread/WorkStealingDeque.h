@@ -0,0 +1,120 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace AGT {
+    //Chase-Lev work-stealing deque of a fixed capacity. The owning thread pushes and pops at the bottom,
+    //any other thread steals from the top, so the owner works LIFO on hot data while thieves take the oldest,
+    //usually largest, pieces of work. T must be trivially copyable, e.g. a pointer.
+    //See "Correct and Efficient Work-Stealing for Weak Memory Models" by Lê, Pop, Cohen and Zappa Nardelli.
+    template<typename T>
+    class WorkStealingDeque {
+    public:
+        static constexpr size_t CACHE_LINE_SIZE = 64;
+
+        explicit WorkStealingDeque(size_t capacity) {
+            size_t size = 2;
+            while (size < capacity) {
+                size <<= 1;
+            }
+
+            m_mask = size - 1;
+            m_items.reset(new std::atomic<T>[size]);
+        }
+
+        //Owner only. Returns false if the deque is full.
+        bool Push(T item) noexcept {
+            int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+            int64_t top = m_top.load(std::memory_order_acquire);
+            if (bottom - top > static_cast<int64_t>(m_mask)) {
+                return false;
+            }
+
+            //release, so a thief that reads the slot also sees what the item points to
+            m_items[bottom & m_mask].store(item, std::memory_order_release);
+            std::atomic_thread_fence(std::memory_order_release);
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        //Owner only. Takes the most recently pushed item.
+        bool Pop(T& item) noexcept {
+            int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+            m_bottom.store(bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t top = m_top.load(std::memory_order_relaxed);
+
+            if (top > bottom) {
+                m_bottom.store(bottom + 1, std::memory_order_relaxed);
+                return false;
+            }
+
+            item = m_items[bottom & m_mask].load(std::memory_order_relaxed);
+            if (top == bottom) {
+                //the last item, race the thieves for it
+                bool won = m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+                m_bottom.store(bottom + 1, std::memory_order_relaxed);
+                return won;
+            }
+            return true;
+        }
+
+        //Any thread. Takes the oldest item, fails if the deque is empty or another thread took it first.
+        bool Steal(T& item) noexcept {
+            int64_t top = m_top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t bottom = m_bottom.load(std::memory_order_acquire);
+            if (top >= bottom) {
+                return false;
+            }
+
+            item = m_items[top & m_mask].load(std::memory_order_acquire);
+            return m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        }
+
+        //Approximate when called concurrently with the owner or thieves
+        bool IsEmpty() const noexcept {
+            return m_top.load(std::memory_order_acquire) >= m_bottom.load(std::memory_order_acquire);
+        }
+
+        size_t GetCapacity() const noexcept {
+            return m_mask + 1;
+        }
+
+    private:
+        WorkStealingDeque(const WorkStealingDeque&) = delete;
+        WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+        std::unique_ptr<std::atomic<T>[]> m_items;
+        size_t m_mask{ 0 };
+        alignas(CACHE_LINE_SIZE) std::atomic<int64_t> m_top{ 0 };
+        alignas(CACHE_LINE_SIZE) std::atomic<int64_t> m_bottom{ 0 };
+    };
+}
\ No newline at end of file
@@ -24,7 +24,8 @@ SOFTWARE.
 
 #pragma once
 
-#include <chrono>
+#include "TscClock.h"
+
 #include <cstdint>
 
 namespace AGT {
@@ -35,24 +36,22 @@ namespace AGT {
         }
 
         static uint64_t GetTimeSinceEpochNs() noexcept {
-            auto duration = std::chrono::high_resolution_clock::now().time_since_epoch();
-            return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+            return TscClock::GetTimeSinceEpochNs();
         }
 
         float GetDeltaTMs() const noexcept {
-            auto now = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration<float, std::milli>(now - m_previousTime);
-            return duration.count();
+            uint64_t elapsedNs = TscClock::TicksToDurationNs(TscClock::GetTicks() - m_previousTicks);
+            return static_cast<float>(elapsedNs) / 1'000'000.0f;
         }
 
         float GetAndUpdateDeltaTMs() noexcept {
-            auto now = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration<float, std::milli>(now - m_previousTime);
-            m_previousTime = now;
-            return duration.count();
+            uint64_t now = TscClock::GetTicks();
+            uint64_t elapsedNs = TscClock::TicksToDurationNs(now - m_previousTicks);
+            m_previousTicks = now;
+            return static_cast<float>(elapsedNs) / 1'000'000.0f;
         }
 
     private:
-        std::chrono::time_point<std::chrono::high_resolution_clock> m_previousTime;
+        uint64_t m_previousTicks{ 0 };
     };
 }
\ No newline at end of file
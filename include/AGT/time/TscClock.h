@@ -0,0 +1,214 @@
+/*
+MIT License
+
+Copyright(c) 2024 Alexandr Sachkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files(the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and /or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#pragma once
+
+#include "../platform/Compiler.h"
+#include "../platform/Platform.h"
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(AGT_ARCH_X64) || defined(AGT_ARCH_X86)
+#define AGT_TSC_SUPPORTED
+#ifdef AGT_COMPILER_MSVC
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+#endif
+
+#ifndef AGT_PLAT_WINDOWS
+#include <time.h>
+#endif
+
+namespace AGT {
+    //Low overhead clock built on the invariant TSC. Ticks are converted to nanoseconds with a fixed point multiply
+    //calibrated against the monotonic and realtime clocks. Without an invariant TSC, ticks are monotonic nanoseconds.
+    //Hot paths can store GetTicks() and convert later.
+    class TscClock {
+    public:
+        //Calibration takes ~10ms and otherwise happens on first use, so call this at startup
+        static void Init() noexcept {
+            GetCalibration();
+        }
+
+        static uint64_t GetTicks() noexcept {
+#ifdef AGT_TSC_SUPPORTED
+            if (GetCalibration().useTsc) {
+                return __rdtsc();
+            }
+#endif
+            return ReadMonotonicNs();
+        }
+
+        static uint64_t TicksToDurationNs(uint64_t ticks) noexcept {
+            return MulShift(ticks, GetCalibration().multiplier);
+        }
+
+        //Same time base as the monotonic clock (CLOCK_MONOTONIC on POSIX)
+        static uint64_t TicksToMonotonicNs(uint64_t ticks) noexcept {
+            const Calibration& calibration = GetCalibration();
+            if (ticks >= calibration.baseTicks) {
+                return calibration.baseMonotonicNs + MulShift(ticks - calibration.baseTicks, calibration.multiplier);
+            }
+            return calibration.baseMonotonicNs - MulShift(calibration.baseTicks - ticks, calibration.multiplier);
+        }
+
+        static uint64_t TicksToEpochNs(uint64_t ticks) noexcept {
+            return TicksToMonotonicNs(ticks) + GetCalibration().epochOffsetNs;
+        }
+
+        static uint64_t GetMonotonicNs() noexcept {
+            return TicksToMonotonicNs(GetTicks());
+        }
+
+        static uint64_t GetTimeSinceEpochNs() noexcept {
+            return TicksToEpochNs(GetTicks());
+        }
+
+        static bool IsUsingTsc() noexcept {
+            return GetCalibration().useTsc;
+        }
+
+        static uint64_t GetTicksPerSecond() noexcept {
+            return GetCalibration().ticksPerSecond;
+        }
+
+    private:
+        TscClock() = delete;
+
+        static constexpr int FRACTION_BITS = 32;
+        static constexpr uint64_t CALIBRATION_NS = 10'000'000;
+
+        struct Calibration {
+            bool useTsc{ false };
+            uint64_t baseTicks{ 0 };
+            uint64_t baseMonotonicNs{ 0 };
+            uint64_t multiplier{ 1ull << FRACTION_BITS }; // nanoseconds per tick, 32.32 fixed point
+            uint64_t epochOffsetNs{ 0 };
+            uint64_t ticksPerSecond{ 1'000'000'000 };
+        };
+
+        static const Calibration& GetCalibration() noexcept {
+            static const Calibration s_calibration = Calibrate();
+            return s_calibration;
+        }
+
+        static Calibration Calibrate() noexcept {
+            Calibration calibration;
+
+            //bracket the realtime read with monotonic reads to estimate the offset between the two
+            uint64_t monotonicBeforeNs = ReadMonotonicNs();
+            uint64_t realtimeNs = ReadRealtimeNs();
+            uint64_t monotonicAfterNs = ReadMonotonicNs();
+            calibration.epochOffsetNs = realtimeNs - (monotonicBeforeNs + (monotonicAfterNs - monotonicBeforeNs) / 2);
+
+#ifdef AGT_TSC_SUPPORTED
+            if (!HasInvariantTsc()) {
+                return calibration;
+            }
+
+            uint64_t startTicks = __rdtsc();
+            uint64_t startNs = ReadMonotonicNs();
+            uint64_t endNs = startNs;
+            while (endNs - startNs < CALIBRATION_NS) {
+                endNs = ReadMonotonicNs();
+            }
+            uint64_t endTicks = __rdtsc();
+
+            uint64_t elapsedTicks = endTicks - startTicks;
+            uint64_t elapsedNs = endNs - startNs;
+            if (elapsedTicks == 0) {
+                return calibration;
+            }
+
+            calibration.useTsc = true;
+            calibration.baseTicks = endTicks;
+            calibration.baseMonotonicNs = endNs;
+            calibration.multiplier = (elapsedNs << FRACTION_BITS) / elapsedTicks;
+            calibration.ticksPerSecond = elapsedTicks * 1'000'000'000 / elapsedNs;
+#endif
+            return calibration;
+        }
+
+#ifdef AGT_TSC_SUPPORTED
+        //CPUID.80000007H:EDX[8], the TSC runs at a constant rate in all P/C-states
+        static bool HasInvariantTsc() noexcept {
+#ifdef AGT_COMPILER_MSVC
+            int regs[4] = {};
+            __cpuid(regs, 0x80000000);
+            if (static_cast<unsigned>(regs[0]) < 0x80000007) {
+                return false;
+            }
+            __cpuid(regs, 0x80000007);
+            return (regs[3] & (1 << 8)) != 0;
+#else
+            unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+            if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) {
+                return false;
+            }
+            return (edx & (1u << 8)) != 0;
+#endif
+        }
+#endif
+
+        static uint64_t ReadMonotonicNs() noexcept {
+#ifdef AGT_PLAT_WINDOWS
+            auto duration = std::chrono::steady_clock::now().time_since_epoch();
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+#else
+            timespec ts;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            return static_cast<uint64_t>(ts.tv_sec) * 1'000'000'000 + ts.tv_nsec;
+#endif
+        }
+
+        static uint64_t ReadRealtimeNs() noexcept {
+#ifdef AGT_PLAT_WINDOWS
+            auto duration = std::chrono::system_clock::now().time_since_epoch();
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+#else
+            timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            return static_cast<uint64_t>(ts.tv_sec) * 1'000'000'000 + ts.tv_nsec;
+#endif
+        }
+
+        static uint64_t MulShift(uint64_t value, uint64_t multiplier) noexcept {
+#if defined(__SIZEOF_INT128__)
+            return static_cast<uint64_t>((static_cast<unsigned __int128>(value) * multiplier) >> FRACTION_BITS);
+#elif defined(AGT_COMPILER_MSVC) && defined(AGT_ARCH_X64)
+            uint64_t high = 0;
+            uint64_t low = _umul128(value, multiplier, &high);
+            return __shiftright128(low, high, FRACTION_BITS);
+#else
+            uint64_t high = (value >> 32) * multiplier;
+            uint64_t low = ((value & 0xFFFFFFFF) * (multiplier & 0xFFFFFFFF)) >> 32;
+            return high + low + (value & 0xFFFFFFFF) * (multiplier >> 32);
+#endif
+        }
+    };
+}
\ No newline at end of file
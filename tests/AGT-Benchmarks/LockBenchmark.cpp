@@ -0,0 +1,182 @@
+#include "AGT/thread/AdaptiveLock.h"
+#include "AGT/thread/MCSLock.h"
+#include "AGT/thread/SpinLock.h"
+#include "AGT/thread/TicketLock.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Throughput and fairness of the locks in AGT/thread against std::mutex. Every thread repeatedly takes the lock,
+//updates a few shared cache lines and does some private work outside of it, for a fixed duration.
+//Fairness is the fewest acquisitions of any thread divided by the most, 1.0 means every thread got equal turns.
+//Runs with more threads than cores show how each lock behaves when owners get descheduled.
+
+namespace {
+    struct Options {
+        size_t minThreads{ 2 };
+        size_t maxThreads{ 64 };
+        std::chrono::milliseconds duration{ 200 };
+        bool quick{ false };
+    };
+
+    struct Result {
+        double acquiresPerSecond{ 0 };
+        double fairness{ 0 };
+        bool valid{ false };
+    };
+
+    struct alignas(64) ThreadCount {
+        uint64_t value{ 0 };
+    };
+
+    //Data touched inside the critical section, a few cache lines like a small shared structure
+    struct SharedState {
+        std::array<uint64_t, 32> values{};
+        uint64_t numAcquires{ 0 };
+    };
+
+    template<typename TLock>
+    Result Run(size_t numThreads, std::chrono::milliseconds duration) {
+        TLock lock;
+        SharedState state;
+        std::vector<ThreadCount> counts(numThreads);
+        std::atomic<size_t> numReady{ 0 };
+        std::atomic<bool> start{ false };
+        std::atomic<bool> stop{ false };
+
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < numThreads; ++i) {
+            threads.emplace_back([&, i]() {
+                uint64_t local = i;
+                uint64_t numAcquires = 0;
+                numReady.fetch_add(1);
+                while (!start.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+
+                while (!stop.load(std::memory_order_relaxed)) {
+                    {
+                        std::lock_guard<TLock> guard(lock);
+                        for (uint64_t& value : state.values) {
+                            value += local;
+                        }
+                        ++state.numAcquires;
+                    }
+                    ++numAcquires;
+
+                    //private work between acquisitions
+                    for (int j = 0; j < 50; ++j) {
+                        local = local * 6364136223846793005ull + 1442695040888963407ull;
+                    }
+                }
+                counts[i].value = numAcquires;
+            });
+        }
+
+        while (numReady.load() < numThreads) {
+            std::this_thread::yield();
+        }
+
+        auto begin = std::chrono::steady_clock::now();
+        start.store(true, std::memory_order_release);
+        std::this_thread::sleep_for(duration);
+        stop.store(true, std::memory_order_relaxed);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        uint64_t total = 0;
+        uint64_t minCount = UINT64_MAX;
+        uint64_t maxCount = 0;
+        for (const ThreadCount& count : counts) {
+            total += count.value;
+            minCount = std::min(minCount, count.value);
+            maxCount = std::max(maxCount, count.value);
+        }
+
+        Result result;
+        result.acquiresPerSecond = static_cast<double>(total) / std::max(seconds, 1e-9);
+        result.fairness = maxCount ? static_cast<double>(minCount) / static_cast<double>(maxCount) : 0;
+        result.valid = total == state.numAcquires;
+        return result;
+    }
+
+    struct LockConfig {
+        const char* name;
+        Result (*fRun)(size_t numThreads, std::chrono::milliseconds duration);
+    };
+
+    const std::array<LockConfig, 5> LOCKS = { {
+        { "SpinLock", &Run<AGT::SpinLock> },
+        { "TicketLock", &Run<AGT::TicketLock> },
+        { "MCSLock", &Run<AGT::MCSLock> },
+        { "AdaptiveLock", &Run<AGT::AdaptiveLock> },
+        { "std::mutex", &Run<std::mutex> },
+    } };
+
+    bool ParseOptions(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+                options.maxThreads = std::max(strtoull(argv[++i], nullptr, 10), 1ull);
+            } else if (!strcmp(argv[i], "--duration") && i + 1 < argc) {
+                options.duration = std::chrono::milliseconds(std::max(strtoull(argv[++i], nullptr, 10), 1ull));
+            } else if (!strcmp(argv[i], "--quick")) {
+                options.quick = true;
+            } else {
+                printf("Usage: %s [--threads N] [--duration MS] [--quick]\n", argv[0]);
+                printf("  --threads   largest thread count, runs 2, 4, 8... up to it (default: 64)\n");
+                printf("  --duration  milliseconds per lock and thread count (default: 200)\n");
+                printf("  --quick     smoke run of 10 ms with at most 4 threads\n");
+                return false;
+            }
+        }
+
+        if (options.quick) {
+            options.maxThreads = std::min<size_t>(options.maxThreads, 4);
+            options.duration = std::min(options.duration, std::chrono::milliseconds(10));
+        }
+        options.minThreads = std::min(options.minThreads, options.maxThreads);
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    std::vector<size_t> threadCounts;
+    for (size_t numThreads = options.minThreads; numThreads < options.maxThreads; numThreads *= 2) {
+        threadCounts.push_back(numThreads);
+    }
+    threadCounts.push_back(options.maxThreads);
+
+    printf("%lld ms per run, %u hardware threads\n\n", static_cast<long long>(options.duration.count()), std::thread::hardware_concurrency());
+    printf("%-14s %7s %14s %9s\n", "lock", "threads", "acquires/s", "fairness");
+
+    int exitCode = 0;
+    for (const LockConfig& lock : LOCKS) {
+        for (size_t numThreads : threadCounts) {
+            Result result = lock.fRun(numThreads, options.duration);
+            printf("%-14s %7zu %14.0f %9.3f%s\n", lock.name, numThreads, result.acquiresPerSecond, result.fairness,
+                result.valid ? "" : " lost updates");
+            fflush(stdout);
+            if (!result.valid) {
+                exitCode = 1;
+            }
+        }
+    }
+
+    return exitCode;
+}
\ No newline at end of file
@@ -0,0 +1,277 @@
+#include "AGT/log/DefaultLogFormatter.h"
+#include "AGT/log/DefaultLogger.h"
+#include "AGT/log/ILoggerSink.h"
+#include "AGT/log/LogSite.h"
+#include "AGT/log/LoggerConsoleSink.h"
+#include "AGT/log/LoggerFileSink.h"
+#include "AGT/time/TscClock.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+//Per call latency and throughput of DefaultLogger::Write for every combination of logger mode, sink,
+//message shape and producer thread count. Latency is measured around each Write with TscClock.
+//Throughput includes the final Flush, so in async mode it is bounded by the backend.
+
+using Logger = AGT::DefaultLogger<AGT::DefaultLogFormatter>;
+
+namespace {
+    struct Options {
+        size_t maxThreads{ std::max<size_t>(std::thread::hardware_concurrency(), 1) };
+        size_t numMessages{ 100000 }; // per thread
+        bool quick{ false };
+    };
+
+    struct NullSink : public AGT::ILoggerSink {
+        void Write(const char*, size_t) override {}
+        void WriteBatch(std::span<const AGT::IoBuffer>) override {}
+    };
+
+    //Points stdout at /dev/null while a console sink run is in progress
+    class StdoutRedirect {
+    public:
+        StdoutRedirect() {
+            fflush(stdout);
+#ifndef _WIN32
+            m_savedFd = dup(STDOUT_FILENO);
+            int nullFd = open("/dev/null", O_WRONLY);
+            if (m_savedFd >= 0 && nullFd >= 0) {
+                dup2(nullFd, STDOUT_FILENO);
+            }
+            if (nullFd >= 0) {
+                close(nullFd);
+            }
+#endif
+        }
+
+        ~StdoutRedirect() {
+#ifndef _WIN32
+            if (m_savedFd >= 0) {
+                dup2(m_savedFd, STDOUT_FILENO);
+                close(m_savedFd);
+            }
+#endif
+        }
+
+    private:
+        int m_savedFd{ -1 };
+    };
+
+    struct SinkConfig {
+        const char* name;
+        bool redirectStdout;
+        std::function<std::shared_ptr<AGT::ILoggerSink>(const std::string& path)> fCreate;
+    };
+
+    struct MessageShape {
+        const char* name;
+        void (*fWrite)(Logger& logger, size_t index);
+    };
+
+    const std::string ASSET_PATH = "assets/characters/player/textures/diffuse.dds";
+    const std::string LONG_TEXT(200, 'x');
+
+    const std::array<SinkConfig, 4> SINKS = { {
+        { "null", false, [](const std::string&) -> std::shared_ptr<AGT::ILoggerSink> { return std::make_shared<NullSink>(); } },
+        { "file", false, [](const std::string& path) -> std::shared_ptr<AGT::ILoggerSink> { return AGT::LoggerFileSink::Create(path.c_str()); } },
+        //a one byte buffer sends every entry straight to the file
+        { "file-unbuffered", false, [](const std::string& path) -> std::shared_ptr<AGT::ILoggerSink> { return AGT::LoggerFileSink::Create(path.c_str(), 1); } },
+        { "console", true, [](const std::string&) -> std::shared_ptr<AGT::ILoggerSink> { return std::make_shared<AGT::LoggerConsoleSink>(); } },
+    } };
+
+    const std::array<MessageShape, 5> SHAPES = { {
+        { "literal", [](Logger& logger, size_t) {
+            static const AGT::LogSite s_site(AGT::LogLevel::InfoV1, "LoggerBenchmark.cpp", "Literal", __LINE__);
+            logger.Write(s_site, "Frame finished");
+        } },
+        { "ints", [](Logger& logger, size_t index) {
+            static const AGT::LogSite s_site(AGT::LogLevel::InfoV1, "LoggerBenchmark.cpp", "Ints", __LINE__);
+            logger.Write(s_site, "Entity %zu moved to %i %i %i", index, 10, -20, 30);
+        } },
+        { "double", [](Logger& logger, size_t index) {
+            static const AGT::LogSite s_site(AGT::LogLevel::InfoV1, "LoggerBenchmark.cpp", "Double", __LINE__);
+            logger.Write(s_site, "Frame time %f ms", 16.6 + static_cast<double>(index % 100) * 0.01);
+        } },
+        { "string", [](Logger& logger, size_t) {
+            static const AGT::LogSite s_site(AGT::LogLevel::InfoV1, "LoggerBenchmark.cpp", "String", __LINE__);
+            logger.Write(s_site, "Loading asset %s", ASSET_PATH.c_str());
+        } },
+        { "long", [](Logger& logger, size_t index) {
+            static const AGT::LogSite s_site(AGT::LogLevel::InfoV1, "LoggerBenchmark.cpp", "Long", __LINE__);
+            logger.Write(s_site, "Request %zu failed: %s", index, LONG_TEXT.c_str());
+        } },
+    } };
+
+    struct Result {
+        double messagesPerSecond{ 0 };
+        uint64_t p50Ns{ 0 };
+        uint64_t p99Ns{ 0 };
+        uint64_t p999Ns{ 0 };
+        uint64_t maxNs{ 0 };
+    };
+
+    uint64_t GetPercentile(const std::vector<uint64_t>& sorted, double percentile) {
+        size_t index = static_cast<size_t>(percentile * static_cast<double>(sorted.size() - 1) + 0.5);
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+
+    bool Run(bool async, const SinkConfig& sinkConfig, const MessageShape& shape, size_t numThreads, size_t numMessages, Result& result) {
+        const std::string path = (std::filesystem::temp_directory_path() / "agt_logger_benchmark.log").string();
+
+        std::vector<std::vector<uint64_t>> latencies(numThreads, std::vector<uint64_t>(numMessages));
+        double seconds = 0;
+        {
+            std::unique_ptr<StdoutRedirect> redirect;
+            if (sinkConfig.redirectStdout) {
+                redirect = std::make_unique<StdoutRedirect>();
+            }
+
+            std::array<std::shared_ptr<AGT::ILoggerSink>, 1> sinks = { sinkConfig.fCreate(path) };
+            if (!sinks[0]) {
+                return false;
+            }
+
+            AGT::LoggerAsyncConfig config;
+            config.queueSize = 8192;
+            auto logger = async ?
+                Logger::CreateAsync(AGT::LogLevel::InfoV1, 512, sinks, config) :
+                Logger::Create(AGT::LogLevel::InfoV1, 512, sinks);
+            if (!logger) {
+                return false;
+            }
+
+            std::atomic<size_t> numReady{ 0 };
+            std::atomic<bool> start{ false };
+            std::vector<std::thread> threads;
+            for (size_t i = 0; i < numThreads; ++i) {
+                threads.emplace_back([&, i]() {
+                    std::vector<uint64_t>& threadLatencies = latencies[i];
+                    numReady.fetch_add(1);
+                    while (!start.load(std::memory_order_acquire)) {
+                        std::this_thread::yield();
+                    }
+
+                    for (size_t j = 0; j < numMessages; ++j) {
+                        uint64_t begin = AGT::TscClock::GetTicks();
+                        shape.fWrite(*logger, j);
+                        threadLatencies[j] = AGT::TscClock::GetTicks() - begin;
+                    }
+                });
+            }
+
+            while (numReady.load() < numThreads) {
+                std::this_thread::yield();
+            }
+
+            auto begin = std::chrono::steady_clock::now();
+            start.store(true, std::memory_order_release);
+            for (auto& thread : threads) {
+                thread.join();
+            }
+            logger->Flush();
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        }
+
+        std::error_code error;
+        std::filesystem::remove(path, error);
+
+        std::vector<uint64_t> all;
+        all.reserve(numThreads * numMessages);
+        for (auto& threadLatencies : latencies) {
+            for (uint64_t ticks : threadLatencies) {
+                all.push_back(AGT::TscClock::TicksToDurationNs(ticks));
+            }
+        }
+        std::sort(all.begin(), all.end());
+
+        result.messagesPerSecond = static_cast<double>(all.size()) / std::max(seconds, 1e-9);
+        result.p50Ns = GetPercentile(all, 0.5);
+        result.p99Ns = GetPercentile(all, 0.99);
+        result.p999Ns = GetPercentile(all, 0.999);
+        result.maxNs = all.back();
+        return true;
+    }
+
+    bool ParseOptions(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+                options.maxThreads = std::max(strtoull(argv[++i], nullptr, 10), 1ull);
+            } else if (!strcmp(argv[i], "--messages") && i + 1 < argc) {
+                options.numMessages = std::max(strtoull(argv[++i], nullptr, 10), 1ull);
+            } else if (!strcmp(argv[i], "--quick")) {
+                options.quick = true;
+            } else {
+                printf("Usage: %s [--threads N] [--messages N] [--quick]\n", argv[0]);
+                printf("  --threads   largest producer thread count, runs 1, 2, 4... up to it (default: hardware threads)\n");
+                printf("  --messages  messages per thread and run (default: 100000)\n");
+                printf("  --quick     smoke run with few messages and at most 2 threads\n");
+                return false;
+            }
+        }
+
+        if (options.quick) {
+            options.maxThreads = std::min<size_t>(options.maxThreads, 2);
+            options.numMessages = std::min<size_t>(options.numMessages, 2000);
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    AGT::TscClock::Init();
+
+    std::vector<size_t> threadCounts;
+    for (size_t numThreads = 1; numThreads < options.maxThreads; numThreads *= 2) {
+        threadCounts.push_back(numThreads);
+    }
+    threadCounts.push_back(options.maxThreads);
+
+    printf("%zu messages per thread, TSC %s\n\n", options.numMessages, AGT::TscClock::IsUsingTsc() ? "on" : "off");
+    printf("%-6s %-16s %-8s %7s %14s %9s %9s %9s %11s\n", "mode", "sink", "message", "threads", "msgs/s", "p50 ns", "p99 ns", "p99.9 ns", "max ns");
+
+    int exitCode = 0;
+    for (bool async : { false, true }) {
+        for (const SinkConfig& sink : SINKS) {
+            for (const MessageShape& shape : SHAPES) {
+                for (size_t numThreads : threadCounts) {
+                    Result result;
+                    if (!Run(async, sink, shape, numThreads, options.numMessages, result)) {
+                        printf("%-6s %-16s %-8s %7zu failed to create the logger\n", async ? "async" : "sync", sink.name, shape.name, numThreads);
+                        exitCode = 1;
+                        continue;
+                    }
+
+                    printf("%-6s %-16s %-8s %7zu %14.0f %9llu %9llu %9llu %11llu\n",
+                        async ? "async" : "sync", sink.name, shape.name, numThreads, result.messagesPerSecond,
+                        static_cast<unsigned long long>(result.p50Ns),
+                        static_cast<unsigned long long>(result.p99Ns),
+                        static_cast<unsigned long long>(result.p999Ns),
+                        static_cast<unsigned long long>(result.maxNs));
+                    fflush(stdout);
+                }
+            }
+        }
+    }
+
+    return exitCode;
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#include "pch.h"
+
+#include "AGT/compression/LzCodec.h"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+static std::vector<char> RoundTrip(AGT::LzCodec& codec, const std::vector<char>& input, size_t& compressedSize) {
+    std::vector<char> compressed(AGT::LzCodec::GetMaxCompressedSize(input.size()));
+    compressedSize = codec.Compress(input, compressed);
+    EXPECT_GT(compressedSize, 0u);
+
+    std::vector<char> output(input.size());
+    EXPECT_TRUE(AGT::LzCodec::Decompress({ compressed.data(), compressedSize }, output));
+    return output;
+}
+
+TEST(LzCodec, RoundTrip) {
+    AGT::LzCodec codec;
+    std::mt19937 random(1234);
+    size_t compressedSize = 0;
+
+    std::vector<std::vector<char>> inputs;
+    inputs.push_back({});
+    inputs.push_back({ 'a', 'b', 'c' });
+    inputs.push_back(std::vector<char>(100000, 'x'));
+
+    std::vector<char> noise(70000);
+    for (char& c : noise) {
+        c = static_cast<char>(random());
+    }
+    inputs.push_back(noise);
+
+    std::string text;
+    for (int i = 0; i < 2000; ++i) {
+        text += "[17000000001234" + std::to_string(random() % 100000) + "][InfoV3][pid=4242][tid=140211]";
+        text += "[Renderer.cpp | DrawFrame() | 214]\nFrame " + std::to_string(i) + " took " + std::to_string(random() % 20) + " ms\n\n";
+    }
+    inputs.push_back({ text.begin(), text.end() });
+
+    for (auto& input : inputs) {
+        EXPECT_EQ(input, RoundTrip(codec, input, compressedSize));
+        EXPECT_LE(compressedSize, AGT::LzCodec::GetMaxCompressedSize(input.size()));
+    }
+
+    RoundTrip(codec, inputs[2], compressedSize);
+    EXPECT_LT(compressedSize, 1000u);
+
+    RoundTrip(codec, inputs[4], compressedSize);
+    EXPECT_LT(compressedSize * 5, inputs[4].size());
+}
+
+TEST(LzCodec, InvalidInput) {
+    AGT::LzCodec codec;
+    std::string text;
+    for (int i = 0; i < 200; ++i) {
+        text += "Entry number " + std::to_string(i) + " of the invalid input test\n";
+    }
+    std::vector<char> input(text.begin(), text.end());
+
+    std::vector<char> tooSmall(input.size() / 10);
+    EXPECT_EQ(0u, codec.Compress(input, tooSmall));
+
+    std::vector<char> compressed(AGT::LzCodec::GetMaxCompressedSize(input.size()));
+    compressed.resize(codec.Compress(input, compressed));
+
+    std::vector<char> output(input.size());
+    EXPECT_FALSE(AGT::LzCodec::Decompress({ compressed.data(), compressed.size() / 2 }, output));
+
+    std::vector<char> wrongSize(input.size() - 1);
+    EXPECT_FALSE(AGT::LzCodec::Decompress(compressed, wrongSize));
+
+    //corrupted data must never be read or written out of bounds
+    std::mt19937 random(42);
+    for (int i = 0; i < 1000; ++i) {
+        std::vector<char> corrupted = compressed;
+        corrupted[random() % corrupted.size()] = static_cast<char>(random());
+        AGT::LzCodec::Decompress(corrupted, output);
+    }
+}
@@ -1,7 +1,51 @@
 #include "pch.h"
 
 #include "AGT/error/CrashHandler.h"
+#include "AGT/log/DefaultLogFormatter.h"
+#include "AGT/log/FlightRecorderReader.h"
+
+#include <csignal>
+#include <filesystem>
+#include <string>
 
 TEST(CrashHandler, Init) {
     AGT::CrashHandler::Init(AGT::MinidumpSize::Small, "coredump.dmp", []() {});
+}
+
+struct RecoveredSink : public AGT::ILoggerSink {
+    void Write(const char* msg, size_t size) override {
+        Text.append(msg, size);
+    }
+
+    std::string Text;
+};
+
+TEST(CrashHandler, FlightRecorder) {
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "agt_crash_recorder.bin";
+
+    EXPECT_EXIT({
+        auto recorder = AGT::FlightRecorder::Create(path, 64);
+        AGT::FlightRecorder::SetActive(recorder.get());
+        AGT::CrashHandler::Init(AGT::MinidumpSize::None, nullptr, []() {});
+
+        for (int i = 0; i < 10; ++i) {
+            AGT_DEBUG("frame %i", i);
+        }
+        raise(SIGSEGV);
+    }, testing::KilledBySignal(SIGSEGV), "Fatal signal " + std::to_string(SIGSEGV));
+
+    auto reader = AGT::FlightRecorderReader<AGT::DefaultLogFormatter>::Open(path);
+    ASSERT_TRUE(reader);
+    EXPECT_EQ(AGT::FlightRecorderState::Crashed, reader->GetState());
+    EXPECT_EQ(SIGSEGV, reader->GetCrashSignal());
+
+    RecoveredSink sink;
+    reader->Read(sink);
+    EXPECT_NE(std::string::npos, sink.Text.find("frame 9"));
+
+    //the signal handler doesn't log, the logger's locks may be held by the crashed thread
+    EXPECT_EQ(std::string::npos, sink.Text.find("Fatal signal"));
+
+    reader.reset();
+    std::filesystem::remove(path);
 }
\ No newline at end of file
@@ -1,15 +1,45 @@
 #include "pch.h"
 
+#include "AGT/log/BinaryLogReader.h"
+#include "AGT/log/CompressedLogReader.h"
 #include "AGT/log/DefaultLogger.h"
 #include "AGT/log/DefaultLogFormatter.h"
+#include "AGT/log/DeferredLogger.h"
+#include "AGT/log/FlightRecorder.h"
+#include "AGT/log/FlightRecorderReader.h"
 #include "AGT/log/ILoggerSink.h"
+#include "AGT/log/JsonLogFormatter.h"
 #include "AGT/log/Log.h"
+#include "AGT/log/LogCategory.h"
+#include "AGT/log/LogCollector.h"
 #include "AGT/log/LogEntryBuilder.h"
+#include "AGT/log/LogQueueWorker.h"
+#include "AGT/log/LogSegmentPool.h"
+#include "AGT/log/LogSite.h"
+#include "AGT/log/LoggerCompressedFileSink.h"
+#include "AGT/log/LoggerConsoleSink.h"
+#include "AGT/log/LoggerFileSink.h"
+#include "AGT/log/LoggerMappedFileSink.h"
+#include "AGT/log/LoggerSocketSink.h"
+#include "AGT/thread/ThreadInfo.h"
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
 #include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
 
 TEST(Logger, EntryBuilder) {
     std::vector<char> data(100);
@@ -86,6 +116,152 @@ TEST(Logger, EntryBuilder) {
     }
 }
 
+TEST(Logger, EntryBuilderSpill) {
+    std::vector<char> data(32);
+    auto pool = AGT::LogSegmentPool::Create(16, 64);
+    ASSERT_TRUE(pool);
+
+    auto fJoin = [&data](AGT::LogEntryBuilder& builder) {
+        std::string joined(data.data(), builder.GetInlineSize());
+        for (const AGT::LogSegment* segment = builder.GetSpilled(); segment; segment = segment->next) {
+            EXPECT_EQ('\0', segment->data[segment->size]);
+            joined.append(segment->data, segment->size);
+        }
+        return joined;
+    };
+
+    const std::string longString(300, 'x');
+
+    {
+        //entries that fit don't touch the pool
+        AGT::LogEntryBuilder builder(data, pool.get());
+        builder.WriteLine("short %i", 1);
+        EXPECT_EQ(nullptr, builder.GetSpilled());
+        EXPECT_EQ("short 1\n", std::string(data.data()));
+    }
+
+    {
+        AGT::LogEntryBuilder builder(data, pool.get());
+        builder.Write("begin ");
+        builder.Append(std::string_view(longString));
+        builder.Append(123456789);
+        builder.EndLine(true);
+        std::string expected = "begin " + longString + "123456789\n";
+        EXPECT_EQ(expected, fJoin(builder));
+        EXPECT_EQ(expected.size(), builder.GetSizeWritten());
+    }
+
+    {
+        //printf formats that don't fit are expanded one conversion at a time
+        AGT::LogEntryBuilder builder(data, pool.get());
+        builder.WriteLine("[%s] %d%% %*d|%-6.2f|%c", longString.c_str(), 42, 5, 7, 1.5, 'z');
+        std::string expected = "[" + longString + "] 42%     7|1.50  |z\n";
+        EXPECT_EQ(expected, fJoin(builder));
+        EXPECT_EQ(expected.size(), builder.GetSizeWritten());
+    }
+
+    {
+        //segments that are taken belong to the caller
+        AGT::LogEntryBuilder builder(data, pool.get());
+        builder.Write(longString.c_str());
+        AGT::LogSegment* spilled = builder.TakeSpilled();
+        ASSERT_NE(nullptr, spilled);
+        EXPECT_EQ(nullptr, builder.GetSpilled());
+        EXPECT_EQ(data.size() - 1, builder.GetInlineSize());
+        pool->Release(spilled);
+    }
+
+    //every segment was returned
+    std::vector<AGT::LogSegment*> segments;
+    while (AGT::LogSegment* segment = pool->TryAcquire()) {
+        segments.push_back(segment);
+    }
+    EXPECT_EQ(64u, segments.size());
+    for (AGT::LogSegment* segment : segments) {
+        pool->Release(segment);
+    }
+
+    {
+        //when they run out the entry is truncated
+        uint64_t numExhausted = pool->GetExhaustedCount();
+        AGT::LogEntryBuilder builder(data, pool.get());
+        builder.WriteLine(std::string(2000, 'y').c_str());
+        EXPECT_EQ(numExhausted + 1, pool->GetExhaustedCount());
+        EXPECT_LT(builder.GetSizeWritten(), 2000u);
+        EXPECT_EQ('\n', fJoin(builder).back());
+    }
+}
+
+TEST(Logger, EntryBuilderAppend) {
+    std::vector<char> data(100);
+
+    {
+        AGT::LogEntryBuilder builder(data);
+        builder.Append(std::numeric_limits<int64_t>::min());
+        builder.Append(' ');
+        builder.Append(std::numeric_limits<uint64_t>::max());
+        builder.Append(' ');
+        builder.Append(0.1);
+        builder.Append(' ');
+        builder.Append(3.14159, 2);
+        builder.Append(' ');
+        builder.AppendHex(0xBEEFu);
+        builder.Append(' ');
+        builder.Append(true);
+        builder.Append(' ');
+        builder.Append(std::string_view("view"));
+
+        std::string expected{ "-9223372036854775808 18446744073709551615 0.1 3.14 beef true view" };
+        EXPECT_EQ(expected, std::string(data.data()));
+        EXPECT_EQ(expected.size(), builder.GetSizeWritten());
+    }
+
+    {
+        int value = 0;
+        AGT::LogEntryBuilder builder(data);
+        builder.Append(&value);
+
+        char expected[32];
+        snprintf(expected, sizeof(expected), "0x%llx", static_cast<unsigned long long>(reinterpret_cast<uintptr_t>(&value)));
+        EXPECT_EQ(std::string(expected), std::string(data.data()));
+    }
+
+    {
+        AGT::LogEntryBuilder builder(data);
+        builder.Format("frame={} id={:x} ms={:.3} name={} {{literal}}", 42, 255u, 16.6666, "Render");
+        builder.EndLine();
+
+        std::string expected{ "frame=42 id=ff ms=16.667 name=Render {literal}\n" };
+        EXPECT_EQ(expected, std::string(data.data()));
+        EXPECT_EQ(expected.size(), builder.GetSizeWritten());
+    }
+
+    //appended values are truncated the same way as formatted ones
+    {
+        std::string longString(150, 'a');
+
+        AGT::LogEntryBuilder builder(data);
+        builder.Append(std::string_view("ab"));
+        builder.Append(longString.c_str());
+        builder.Append(12345);
+        builder.EndLine(true);
+        builder.EndLine();
+
+        EXPECT_EQ("ab" + std::string(data.size() - 4, 'a') + "\n", std::string(data.data()));
+        EXPECT_EQ(data.size(), builder.GetSizeWritten());
+    }
+
+    {
+        std::vector<char> small(8);
+        AGT::LogEntryBuilder builder(small);
+        builder.Append(1234567);
+        builder.Append(123456789);
+
+        EXPECT_EQ("1234567", std::string(small.data()));
+        EXPECT_EQ(small.size(), builder.GetSizeWritten());
+    }
+}
+
 TEST(Logger, DefaultLogFormatter) {
     std::vector<char> data(200);
 
@@ -94,7 +270,7 @@ TEST(Logger, DefaultLogFormatter) {
         const char* funcName = __func__;
         int lineNumber = __LINE__;
         std::string msgFormat{ "This is a test error: %i" };
-        int pid = _getpid();
+        int pid = AGT::ThreadInfo::GetProcessId();
         size_t threadId = std::hash<std::thread::id>{}(std::this_thread::get_id());
         
         AGT::LogEntryBuilder builder(data);
@@ -113,6 +289,26 @@ TEST(Logger, DefaultLogFormatter) {
     }
 }
 
+TEST(Logger, LogSite) {
+    static_assert(std::string_view(AGT::GetLogFileName("C:\\src\\game\\Render.cpp")) == "Render.cpp");
+    static_assert(std::string_view(AGT::GetLogFileName("/src/game/Render.cpp")) == "Render.cpp");
+    static_assert(std::string_view(AGT::GetLogFileName("Render.cpp")) == "Render.cpp");
+
+    AGT::LogSite site(AGT::LogLevel::Warning, "Render.cpp", "Draw", 42);
+    EXPECT_EQ("[Render.cpp | Draw() | 42]", site.GetPrefix());
+
+    std::vector<char> data(200);
+    AGT::LogEntryBuilder builder(data);
+    AGT::DefaultLogFormatter formatter;
+    formatter.Format(builder, site, "frame %i", 7);
+
+    std::string result{ data.data() };
+    EXPECT_TRUE(result.find(AGT::LogLevelToString(AGT::LogLevel::Warning)) != std::string::npos);
+    EXPECT_TRUE(result.find("[Render.cpp | Draw() | 42]\n") != std::string::npos);
+    EXPECT_TRUE(result.find("frame 7\n") != std::string::npos);
+    EXPECT_EQ(result.size(), builder.GetSizeWritten());
+}
+
 struct MockSink : public AGT::ILoggerSink {
     void Write(const char* msg, size_t size) override {
         Message = msg;
@@ -164,4 +360,1342 @@ TEST(Logger, DefaultLogger) {
         EXPECT_TRUE(sink1->Message.empty());
         EXPECT_TRUE(sink2->Message.empty());
     }
+}
+
+static int s_numEvaluations = 0;
+static int CountEvaluation() {
+    return ++s_numEvaluations;
+}
+
+TEST(Logger, FileSink) {
+    auto path = std::filesystem::temp_directory_path() / "agt_file_sink.log";
+    auto readFile = [](const std::filesystem::path& filePath) {
+        std::ifstream file(filePath, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    };
+
+    for (size_t bufferSize : { 1, 16, 4096 }) {
+        std::string expected;
+        {
+            auto sink = AGT::LoggerFileSink::Create(path.string().c_str(), bufferSize);
+            ASSERT_TRUE(sink);
+
+            std::string first{ "First %s\n" };
+            sink->Write(first.data(), first.size());
+            expected += first;
+
+            std::vector<std::string> lines;
+            for (int i = 0; i < 50; ++i) {
+                lines.push_back("Batched entry " + std::to_string(i) + "\n");
+                expected += lines.back();
+            }
+
+            std::vector<AGT::IoBuffer> entries;
+            for (auto& line : lines) {
+                entries.push_back({ line.data(), line.size() });
+            }
+            sink->WriteBatch(entries);
+
+            sink->Write("Last\n", 5);
+            expected += "Last\n";
+            sink->Flush();
+
+            EXPECT_EQ(expected, readFile(path));
+        }
+        EXPECT_EQ(expected, readFile(path));
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST(Logger, ConsoleSink) {
+    AGT::LoggerConsoleSink sink;
+    std::string first{ "Progress 100%s done\n" };
+    std::string second{ "Second\n" };
+    std::array<AGT::IoBuffer, 2> entries = { AGT::IoBuffer{ first.data(), first.size() }, AGT::IoBuffer{ second.data(), second.size() } };
+
+    testing::internal::CaptureStdout();
+    sink.Write(first.data(), first.size());
+    sink.WriteBatch(entries);
+    EXPECT_EQ(first + first + second, testing::internal::GetCapturedStdout());
+}
+
+TEST(Logger, MappedFileSink) {
+    auto directory = std::filesystem::temp_directory_path() / "agt_mapped_file_sink";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    auto path = directory / "game.log";
+
+    auto readFile = [](const std::filesystem::path& filePath) {
+        std::ifstream file(filePath, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    };
+
+    constexpr size_t SEGMENT_SIZE = 4096;
+    constexpr size_t NUM_RETAINED_FILES = 2;
+    std::string expected;
+    {
+        auto sink = AGT::LoggerMappedFileSink::Create(path.string().c_str(), SEGMENT_SIZE, NUM_RETAINED_FILES);
+        ASSERT_TRUE(sink);
+
+        for (int i = 0; i < 100; ++i) {
+            std::string line = "Entry " + std::to_string(i) + " " + std::string(90, '-') + "\n";
+            sink->Write(line.data(), line.size());
+            expected += line;
+        }
+        sink->Flush();
+    }
+
+    EXPECT_FALSE(std::filesystem::exists(AGT::LoggerMappedFileSink::GetSegmentPath(path, NUM_RETAINED_FILES + 1)));
+    EXPECT_FALSE(std::filesystem::exists(AGT::LoggerMappedFileSink::GetPreparedSegmentPath(path)));
+
+    //segments are cut to the used size and only contain whole entries
+    std::string contents;
+    for (size_t i = NUM_RETAINED_FILES + 1; i > 0; --i) {
+        auto segmentPath = AGT::LoggerMappedFileSink::GetSegmentPath(path, i - 1);
+        ASSERT_TRUE(std::filesystem::exists(segmentPath));
+
+        std::string segment = readFile(segmentPath);
+        EXPECT_LE(segment.size(), SEGMENT_SIZE);
+        EXPECT_EQ('\n', segment.back());
+        EXPECT_TRUE(segment.starts_with("Entry "));
+        contents += segment;
+    }
+
+    ASSERT_LE(contents.size(), expected.size());
+    EXPECT_EQ(expected.substr(expected.size() - contents.size()), contents);
+    EXPECT_EQ(directory / "game.1.log", AGT::LoggerMappedFileSink::GetSegmentPath(path, 1));
+
+    //the log of a previous run is kept as the first rotated segment
+    std::string previousRun = readFile(path);
+    {
+        auto sink = AGT::LoggerMappedFileSink::Create(path.string().c_str(), SEGMENT_SIZE, NUM_RETAINED_FILES);
+        ASSERT_TRUE(sink);
+        sink->Write("New run\n", 8);
+    }
+    EXPECT_EQ("New run\n", readFile(path));
+    EXPECT_EQ(previousRun, readFile(AGT::LoggerMappedFileSink::GetSegmentPath(path, 1)));
+
+    //a run that stopped mid rotation has its newest entries in the prepared segment, they come after the active one
+    {
+        std::ofstream prepared(AGT::LoggerMappedFileSink::GetPreparedSegmentPath(path), std::ios::binary);
+        prepared << "Interrupted\n" << std::string(100, '\0');
+    }
+    {
+        auto sink = AGT::LoggerMappedFileSink::Create(path.string().c_str(), SEGMENT_SIZE, NUM_RETAINED_FILES);
+        ASSERT_TRUE(sink);
+        sink->Write("Recovered\n", 10);
+    }
+    EXPECT_EQ("Recovered\n", readFile(path));
+    EXPECT_TRUE(readFile(AGT::LoggerMappedFileSink::GetSegmentPath(path, 1)).starts_with("Interrupted\n"));
+    EXPECT_EQ("New run\n", readFile(AGT::LoggerMappedFileSink::GetSegmentPath(path, 2)));
+    EXPECT_FALSE(std::filesystem::exists(AGT::LoggerMappedFileSink::GetPreparedSegmentPath(path)));
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(Logger, CompressedFileSink) {
+    auto path = std::filesystem::temp_directory_path() / "agt_compressed_sink.agtz";
+
+    std::string expected;
+    size_t numEntries = 5000;
+    {
+        auto sink = AGT::LoggerCompressedFileSink::Create(path.string().c_str(), 16 * 1024, 2);
+        ASSERT_TRUE(sink);
+
+        std::vector<char> line(256);
+        for (size_t i = 0; i < numEntries; ++i) {
+            AGT::LogEntryBuilder builder(line);
+            AGT::DefaultLogFormatter formatter;
+            formatter.Format(builder, AGT::LogLevel::Debug, __FILE__, __func__, __LINE__, "Frame %zu took %zu us", i, (i * 7919) % 20000);
+
+            sink->Write(line.data(), builder.GetSizeWritten());
+            expected.append(line.data(), builder.GetSizeWritten());
+        }
+    }
+
+    EXPECT_LT(std::filesystem::file_size(path) * 5, expected.size());
+
+    auto reader = AGT::CompressedLogReader::Open(path);
+    ASSERT_TRUE(reader);
+    ASSERT_GT(reader->GetNumBlocks(), 1u);
+
+    std::string contents;
+    size_t numEntriesRead = 0;
+    std::vector<char> block;
+    for (size_t i = 0; i < reader->GetNumBlocks(); ++i) {
+        ASSERT_TRUE(reader->ReadBlock(i, block));
+        contents.append(block.data(), block.size());
+        numEntriesRead += reader->GetBlock(i).header.numEntries;
+        EXPECT_LE(reader->GetBlock(i).header.firstTimestampNs, reader->GetBlock(i).header.lastTimestampNs);
+    }
+    EXPECT_EQ(expected, contents);
+    EXPECT_EQ(numEntries, numEntriesRead);
+
+    //seek straight to a block
+    size_t lastBlock = reader->GetNumBlocks() - 1;
+    EXPECT_EQ(0u, reader->FindBlock(0));
+    EXPECT_EQ(lastBlock, reader->FindBlock(reader->GetBlock(lastBlock).header.lastTimestampNs));
+    EXPECT_EQ(reader->GetNumBlocks(), reader->FindBlock(reader->GetBlock(lastBlock).header.lastTimestampNs + 1));
+    ASSERT_TRUE(reader->ReadBlock(lastBlock, block));
+    EXPECT_TRUE(expected.ends_with(std::string(block.data(), block.size())));
+
+    reader.reset();
+    std::filesystem::remove(path);
+}
+
+TEST(Logger, LevelFiltering) {
+    static_assert(AGT_MAX_LOG_LEVEL == AGT_LOG_LEVEL_DEBUG, "Tests are built with AGT_ENABLE_DEBUG_LOG");
+
+    auto sink = std::make_shared<MockSink>();
+    std::array<std::shared_ptr<AGT::ILoggerSink>, 1> sinks = { sink };
+
+    auto defaultLogger = std::shared_ptr<AGT::LoggerT>(AGT::LoggerT::Create(AGT::LogLevel::Warning, 1024, sinks));
+    AGT::StaticHolder<AGT::LoggerT>::Set(defaultLogger);
+
+    s_numEvaluations = 0;
+    for (int i = 0; i < 100; ++i) {
+        AGT_VERBOSE("value %i", CountEvaluation());
+        AGT_DEBUG("value %i", CountEvaluation());
+    }
+    EXPECT_EQ(0, s_numEvaluations);
+    EXPECT_TRUE(sink->Message.empty());
+
+    AGT_WARN("value %i", CountEvaluation());
+    EXPECT_EQ(1, s_numEvaluations);
+    EXPECT_TRUE(sink->Message.find("value 1") != std::string::npos);
+
+    defaultLogger->SetMaxLevel(AGT::LogLevel::InfoV2);
+    AGT_INFO_V2("value %i", CountEvaluation());
+    EXPECT_EQ(2, s_numEvaluations);
+    EXPECT_TRUE(sink->Message.find(AGT::LogLevelToString(AGT::LogLevel::InfoV2)) != std::string::npos);
+
+    AGT_ERR("no arguments");
+    EXPECT_TRUE(sink->Message.find("no arguments") != std::string::npos);
+
+    AGT::StaticHolder<AGT::LoggerT>::Set(nullptr);
+    AGT_ERR("value %i", CountEvaluation());
+    EXPECT_EQ(2, s_numEvaluations);
+}
+
+struct MessageListSink : public AGT::ILoggerSink {
+    void Write(const char* msg, size_t size) override {
+        Messages.emplace_back(msg, size);
+    };
+
+    void WriteScattered(std::span<const AGT::IoBuffer> parts) override {
+        std::string& msg = Messages.emplace_back();
+        for (const AGT::IoBuffer& part : parts) {
+            msg.append(static_cast<const char*>(part.data), part.size);
+        }
+        ++NumScattered;
+    }
+
+    size_t CountContaining(std::string_view text) const {
+        return std::count_if(Messages.begin(), Messages.end(), [text](const std::string& msg) {
+            return msg.find(text) != std::string::npos;
+        });
+    }
+
+    std::vector<std::string> Messages;
+    size_t NumScattered{ 0 };
+};
+
+TEST(Logger, Throttling) {
+    auto sink = std::make_shared<MessageListSink>();
+    std::array<std::shared_ptr<AGT::ILoggerSink>, 1> sinks = { sink };
+
+    auto defaultLogger = std::shared_ptr<AGT::LoggerT>(AGT::LoggerT::Create(AGT::LogLevel::InfoV1, 1024, sinks));
+    AGT::StaticHolder<AGT::LoggerT>::Set(defaultLogger);
+
+    //suppressed calls don't evaluate their arguments
+    s_numEvaluations = 0;
+    for (int i = 0; i < 10; ++i) {
+        AGT_WARN_EVERY_N(4, "every %i", CountEvaluation());
+    }
+    EXPECT_EQ(3, s_numEvaluations);
+    EXPECT_EQ(3u, sink->CountContaining("every"));
+    EXPECT_EQ(2u, sink->CountContaining("Suppressed 3 messages"));
+
+    sink->Messages.clear();
+    for (int i = 0; i < 10; ++i) {
+        AGT_ERR_FIRST_N(2, "first %i", i);
+    }
+    EXPECT_EQ(2u, sink->CountContaining("first"));
+    EXPECT_EQ(0u, sink->CountContaining("Suppressed"));
+
+    //quiet sites are reported on demand, each suppressed call only once
+    AGT_LOG_SUPPRESSED_SUMMARY();
+    EXPECT_EQ(1u, sink->CountContaining("Suppressed 8 messages"));
+    EXPECT_EQ(1u, sink->CountContaining("Suppressed 1 messages"));
+    sink->Messages.clear();
+    AGT_LOG_SUPPRESSED_SUMMARY();
+    EXPECT_TRUE(sink->Messages.empty());
+
+    for (int i = 0; i < 100; ++i) {
+        AGT_INFO_RATE(5, "rate %i", i);
+    }
+    EXPECT_EQ(5u, sink->CountContaining("rate"));
+
+    //disabled levels don't touch the throttle
+    for (int i = 0; i < 10; ++i) {
+        AGT_DEBUG_FIRST_N(1, "debug %i", i);
+    }
+    defaultLogger->SetMaxLevel(AGT::LogLevel::Debug);
+    AGT_DEBUG_FIRST_N(1, "debug");
+    EXPECT_EQ(1u, sink->CountContaining("debug"));
+
+    AGT::StaticHolder<AGT::LoggerT>::Set(nullptr);
+}
+
+AGT::LogCategory g_logNet("net");
+AGT::LogCategory g_logReplication("net.replication");
+AGT::LogCategory g_logNetwork("network");
+
+TEST(Logger, Categories) {
+    auto sink = std::make_shared<MessageListSink>();
+    std::array<std::shared_ptr<AGT::ILoggerSink>, 1> sinks = { sink };
+
+    auto defaultLogger = std::shared_ptr<AGT::LoggerT>(AGT::LoggerT::Create(AGT::LogLevel::InfoV1, 1024, sinks));
+    AGT::StaticHolder<AGT::LoggerT>::Set(defaultLogger);
+
+    auto fLogAll = []() {
+        AGT_DEBUG_CAT(g_logNet, "net debug");
+        AGT_WARN_CAT(g_logNet, "net warning");
+        AGT_DEBUG_CAT(g_logReplication, "replication debug");
+        AGT_WARN_CAT(g_logReplication, "replication warning");
+        AGT_DEBUG_CAT(g_logNetwork, "network debug");
+        AGT_WARN_CAT(g_logNetwork, "network warning");
+    };
+
+    //without levels the categories follow the logger
+    fLogAll();
+    EXPECT_EQ(3u, sink->Messages.size());
+    EXPECT_EQ(0u, sink->CountContaining("debug"));
+    EXPECT_EQ(1u, sink->CountContaining("][net.replication]"));
+
+    //a level applies to the descendants, but not to names that only share the prefix
+    sink->Messages.clear();
+    AGT::LogCategory::SetLevel("net", AGT::LogLevel::Debug);
+    fLogAll();
+    EXPECT_EQ(1u, sink->CountContaining("net debug"));
+    EXPECT_EQ(1u, sink->CountContaining("replication debug"));
+    EXPECT_EQ(0u, sink->CountContaining("network debug"));
+
+    //the most specific name wins, "*" covers everything else
+    sink->Messages.clear();
+    std::string error;
+    EXPECT_TRUE(AGT::LogCategory::ApplyConfig("# comment\n\n * = Error\nnet.replication=debug\r\nnet = DEFAULT\n", &error));
+    fLogAll();
+    EXPECT_EQ(2u, sink->Messages.size());
+    EXPECT_EQ(1u, sink->CountContaining("replication debug"));
+    EXPECT_EQ(1u, sink->CountContaining("replication warning"));
+
+    EXPECT_FALSE(AGT::LogCategory::ApplyConfig("net=Debug\nnet=Loud", &error));
+    EXPECT_EQ("line 2: unknown level", error);
+    EXPECT_FALSE(AGT::LogCategory::ApplyConfig("Debug", &error));
+    EXPECT_EQ("line 1: expected name=level", error);
+
+    //config files use the same format
+    const std::string path = (std::filesystem::temp_directory_path() / "agt_log_categories.cfg").string();
+    {
+        std::ofstream file(path);
+        file << "*=Warning\nnetwork=3\n";
+    }
+    EXPECT_TRUE(AGT::LogCategory::LoadConfigFile(path.c_str()));
+    EXPECT_FALSE(AGT::LogCategory::LoadConfigFile((path + ".missing").c_str(), &error));
+    std::filesystem::remove(path);
+
+    AGT::LogLevel level;
+    EXPECT_TRUE(g_logNetwork.GetLevel(level));
+    EXPECT_EQ(AGT::LogLevel::InfoV2, level);
+    EXPECT_TRUE(g_logReplication.GetLevel(level));
+    EXPECT_EQ(AGT::LogLevel::Debug, level);
+
+    //categories registered later pick up the existing levels
+    {
+        AGT::LogCategory lateCategory("network.dns");
+        EXPECT_TRUE(lateCategory.GetLevel(level));
+        EXPECT_EQ(AGT::LogLevel::InfoV2, level);
+
+        size_t numFound = 0;
+        AGT::LogCategory::ForEach([&numFound](const AGT::LogCategory& category) {
+            numFound += std::string_view(category.GetName()).starts_with("net") ? 1 : 0;
+        });
+        EXPECT_EQ(4u, numFound);
+    }
+
+    //sink levels still apply
+    sink->Messages.clear();
+    defaultLogger->SetSinkMaxLevel(0, AGT::LogLevel::Warning);
+    fLogAll();
+    EXPECT_EQ(0u, sink->CountContaining("debug"));
+
+    AGT::LogCategory::ResetAllLevels();
+    EXPECT_FALSE(g_logReplication.GetLevel(level));
+    AGT::StaticHolder<AGT::LoggerT>::Set(nullptr);
+}
+
+TEST(Logger, Coalescing) {
+    using LoggerT = AGT::DefaultLogger<AGT::DefaultLogFormatter>;
+
+    auto fWriteRun = [](LoggerT& logger) {
+        for (int i = 0; i < 5; ++i) {
+            logger.Write(AGT::LogLevel::Warning, __FILE__, __func__, __LINE__, "disk full");
+        }
+        for (int i = 0; i < 4; ++i) {
+            logger.Write(AGT::LogLevel::Warning, __FILE__, __func__, __LINE__, "disk ok");
+        }
+    };
+
+    for (bool async : { false, true }) {
+        auto sink = std::make_shared<MessageListSink>();
+        std::array<std::shared_ptr<AGT::ILoggerSink>, 1> sinks = { sink };
+
+        auto logger = async ?
+            LoggerT::CreateAsync(AGT::LogLevel::Debug, 256, sinks, AGT::LoggerAsyncConfig{}) :
+            LoggerT::Create(AGT::LogLevel::Debug, 256, sinks);
+        ASSERT_TRUE(logger);
+
+        logger->SetCoalescingWindow(std::chrono::seconds(60));
+        fWriteRun(*logger);
+        logger->Flush();
+
+        ASSERT_EQ(4u, sink->Messages.size()) << async;
+        EXPECT_NE(std::string::npos, sink->Messages[0].find("disk full"));
+        EXPECT_NE(std::string::npos, sink->Messages[1].find("Previous message repeated 4 times"));
+        EXPECT_NE(std::string::npos, sink->Messages[2].find("disk ok"));
+        EXPECT_NE(std::string::npos, sink->Messages[3].find("Previous message repeated 3 times"));
+
+        //a run is cut at the window, so a stuck message still shows up periodically
+        sink->Messages.clear();
+        logger->SetCoalescingWindow(std::chrono::milliseconds(1));
+        for (int i = 0; i < 2; ++i) {
+            logger->Write(AGT::LogLevel::Warning, __FILE__, __func__, __LINE__, "disk ok");
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        logger->Flush();
+        EXPECT_EQ(2u, sink->CountContaining("disk ok"));
+
+        sink->Messages.clear();
+        logger->SetCoalescingWindow(std::chrono::nanoseconds(0));
+        fWriteRun(*logger);
+        logger->Flush();
+        EXPECT_EQ(9u, sink->Messages.size());
+        EXPECT_EQ(0u, sink->CountContaining("repeated"));
+    }
+}
+
+TEST(Logger, FlightRecorder) {
+    static_assert(AGT::FlightRecorderFormat::MAX_ARGS_SIZE < 100, "The long string below must not fit");
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "agt_flight_recorder.bin";
+
+    auto sink = std::make_shared<MessageListSink>();
+    std::array<std::shared_ptr<AGT::ILoggerSink>, 1> sinks = { sink };
+    auto defaultLogger = std::shared_ptr<AGT::LoggerT>(AGT::LoggerT::Create(AGT::LogLevel::Warning, 1024, sinks));
+    AGT::StaticHolder<AGT::LoggerT>::Set(defaultLogger);
+
+    {
+        auto recorder = AGT::FlightRecorder::Create(path, 16);
+        ASSERT_TRUE(recorder);
+        AGT::FlightRecorder::SetActive(recorder.get());
+
+        //disabled levels are recorded too, and arguments are evaluated once for both
+        s_numEvaluations = 0;
+        for (int i = 0; i < 40; ++i) {
+            AGT_DEBUG("debug %i %s", i, "text");
+        }
+        AGT_WARN("warning %i", CountEvaluation());
+        EXPECT_EQ(1, s_numEvaluations);
+        EXPECT_EQ(1u, sink->CountContaining("warning 1"));
+        EXPECT_EQ(0u, sink->CountContaining("debug"));
+
+        const std::string longText(300, 'x');
+        AGT_INFO("long %s %i", longText.c_str(), 7);
+        AGT_ERR("no arguments");
+
+        AGT::FlightRecorder::SetActive(nullptr);
+        AGT_ERR("not recorded");
+    }
+
+    auto reader = AGT::FlightRecorderReader<AGT::DefaultLogFormatter>::Open(path);
+    ASSERT_TRUE(reader);
+    EXPECT_EQ(AGT::FlightRecorderState::Closed, reader->GetState());
+    EXPECT_EQ(43u, reader->GetNumRecorded());
+    EXPECT_EQ(16u, reader->GetNumEntries());
+
+    MessageListSink recovered;
+    reader->Read(recovered);
+    ASSERT_EQ(16u, recovered.Messages.size());
+    EXPECT_NE(std::string::npos, recovered.Messages[0].find("debug 27 text"));
+    EXPECT_NE(std::string::npos, recovered.Messages[12].find("debug 39 text"));
+    EXPECT_NE(std::string::npos, recovered.Messages[12].find(AGT::LogLevelToString(AGT::LogLevel::Debug)));
+    EXPECT_NE(std::string::npos, recovered.Messages[13].find("warning 1"));
+    EXPECT_NE(std::string::npos, recovered.Messages[14].find("long xxx"));
+    EXPECT_NE(std::string::npos, recovered.Messages[14].find("x 7"));
+    EXPECT_LT(recovered.Messages[14].size(), 300u);
+    EXPECT_NE(std::string::npos, recovered.Messages[15].find("no arguments"));
+    EXPECT_EQ(0u, recovered.CountContaining("not recorded"));
+
+    AGT::StaticHolder<AGT::LoggerT>::Set(nullptr);
+    reader.reset();
+    std::filesystem::remove(path);
+}
+
+TEST(Logger, FlightRecorderThrottled) {
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "agt_flight_recorder_throttled.bin";
+
+    auto sink = std::make_shared<MessageListSink>();
+    std::array<std::shared_ptr<AGT::ILoggerSink>, 1> sinks = { sink };
+    auto defaultLogger = std::shared_ptr<AGT::LoggerT>(AGT::LoggerT::Create(AGT::LogLevel::Warning, 1024, sinks));
+    AGT::StaticHolder<AGT::LoggerT>::Set(defaultLogger);
+
+    {
+        auto recorder = AGT::FlightRecorder::Create(path, 64);
+        ASSERT_TRUE(recorder);
+        AGT::FlightRecorder::SetActive(recorder.get());
+
+        //the recorder gets the calls the throttle lets through and the summaries, also for a disabled level
+        for (int i = 0; i < 10; ++i) {
+            AGT_WARN_EVERY_N(4, "every %i", i);
+        }
+        for (int i = 0; i < 3; ++i) {
+            AGT_DEBUG_FIRST_N(1, "debug %i", i);
+        }
+        EXPECT_EQ(3u, sink->CountContaining("every"));
+        EXPECT_EQ(2u, sink->CountContaining("Suppressed 3 messages"));
+
+        //a hot throttled site doesn't flood the ring
+        for (int i = 0; i < 100000; ++i) {
+            AGT_WARN_EVERY_N(10000, "hot %i", i);
+        }
+        EXPECT_EQ(10u, sink->CountContaining("hot"));
+
+        AGT::FlightRecorder::SetActive(nullptr);
+    }
+
+    auto reader = AGT::FlightRecorderReader<AGT::DefaultLogFormatter>::Open(path);
+    ASSERT_TRUE(reader);
+
+    MessageListSink recovered;
+    reader->Read(recovered);
+    EXPECT_EQ(25u, recovered.Messages.size());
+    EXPECT_EQ(3u, recovered.CountContaining("every"));
+    EXPECT_EQ(2u, recovered.CountContaining("Suppressed 3 messages"));
+    EXPECT_EQ(1u, recovered.CountContaining("debug"));
+    EXPECT_EQ(10u, recovered.CountContaining("hot"));
+    EXPECT_EQ(9u, recovered.CountContaining("Suppressed 9999 messages"));
+
+    AGT::StaticHolder<AGT::LoggerT>::Set(nullptr);
+    reader.reset();
+    std::filesystem::remove(path);
+}
+
+struct CountingSink : public AGT::ILoggerSink {
+    void Write(const char* msg, size_t size) override {
+        while (Blocked.load()) {
+            std::this_thread::yield();
+        }
+
+        LastMessage.assign(msg, size);
+        ++Count;
+    };
+
+    void WriteBatch(std::span<const AGT::IoBuffer> entries) override {
+        AGT::ILoggerSink::WriteBatch(entries);
+        ++NumBatches;
+    }
+
+    std::atomic<bool> Blocked{ false };
+    std::string LastMessage;
+    size_t Count{ 0 };
+    size_t NumBatches{ 0 };
+};
+
+TEST(Logger, DefaultLoggerAsync) {
+    const size_t numThreads = 4;
+    const size_t numMessages = 1000;
+
+    {
+        auto sink = std::make_shared<CountingSink>();
+        std::array<std::shared_ptr<AGT::ILoggerSink>, 1> sinks = { sink };
+
+        AGT::LoggerAsyncConfig config;
+        config.queueSize = 64;
+        config.overflowPolicy = AGT::LogOverflowPolicy::Block;
+
+        auto logger = AGT::LoggerT::CreateAsync(AGT::LogLevel::Debug, 256, sinks, config);
+        ASSERT_TRUE(logger);
+
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < numThreads; ++i) {
+            threads.emplace_back([&logger, i]() {
+                for (size_t j = 0; j < numMessages; ++j) {
+                    logger->Write(AGT::LogLevel::InfoV1, __FILE__, __func__, __LINE__, "thread %zu message %zu", i, j);
+                }
+            });
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        logger->Flush();
+        EXPECT_EQ(numThreads * numMessages, sink->Count);
+        EXPECT_EQ(0, logger->GetDroppedCount());
+    }
+
+    //entries queued while the sink is busy are handed over in batches
+    {
+        auto sink = std::make_shared<CountingSink>();
+        std::array<std::shared_ptr<AGT::ILoggerSink>, 1> sinks = { sink };
+
+        AGT::LoggerAsyncConfig config;
+        config.queueSize = 256;
+
+        auto logger = AGT::LoggerT::CreateAsync(AGT::LogLevel::Debug, 256, sinks, config);
+        ASSERT_TRUE(logger);
+
+        sink->Blocked = true;
+        for (size_t i = 0; i < 200; ++i) {
+            logger->Write(AGT::LogLevel::InfoV1, __FILE__, __func__, __LINE__, "message %zu", i);
+        }
+        sink->Blocked = false;
+
+        logger->Flush();
+        EXPECT_EQ(200, sink->Count);
+        EXPECT_LE(sink->NumBatches, 10);
+        EXPECT_NE(std::string::npos, sink->LastMessage.find("message 199"));
+    }
+
+    {
+        auto sink = std::make_shared<CountingSink>();
+        std::array<std::shared_ptr<AGT::ILoggerSink>, 1> sinks = { sink };
+
+        AGT::LoggerAsyncConfig config;
+        config.queueSize = 16;
+        config.overflowPolicy = AGT::LogOverflowPolicy::DropNewest;
+
+        auto logger = AGT::LoggerT::CreateAsync(AGT::LogLevel::Debug, 256, sinks, config);
+        ASSERT_TRUE(logger);
+
+        sink->Blocked = true;
+        for (size_t i = 0; i < numMessages; ++i) {
+            logger->Write(AGT::LogLevel::InfoV1, __FILE__, __func__, __LINE__, "message %zu", i);
+        }
+        sink->Blocked = false;
+
+        logger->Flush();
+        EXPECT_GT(logger->GetDroppedCount(), 0);
+        EXPECT_EQ(numMessages, sink->Count + logger->GetDroppedCount());
+        EXPECT_EQ(std::string::npos, sink->LastMessage.find("message " + std::to_string(numMessages - 1)));
+    }
+
+    {
+        auto sink = std::make_shared<CountingSink>();
+        std::array<std::shared_ptr<AGT::ILoggerSink>, 1> sinks = { sink };
+
+        AGT::LoggerAsyncConfig config;
+        config.queueSize = 16;
+        config.overflowPolicy = AGT::LogOverflowPolicy::DropOldest;
+
+        auto logger = AGT::LoggerT::CreateAsync(AGT::LogLevel::Debug, 256, sinks, config);
+        ASSERT_TRUE(logger);
+
+        sink->Blocked = true;
+        for (size_t i = 0; i < numMessages; ++i) {
+            logger->Write(AGT::LogLevel::InfoV1, __FILE__, __func__, __LINE__, "message %zu", i);
+        }
+        sink->Blocked = false;
+
+        logger->Flush();
+        EXPECT_GT(logger->GetDroppedCount(), 0);
+        EXPECT_EQ(numMessages, sink->Count + logger->GetDroppedCount());
+        EXPECT_NE(std::string::npos, sink->LastMessage.find("message " + std::to_string(numMessages - 1)));
+    }
+}
+
+
+struct CollectingSink : public AGT::ILoggerSink {
+    void Write(const char* msg, size_t size) override {
+        Data.append(msg, size);
+    };
+
+    std::string Data;
+};
+
+static size_t CountOccurrences(const std::string& str, const std::string& pattern) {
+    size_t count = 0;
+    for (size_t pos = str.find(pattern); pos != std::string::npos; pos = str.find(pattern, pos + pattern.size())) {
+        ++count;
+    }
+    return count;
+}
+
+TEST(Logger, SinkLevels) {
+    using LoggerT = AGT::DefaultLogger<AGT::DefaultLogFormatter>;
+
+    for (bool async : { false, true }) {
+        auto errors = std::make_shared<MessageListSink>();
+        auto all = std::make_shared<MessageListSink>();
+        std::array<AGT::LoggerSinkConfig, 2> sinks;
+        sinks[0].sink = errors;
+        sinks[0].maxLevel = AGT::LogLevel::Error;
+        sinks[1].sink = all;
+        sinks[1].maxLevel = AGT::LogLevel::Debug;
+
+        auto logger = async ?
+            LoggerT::CreateAsync(AGT::LogLevel::InfoV1, 256, sinks, AGT::LoggerAsyncConfig{}) :
+            LoggerT::Create(AGT::LogLevel::InfoV1, 256, sinks);
+        ASSERT_TRUE(logger);
+
+        logger->Write(AGT::LogLevel::Warning, __FILE__, __func__, __LINE__, "warning");
+        logger->Write(AGT::LogLevel::Error, __FILE__, __func__, __LINE__, "error");
+        logger->Write(AGT::LogLevel::Debug, __FILE__, __func__, __LINE__, "debug");
+        logger->Flush();
+
+        ASSERT_EQ(1u, errors->Messages.size()) << async;
+        EXPECT_NE(std::string::npos, errors->Messages[0].find("error"));
+        EXPECT_EQ(2u, all->Messages.size());
+
+        //nothing is formatted for a level no sink takes
+        EXPECT_TRUE(logger->IsEnabled(AGT::LogLevel::InfoV1));
+        logger->SetSinkMaxLevel(1, AGT::LogLevel::Warning);
+        EXPECT_FALSE(logger->IsEnabled(AGT::LogLevel::InfoV1));
+        EXPECT_TRUE(logger->IsEnabled(AGT::LogLevel::Warning));
+        logger->SetMaxLevel(AGT::LogLevel::Error);
+        EXPECT_FALSE(logger->IsEnabled(AGT::LogLevel::Warning));
+    }
+}
+
+TEST(Logger, SinkQueues) {
+    using LoggerT = AGT::DefaultLogger<AGT::DefaultLogFormatter>;
+    const size_t numMessages = 100;
+
+    auto slow = std::make_shared<CountingSink>();
+    auto fast = std::make_shared<CountingSink>();
+    std::array<AGT::LoggerSinkConfig, 2> sinks;
+    sinks[0].sink = slow;
+    sinks[0].queueSize = 16;
+    sinks[0].overflowPolicy = AGT::LogOverflowPolicy::DropNewest;
+    sinks[1].sink = fast;
+
+    //a sink queue is filled under the logger's lock, it must not wait for space there
+    sinks[0].overflowPolicy = AGT::LogOverflowPolicy::Block;
+    EXPECT_FALSE(LoggerT::Create(AGT::LogLevel::Debug, 256, sinks));
+    sinks[0].overflowPolicy = AGT::LogOverflowPolicy::DropNewest;
+
+    auto logger = LoggerT::Create(AGT::LogLevel::Debug, 256, sinks);
+    ASSERT_TRUE(logger);
+
+    //a stalled sink only loses its own entries
+    slow->Blocked = true;
+    for (size_t i = 0; i < numMessages; ++i) {
+        logger->Write(AGT::LogLevel::InfoV1, __FILE__, __func__, __LINE__, "message %zu", i);
+    }
+    EXPECT_EQ(numMessages, fast->Count);
+    EXPECT_GT(logger->GetSinkDroppedCount(0), 0u);
+    EXPECT_EQ(0u, logger->GetSinkDroppedCount(1));
+
+    slow->Blocked = false;
+    logger->Flush();
+    EXPECT_EQ(numMessages, slow->Count + logger->GetSinkDroppedCount(0));
+
+    logger->Write(AGT::LogLevel::InfoV1, __FILE__, __func__, __LINE__, "last");
+    logger->Flush();
+    EXPECT_NE(std::string::npos, slow->LastMessage.find("last"));
+}
+
+TEST(Logger, QueueWorkerStalledProducer) {
+    std::mutex processedLock;
+    std::vector<int> processed;
+    auto worker = AGT::LogQueueWorker<int>::Create(8, AGT::LogOverflowPolicy::DropNewest, [](int& value) { value = 0; },
+        [&](AGT::LogQueueWorker<int>& queue) -> size_t {
+            //one entry per call, with a pause after the stalled one before the next is popped
+            int popped = 0;
+            if (!queue.TryPop([&](int& value) { std::lock_guard<std::mutex> lock(processedLock); processed.push_back(value); popped = value; })) {
+                return 0;
+            }
+            queue.MarkProcessed(1);
+            if (popped == 1) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+            return 1;
+        });
+    ASSERT_TRUE(worker);
+
+    //the first producer claims its slot and stalls before filling it, the second one completes behind it
+    std::atomic<bool> filling{ false };
+    std::atomic<bool> release{ false };
+    std::thread stalled([&]() {
+        worker->Push([&](int& value) {
+            filling = true;
+            while (!release) {
+                std::this_thread::yield();
+            }
+            value = 1;
+        }, [](int&) {});
+    });
+    while (!filling) {
+        std::this_thread::yield();
+    }
+    worker->Push([](int& value) { value = 2; }, [](int&) {});
+
+    //a flush after the second push waits for the stalled slot as well, so it sees the second entry
+    std::atomic<bool> flushed{ false };
+    bool sawSecond = false;
+    std::thread flushing([&]() {
+        worker->WaitProcessed();
+        std::lock_guard<std::mutex> lock(processedLock);
+        sawSecond = std::find(processed.begin(), processed.end(), 2) != processed.end();
+        flushed = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(flushed);
+
+    release = true;
+    stalled.join();
+    flushing.join();
+    EXPECT_TRUE(sawSecond);
+    EXPECT_EQ((std::vector<int>{ 1, 2 }), processed);
+}
+
+TEST(Logger, SpilledEntries) {
+    using LoggerT = AGT::DefaultLogger<AGT::DefaultLogFormatter>;
+    const std::string dump(5000, 'd');
+
+    AGT::LoggerSpillConfig spillConfig;
+    spillConfig.segmentSize = 512;
+    spillConfig.numSegments = 32;
+
+    for (bool async : { false, true }) {
+        auto sink = std::make_shared<MessageListSink>();
+        auto queued = std::make_shared<MessageListSink>();
+        std::array<AGT::LoggerSinkConfig, 2> sinks;
+        sinks[0].sink = sink;
+        sinks[1].sink = queued;
+        sinks[1].queueSize = 64;
+
+        auto logger = async ?
+            LoggerT::CreateAsync(AGT::LogLevel::Debug, 256, sinks, AGT::LoggerAsyncConfig{}, spillConfig) :
+            LoggerT::Create(AGT::LogLevel::Debug, 256, sinks, spillConfig);
+        ASSERT_TRUE(logger);
+
+        logger->Write(AGT::LogLevel::InfoV1, __FILE__, __func__, __LINE__, "before");
+        logger->Write(AGT::LogLevel::InfoV1, __FILE__, __func__, __LINE__, "dump %s end", dump.c_str());
+        logger->Write(AGT::LogLevel::InfoV1, __FILE__, __func__, __LINE__, "after");
+        logger->Flush();
+
+        //small entries keep the plain path, the large one arrives whole as one scatter list
+        ASSERT_EQ(3u, sink->Messages.size());
+        EXPECT_EQ(1u, sink->NumScattered);
+        EXPECT_NE(std::string::npos, sink->Messages[0].find("before"));
+        EXPECT_NE(std::string::npos, sink->Messages[1].find("dump " + dump + " end\n"));
+        EXPECT_NE(std::string::npos, sink->Messages[2].find("after"));
+        EXPECT_EQ(0u, logger->GetSpillExhaustedCount());
+
+        //so does a sink with its own queue
+        EXPECT_EQ(sink->Messages, queued->Messages);
+        EXPECT_EQ(1u, queued->NumScattered);
+
+        //the segments go back to the pool once written, only a backlog of large entries can run it dry
+        for (int i = 0; i < 20; ++i) {
+            logger->Write(AGT::LogLevel::InfoV1, __FILE__, __func__, __LINE__, "dump %s", dump.c_str());
+            logger->Flush();
+        }
+        EXPECT_EQ(0u, logger->GetSpillExhaustedCount());
+        EXPECT_EQ(23u, sink->Messages.size());
+        EXPECT_EQ(sink->Messages, queued->Messages);
+    }
+}
+
+//Checks that str is a single flat JSON object with string, number or boolean values and valid UTF-8 strings
+static bool IsFlatJsonObject(std::string_view str) {
+    size_t pos = 0;
+    auto fString = [&]() {
+        if (pos >= str.size() || str[pos++] != '"') {
+            return false;
+        }
+        while (pos < str.size()) {
+            unsigned char c = static_cast<unsigned char>(str[pos++]);
+            if (c == '"') {
+                return true;
+            } else if (c < 0x20) {
+                return false;
+            } else if (c == '\\') {
+                if (pos >= str.size()) {
+                    return false;
+                }
+                char escaped = str[pos++];
+                if (escaped == 'u') {
+                    if (pos + 4 > str.size() || !std::all_of(str.begin() + pos, str.begin() + pos + 4, [](char h) { return std::isxdigit(static_cast<unsigned char>(h)) != 0; })) {
+                        return false;
+                    }
+                    pos += 4;
+                } else if (std::string_view("\"\\/bfnrt").find(escaped) == std::string_view::npos) {
+                    return false;
+                }
+            } else if (c >= 0x80) {
+                size_t numContinuation = c >= 0xF0 ? 3 : c >= 0xE0 ? 2 : c >= 0xC0 ? 1 : 4;
+                for (size_t i = 0; i < numContinuation; ++i) {
+                    if (pos >= str.size() || (static_cast<unsigned char>(str[pos++]) & 0xC0) != 0x80) {
+                        return false;
+                    }
+                }
+            }
+        }
+        return false;
+    };
+    auto fValue = [&]() {
+        if (pos < str.size() && str[pos] == '"') {
+            return fString();
+        }
+        for (std::string_view literal : { "true", "false" }) {
+            if (str.substr(pos, literal.size()) == literal) {
+                pos += literal.size();
+                return true;
+            }
+        }
+        size_t begin = pos;
+        pos += pos < str.size() && str[pos] == '-';
+        while (pos < str.size() && std::isdigit(static_cast<unsigned char>(str[pos]))) {
+            ++pos;
+        }
+        return pos > begin;
+    };
+
+    if (str.empty() || str[pos++] != '{') {
+        return false;
+    }
+    do {
+        if (!fString() || pos >= str.size() || str[pos++] != ':' || !fValue()) {
+            return false;
+        }
+    } while (pos < str.size() && str[pos] == ',' && ++pos);
+    return pos + 1 == str.size() && str[pos] == '}';
+}
+
+TEST(Logger, JsonLogFormatter) {
+    //the first special character is found at every offset of the vector loops and the scalar tail
+    for (size_t size = 0; size < 80; ++size) {
+        std::string clean(size, 'a');
+        EXPECT_EQ(size, AGT::JsonLogFormatter::FindEscape(clean.data(), clean.size()));
+        for (size_t pos = 0; pos < size; ++pos) {
+            for (char special : { '"', '\\', '\n', '\x1F' }) {
+                std::string str = clean;
+                str[pos] = special;
+                str.back() = size > pos + 1 ? '"' : str.back();
+                EXPECT_EQ(pos, AGT::JsonLogFormatter::FindEscape(str.data(), str.size()));
+            }
+        }
+    }
+    std::string utf8 = "\xC3\xA9\x7F\xE2\x82\xAC";
+    EXPECT_EQ(utf8.size(), AGT::JsonLogFormatter::FindEscape(utf8.data(), utf8.size()));
+
+    std::vector<char> data(512);
+    AGT::JsonLogFormatter formatter;
+    {
+        AGT::LogSite site(AGT::LogLevel::Warning, "Render.cpp", "Draw", 42);
+        AGT::LogEntryBuilder builder(data);
+        formatter.Format(builder, site, "say \"%s\" %s\n\t%c %i", "hi", "C:\\dir", '\x01', 7);
+
+        std::string result{ data.data() };
+        std::string expectedPrefix = "{\"timestamp\":";
+        std::string expectedIds = "\"level\":\"Warning\",\"pid\":" + std::to_string(AGT::ThreadInfo::GetProcessId())
+            + ",\"tid\":" + std::to_string(AGT::ThreadInfo::GetThreadId()) + ",";
+        std::string expectedBody = ",\"file\":\"Render.cpp\",\"function\":\"Draw\",\"line\":42,"
+            "\"message\":\"say \\\"hi\\\" C:\\\\dir\\n\\t\\u0001 7\"}\n";
+        EXPECT_EQ(0u, result.find(expectedPrefix));
+        EXPECT_NE(std::string::npos, result.find(expectedIds));
+        EXPECT_EQ(expectedBody, AGT::JsonLogFormatter::GetEntryBody(result));
+        EXPECT_EQ(result.size(), builder.GetSizeWritten());
+    }
+    {
+        AGT::LogSite site(AGT::LogLevel::InfoV1, "Net.cpp", "Send", 7, &g_logReplication);
+        AGT::LogEntryBuilder builder(data);
+        formatter.Format(builder, site, "%s", utf8.c_str());
+        EXPECT_NE(std::string::npos, std::string(data.data()).find(",\"category\":\"net.replication\",\"message\":\"" + utf8 + "\"}\n"));
+    }
+    {
+        //a truncated entry still ends the line
+        std::vector<char> small(64);
+        AGT::LogSite site(AGT::LogLevel::InfoV1, "Net.cpp", "Send", 7);
+        AGT::LogEntryBuilder builder(small);
+        formatter.Format(builder, site, "%s", std::string(100, '"').c_str());
+        EXPECT_EQ(small.size(), builder.GetSizeWritten());
+        EXPECT_EQ('\n', small[small.size() - 2]);
+    }
+
+    //without a pool a message that doesn't fit is cut at a whole character or escape sequence and still closed
+    for (size_t lineSize : { 200, 256, 300 }) {
+        for (size_t offset = 0; offset < 12; ++offset) {
+            std::string message(offset, 'a');
+            for (size_t i = 0; message.size() < 300; ++i) {
+                message += i % 5 == 0 ? "\"" : i % 5 == 1 ? "\xE2\x82\xAC" : i % 5 == 2 ? "\\" : i % 5 == 3 ? "\x01" : "a";
+            }
+            std::vector<char> line(lineSize);
+            AGT::LogSite site(AGT::LogLevel::InfoV1, "Net.cpp", "Send", 7);
+            AGT::LogEntryBuilder builder(line);
+            formatter.Format(builder, site, "%s", message.c_str());
+
+            std::string result{ line.data() };
+            ASSERT_FALSE(result.empty());
+            EXPECT_EQ('\n', result.back());
+            result.pop_back();
+            EXPECT_TRUE(IsFlatJsonObject(result)) << result;
+            EXPECT_NE(std::string::npos, result.find(",\"truncated\":true}"));
+        }
+    }
+    {
+        //a message that fits exactly is not marked
+        std::vector<char> line(256);
+        AGT::LogSite site(AGT::LogLevel::InfoV1, "Net.cpp", "Send", 7);
+        AGT::LogEntryBuilder builder(line);
+        formatter.Format(builder, site, "%s", "\"fits\"");
+        std::string result{ line.data() };
+        EXPECT_TRUE(IsFlatJsonObject(result.substr(0, result.size() - 1))) << result;
+        EXPECT_EQ(std::string::npos, result.find("truncated"));
+    }
+    {
+        //the same for a message longer than the message buffer
+        std::vector<char> line(AGT::JsonLogFormatter::MESSAGE_BUFFER_SIZE * 2);
+        AGT::LogSite site(AGT::LogLevel::InfoV1, "Net.cpp", "Send", 7);
+        AGT::LogEntryBuilder builder(line);
+        std::string euros;
+        while (euros.size() < AGT::JsonLogFormatter::MESSAGE_BUFFER_SIZE) {
+            euros += "\xE2\x82\xAC";
+        }
+        formatter.Format(builder, site, "a%s", euros.c_str());
+        std::string result{ line.data() };
+        EXPECT_TRUE(IsFlatJsonObject(result.substr(0, result.size() - 1))) << result;
+        EXPECT_NE(std::string::npos, result.find("\xE2\x82\xAC\",\"truncated\":true}\n"));
+    }
+
+    //long messages spill with the entry and are escaped across the segment boundaries
+    AGT::LoggerSpillConfig spillConfig;
+    spillConfig.segmentSize = 512;
+    spillConfig.numSegments = 64;
+    std::string quotes(3000, '"');
+    auto sink = std::make_shared<MessageListSink>();
+    std::array<AGT::LoggerSinkConfig, 1> sinks;
+    sinks[0].sink = sink;
+    auto logger = AGT::DefaultLogger<AGT::JsonLogFormatter>::Create(AGT::LogLevel::Debug, 256, sinks, spillConfig);
+    ASSERT_TRUE(logger);
+    logger->Write(AGT::LogLevel::InfoV1, __FILE__, __func__, __LINE__, "%s!", quotes.c_str());
+    logger->Flush();
+
+    std::string escapedQuotes;
+    for (size_t i = 0; i < quotes.size(); ++i) {
+        escapedQuotes += "\\\"";
+    }
+    ASSERT_EQ(1u, sink->Messages.size());
+    EXPECT_NE(std::string::npos, sink->Messages[0].find("\"message\":\"" + escapedQuotes + "!\"}\n"));
+    EXPECT_EQ(0u, logger->GetSpillExhaustedCount());
+
+    //the deferred backend decodes the arguments into the same escaped message
+    auto collecting = std::make_shared<CollectingSink>();
+    std::array<std::shared_ptr<AGT::ILoggerSink>, 1> deferredSinks = { collecting };
+    auto deferredLogger = AGT::DeferredLogger<AGT::JsonLogFormatter>::Create(AGT::LogLevel::Debug, 1024, deferredSinks);
+    ASSERT_TRUE(deferredLogger);
+    static AGT::LogSiteHandle s_site;
+    deferredLogger->Write(s_site, AGT::LogLevel::Error, __FILE__, __func__, __LINE__, "path %s id %i", "a\\b", 5);
+    deferredLogger->Flush();
+    EXPECT_NE(std::string::npos, collecting->Data.find("\"level\":\"Error\""));
+    EXPECT_NE(std::string::npos, collecting->Data.find("\"message\":\"path a\\\\b id 5\"}\n"));
+}
+
+TEST(Logger, SocketSink) {
+    using LoggerT = AGT::DefaultLogger<AGT::DefaultLogFormatter>;
+
+    AGT::LogShippingEndpoint endpoint;
+    endpoint.path = (std::filesystem::temp_directory_path() / "agt_log_collector.sock").string();
+    auto collector = AGT::LogCollector::Create(endpoint);
+    ASSERT_TRUE(collector);
+
+    AGT::LoggerSocketConfig config;
+    config.endpoint = endpoint;
+    config.spillBufferSize = 4096;
+    config.reconnectInterval = std::chrono::milliseconds(10);
+    auto sink = std::shared_ptr<AGT::LoggerSocketSink>(AGT::LoggerSocketSink::Create(config));
+    ASSERT_TRUE(sink);
+    EXPECT_TRUE(sink->IsConnected());
+
+    std::vector<std::string> received;
+    auto fCollect = [&](size_t numExpected) {
+        for (int i = 0; i < 1000 && received.size() < numExpected; ++i) {
+            sink->Flush();
+            collector->Poll(std::chrono::milliseconds(1), [&received](std::string_view entry) { received.emplace_back(entry); });
+        }
+    };
+
+    sink->Write("first", 5);
+    std::array<AGT::IoBuffer, 2> batch = { { { "second", 6 }, { "third", 5 } } };
+    sink->WriteBatch(batch);
+    std::array<AGT::IoBuffer, 2> parts = { { { "scat", 4 }, { "tered", 5 } } };
+    sink->WriteScattered(parts);
+    {
+        std::array<std::shared_ptr<AGT::ILoggerSink>, 1> sinks = { sink };
+        auto logger = LoggerT::Create(AGT::LogLevel::Debug, 256, sinks);
+        logger->Write(AGT::LogLevel::Warning, __FILE__, __func__, __LINE__, "from logger %i", 5);
+    }
+    fCollect(5);
+    ASSERT_EQ(5u, received.size());
+    EXPECT_EQ((std::vector<std::string>{ "first", "second", "third", "scattered" }), std::vector<std::string>(received.begin(), received.begin() + 4));
+    EXPECT_NE(std::string::npos, received[4].find("from logger 5"));
+    EXPECT_EQ(0u, sink->GetPendingSize());
+
+    //without a collector nothing blocks and the spill buffer keeps what fits
+    collector.reset();
+    const std::string entry(100, 'e');
+    for (int i = 0; i < 100; ++i) {
+        sink->Write(entry.c_str(), entry.size());
+    }
+    EXPECT_FALSE(sink->IsConnected());
+    EXPECT_GT(sink->GetDroppedCount(), 0u);
+    EXPECT_LE(sink->GetPendingSize(), config.spillBufferSize);
+    size_t numSpilled = 100 - static_cast<size_t>(sink->GetDroppedCount());
+
+    //the spilled entries go out once the collector is back
+    collector = AGT::LogCollector::Create(endpoint);
+    ASSERT_TRUE(collector);
+    received.clear();
+    std::this_thread::sleep_for(config.reconnectInterval * 2);
+    fCollect(numSpilled);
+    EXPECT_TRUE(sink->IsConnected());
+    ASSERT_EQ(numSpilled, received.size());
+    EXPECT_EQ(entry, received.back());
+    EXPECT_EQ(0u, collector->GetCorruptCount());
+}
+
+TEST(Logger, SocketSinkUdp) {
+    AGT::LogShippingEndpoint endpoint;
+    endpoint.type = AGT::SocketType::Udp;
+    auto collector = AGT::LogCollector::Create(endpoint);
+    ASSERT_TRUE(collector);
+    endpoint.port = collector->GetPort();
+    ASSERT_NE(0, endpoint.port);
+
+    AGT::LoggerSocketConfig config;
+    config.endpoint = endpoint;
+    config.maxDatagramSize = 1024;
+    auto sink = AGT::LoggerSocketSink::Create(config);
+    ASSERT_TRUE(sink);
+
+    //entries are packed into datagrams, one that can't fit any is dropped
+    std::vector<std::string> entries;
+    for (int i = 0; i < 50; ++i) {
+        entries.push_back("entry " + std::to_string(i) + std::string(i * 4, '.'));
+    }
+    std::vector<AGT::IoBuffer> batch;
+    for (const std::string& entry : entries) {
+        batch.push_back({ entry.data(), entry.size() });
+    }
+    sink->WriteBatch(batch);
+    const std::string tooLarge(2000, 'x');
+    sink->Write(tooLarge.c_str(), tooLarge.size());
+    EXPECT_EQ(1u, sink->GetDroppedCount());
+
+    std::vector<std::string> received;
+    for (int i = 0; i < 1000 && received.size() < entries.size(); ++i) {
+        sink->Flush();
+        collector->Poll(std::chrono::milliseconds(1), [&received](std::string_view entry) { received.emplace_back(entry); });
+    }
+    EXPECT_EQ(entries, received);
+    EXPECT_EQ(0u, collector->GetCorruptCount());
+}
+
+TEST(Logger, DeferredLogger) {
+    using DeferredLoggerT = AGT::DeferredLogger<AGT::DefaultLogFormatter>;
+
+    auto fWriteMessages = [](DeferredLoggerT& logger, int numMessages) {
+        for (int i = 0; i < numMessages; ++i) {
+            static AGT::LogSiteHandle s_site;
+            logger.Write(s_site, AGT::LogLevel::InfoV1, __FILE__, __func__, __LINE__,
+                         "entity %i at %.2f named %s hex=%llx %%done", i, 1.5 * i, "Bob", 0xABCull);
+        }
+    };
+
+    auto fExpectedMessage = [](int i) {
+        char expected[128];
+        snprintf(expected, sizeof(expected), "entity %i at %.2f named %s hex=%llx %%done", i, 1.5 * i, "Bob", 0xABCull);
+        return std::string(expected);
+    };
+
+    {
+        auto sink = std::make_shared<CollectingSink>();
+        std::array<std::shared_ptr<AGT::ILoggerSink>, 1> sinks = { sink };
+
+        auto logger = DeferredLoggerT::Create(AGT::LogLevel::Debug, 1024, sinks);
+        ASSERT_TRUE(logger);
+
+        fWriteMessages(*logger, 100);
+
+        static AGT::LogSiteHandle s_filteredSite;
+        logger->Write(s_filteredSite, AGT::LogLevel::Debug, __FILE__, __func__, __LINE__, "debug %i", 1);
+
+        logger->Flush();
+
+        for (int i = 0; i < 100; ++i) {
+            EXPECT_NE(std::string::npos, sink->Data.find(fExpectedMessage(i) + "\n")) << i;
+        }
+        EXPECT_EQ(100, CountOccurrences(sink->Data, AGT::LogLevelToString(AGT::LogLevel::InfoV1)));
+        EXPECT_EQ(1, CountOccurrences(sink->Data, "debug 1"));
+        EXPECT_NE(std::string::npos, sink->Data.find(std::filesystem::path(__FILE__).filename().string()));
+        EXPECT_EQ(0, logger->GetDroppedCount());
+    }
+
+    {
+        const int numThreads = 4;
+        const int numMessages = 2000;
+
+        auto sink = std::make_shared<CollectingSink>();
+        std::array<std::shared_ptr<AGT::ILoggerSink>, 1> sinks = { sink };
+
+        AGT::DeferredLoggerConfig config;
+        config.threadBufferSize = 4096;
+        auto logger = DeferredLoggerT::Create(AGT::LogLevel::Debug, 1024, sinks, config);
+        ASSERT_TRUE(logger);
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < numThreads; ++i) {
+            threads.emplace_back([&]() { fWriteMessages(*logger, numMessages); });
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        logger->Flush();
+        EXPECT_EQ(numThreads * numMessages, CountOccurrences(sink->Data, "named Bob"));
+        EXPECT_EQ(numThreads, CountOccurrences(sink->Data, fExpectedMessage(numMessages - 1)));
+    }
+
+    {
+        auto textSink = std::make_shared<CollectingSink>();
+        auto binarySink = std::make_shared<CollectingSink>();
+        std::array<std::shared_ptr<AGT::ILoggerSink>, 1> textSinks = { textSink };
+        std::array<std::shared_ptr<AGT::ILoggerSink>, 1> binarySinks = { binarySink };
+
+        AGT::DeferredLoggerConfig config;
+        config.output = AGT::DeferredLogOutput::Binary;
+
+        auto textLogger = DeferredLoggerT::Create(AGT::LogLevel::Debug, 1024, textSinks);
+        auto binaryLogger = DeferredLoggerT::Create(AGT::LogLevel::Debug, 1024, binarySinks, config);
+        ASSERT_TRUE(textLogger && binaryLogger);
+
+        fWriteMessages(*textLogger, 1000);
+        fWriteMessages(*binaryLogger, 1000);
+        textLogger->Flush();
+        binaryLogger->Flush();
+
+        EXPECT_LT(binarySink->Data.size() * 3, textSink->Data.size());
+
+        CollectingSink decoded;
+        AGT::BinaryLogReader<AGT::DefaultLogFormatter> reader;
+        EXPECT_TRUE(reader.Read(binarySink->Data, decoded));
+        EXPECT_EQ(textSink->Data.size(), decoded.Data.size());
+        for (int i = 0; i < 1000; ++i) {
+            EXPECT_NE(std::string::npos, decoded.Data.find(fExpectedMessage(i) + "\n")) << i;
+        }
+
+        CollectingSink truncated;
+        AGT::BinaryLogReader<AGT::DefaultLogFormatter> truncatedReader;
+        EXPECT_FALSE(truncatedReader.Read(std::span<const char>(binarySink->Data.data(), binarySink->Data.size() - 1), truncated));
+    }
+
+    {
+        //a thread alternating between loggers keeps one buffer per logger
+        auto firstSink = std::make_shared<CollectingSink>();
+        auto secondSink = std::make_shared<CollectingSink>();
+        std::array<std::shared_ptr<AGT::ILoggerSink>, 1> firstSinks = { firstSink };
+        std::array<std::shared_ptr<AGT::ILoggerSink>, 1> secondSinks = { secondSink };
+        auto first = DeferredLoggerT::Create(AGT::LogLevel::Debug, 1024, firstSinks);
+        auto second = DeferredLoggerT::Create(AGT::LogLevel::Debug, 1024, secondSinks);
+        ASSERT_TRUE(first && second);
+
+        for (int i = 0; i < 100; ++i) {
+            fWriteMessages(*first, 1);
+            fWriteMessages(*second, 1);
+            EXPECT_EQ(1u, first->GetNumThreadBuffers());
+            EXPECT_EQ(1u, second->GetNumThreadBuffers());
+        }
+        first->Flush();
+        second->Flush();
+        EXPECT_EQ(100, CountOccurrences(firstSink->Data, "named Bob"));
+        EXPECT_EQ(100, CountOccurrences(secondSink->Data, "named Bob"));
+
+        //the buffer of a destroyed logger is dropped when the thread adds the next one
+        second.reset();
+        auto third = DeferredLoggerT::Create(AGT::LogLevel::Debug, 1024, secondSinks);
+        ASSERT_TRUE(third);
+        fWriteMessages(*third, 1);
+        fWriteMessages(*first, 1);
+        third->Flush();
+        first->Flush();
+        EXPECT_EQ(101, CountOccurrences(secondSink->Data, "named Bob"));
+        EXPECT_EQ(101, CountOccurrences(firstSink->Data, "named Bob"));
+        EXPECT_EQ(1u, first->GetNumThreadBuffers());
+    }
+}
+
+TEST(Logger, BinaryLogReaderMismatchedFormat) {
+    //one site and one entry, with the format and types a damaged file could hold
+    auto fMakeStream = [](std::string_view format, AGT::LogArgType type, std::string_view args) {
+        std::vector<char> stream;
+        auto fAppendString = [&stream](std::string_view str) {
+            AGT::BinaryLogFormat::WriteVarint(stream, str.size());
+            stream.insert(stream.end(), str.begin(), str.end());
+        };
+
+        uint32_t header[2] = { AGT::BinaryLogFormat::MAGIC, AGT::BinaryLogFormat::VERSION };
+        stream.push_back(static_cast<char>(AGT::BinaryLogRecord::Process));
+        stream.insert(stream.end(), reinterpret_cast<const char*>(header), reinterpret_cast<const char*>(header + 2));
+        AGT::BinaryLogFormat::WriteVarint(stream, 1);
+
+        stream.push_back(static_cast<char>(AGT::BinaryLogRecord::Site));
+        AGT::BinaryLogFormat::WriteVarint(stream, 1);
+        stream.push_back(static_cast<char>(AGT::LogLevel::InfoV1));
+        AGT::BinaryLogFormat::WriteVarint(stream, 10);
+        AGT::BinaryLogFormat::WriteVarint(stream, 1);
+        stream.push_back(static_cast<char>(type));
+        fAppendString("File.cpp");
+        fAppendString("Function");
+        fAppendString(format);
+
+        stream.push_back(static_cast<char>(AGT::BinaryLogRecord::Entry));
+        AGT::BinaryLogFormat::WriteVarint(stream, 1);
+        AGT::BinaryLogFormat::WriteVarint(stream, 0);
+        AGT::BinaryLogFormat::WriteVarint(stream, args.size());
+        stream.insert(stream.end(), args.begin(), args.end());
+        return stream;
+    };
+
+    auto fRead = [](const std::vector<char>& stream, std::string& text) {
+        CollectingSink sink;
+        AGT::BinaryLogReader<AGT::DefaultLogFormatter> reader;
+        bool valid = reader.Read(stream, sink);
+        text = sink.Data;
+        return valid;
+    };
+
+    const int64_t int64Value = 0x100000001;
+    const std::string_view int64Args(reinterpret_cast<const char*>(&int64Value), sizeof(int64Value));
+    const std::string_view stringArgs("\x02\0\0\0hi\0", 7);
+    std::string text;
+
+    //the length modifier follows the stored type, not the format
+    EXPECT_TRUE(fRead(fMakeStream("value %d", AGT::LogArgType::Int64, int64Args), text));
+    EXPECT_NE(std::string::npos, text.find("value 4294967297"));
+    EXPECT_TRUE(fRead(fMakeStream("say %ls", AGT::LogArgType::String, stringArgs), text));
+    EXPECT_NE(std::string::npos, text.find("say hi"));
+
+    //conversions of another type, %n and unterminated strings fail the record
+    EXPECT_FALSE(fRead(fMakeStream("value %-3s", AGT::LogArgType::Int64, int64Args), text));
+    EXPECT_TRUE(text.empty());
+    EXPECT_FALSE(fRead(fMakeStream("value %f", AGT::LogArgType::Int64, int64Args), text));
+    EXPECT_FALSE(fRead(fMakeStream("value %d", AGT::LogArgType::String, stringArgs), text));
+    EXPECT_FALSE(fRead(fMakeStream("value %n", AGT::LogArgType::Int64, int64Args), text));
+    EXPECT_FALSE(fRead(fMakeStream("value %lln", AGT::LogArgType::Int64, int64Args), text));
+    EXPECT_FALSE(fRead(fMakeStream("say %s", AGT::LogArgType::String, std::string_view("\x02\0\0\0hi!", 7)), text));
 }
\ No newline at end of file
@@ -0,0 +1,584 @@
+#include "pch.h"
+
+#include "AGT/log/DefaultLogFormatter.h"
+#include "AGT/log/LogEntryBuilder.h"
+#include "AGT/platform/Platform.h"
+#include "AGT/thread/AdaptiveLock.h"
+#include "AGT/thread/JobSystem.h"
+#include "AGT/thread/LockProfiler.h"
+#include "AGT/thread/MCSLock.h"
+#include "AGT/thread/ProfiledLock.h"
+#include "AGT/thread/RWSpinLock.h"
+#include "AGT/thread/SeqLock.h"
+#include "AGT/thread/SpinLock.h"
+#include "AGT/thread/TicketLock.h"
+#include "AGT/thread/WorkStealingDeque.h"
+#include "AGT/thread/ThreadInfo.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifdef AGT_PLAT_WINDOWS
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+static int GetOSProcessId() {
+#ifdef AGT_PLAT_WINDOWS
+    return _getpid();
+#else
+    return static_cast<int>(getpid());
+#endif
+}
+
+TEST(ThreadInfo, ProcessId) {
+    EXPECT_EQ(GetOSProcessId(), AGT::ThreadInfo::GetProcessId());
+
+    std::string header{ AGT::ThreadInfo::GetLogHeader() };
+    EXPECT_EQ("[pid=" + std::to_string(GetOSProcessId()) + "][tid=" + std::to_string(AGT::ThreadInfo::GetThreadId()) + "]", header);
+
+    //the child process must not keep the cached pid of the parent
+    EXPECT_EXIT({
+        std::string childHeader{ AGT::ThreadInfo::GetLogHeader() };
+        bool valid = AGT::ThreadInfo::GetProcessId() == GetOSProcessId()
+            && childHeader.find("[pid=" + std::to_string(GetOSProcessId()) + "]") != std::string::npos;
+        std::exit(valid ? 0 : 1);
+    }, ::testing::ExitedWithCode(0), "");
+}
+
+TEST(ThreadInfo, ThreadName) {
+    EXPECT_TRUE(AGT::ThreadInfo::GetThreadName().empty());
+
+    std::string workerHeader;
+    std::string workerEntry;
+    uint64_t workerId = 0;
+    std::thread worker([&]() {
+        AGT::ThreadInfo::SetThreadName("Worker3");
+        workerHeader = AGT::ThreadInfo::GetLogHeader();
+        workerId = AGT::ThreadInfo::GetThreadId();
+
+        std::vector<char> data(256);
+        AGT::LogEntryBuilder builder(data);
+        AGT::DefaultLogFormatter formatter;
+        formatter.Format(builder, AGT::LogLevel::InfoV1, __FILE__, __func__, __LINE__, "Frame %i", 7);
+        workerEntry = data.data();
+
+        AGT::ThreadInfo::SetThreadName(std::string(100, 'x'));
+        EXPECT_EQ(AGT::ThreadInfo::MAX_THREAD_NAME_SIZE, AGT::ThreadInfo::GetThreadName().size());
+    });
+    worker.join();
+
+    EXPECT_NE(workerId, AGT::ThreadInfo::GetThreadId());
+    EXPECT_TRUE(workerHeader.ends_with("[tid=" + std::to_string(workerId) + "][Worker3]"));
+    EXPECT_TRUE(workerEntry.find(workerHeader) != std::string::npos);
+    EXPECT_TRUE(workerEntry.find("Frame 7") != std::string::npos);
+    EXPECT_TRUE(std::string_view(AGT::ThreadInfo::GetLogHeader()).find("Worker3") == std::string_view::npos);
+}
+
+TEST(AdaptiveLock, MutualExclusion) {
+    EXPECT_EQ(64u, alignof(AGT::AdaptiveLock));
+
+    //more threads than cores, so owners get descheduled and waiters have to park
+    AGT::AdaptiveLock lock;
+    size_t counter = 0;
+    const size_t numThreads = std::thread::hardware_concurrency() * 2 + 2;
+    const size_t numIncrements = 20000;
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < numThreads; ++i) {
+        threads.emplace_back([&]() {
+            for (size_t j = 0; j < numIncrements; ++j) {
+                std::lock_guard<AGT::AdaptiveLock> guard(lock);
+                ++counter;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(numThreads * numIncrements, counter);
+}
+
+TEST(AdaptiveLock, WakesParkedWaiter) {
+    AGT::AdaptiveLock lock;
+    lock.lock();
+    EXPECT_FALSE(lock.try_lock());
+
+    std::atomic<bool> acquired{ false };
+    std::thread waiter([&]() {
+        lock.lock();
+        acquired.store(true);
+        lock.unlock();
+    });
+
+    //long enough for the waiter to stop spinning and park
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(acquired.load());
+    lock.unlock();
+    waiter.join();
+
+    EXPECT_TRUE(acquired.load());
+    EXPECT_TRUE(lock.try_lock());
+    lock.unlock();
+}
+
+template<typename TLock>
+static size_t IncrementUnderLock(TLock& lock, size_t numThreads, size_t numIncrements) {
+    size_t counter = 0;
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < numThreads; ++i) {
+        threads.emplace_back([&]() {
+            for (size_t j = 0; j < numIncrements; ++j) {
+                std::lock_guard<TLock> guard(lock);
+                ++counter;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return counter;
+}
+
+TEST(TicketLock, MutualExclusion) {
+    AGT::TicketLock lock;
+    EXPECT_EQ(4u * 2000u, IncrementUnderLock(lock, 4, 2000));
+
+    EXPECT_TRUE(lock.try_lock());
+    EXPECT_FALSE(lock.try_lock());
+    lock.unlock();
+    EXPECT_TRUE(lock.try_lock());
+    lock.unlock();
+}
+
+TEST(TicketLock, ServesInArrivalOrder) {
+    AGT::TicketLock lock;
+    lock.lock();
+
+    //each waiter takes its ticket before the next one starts
+    std::vector<int> order;
+    std::vector<std::thread> waiters;
+    for (int i = 0; i < 3; ++i) {
+        waiters.emplace_back([&, i]() {
+            lock.lock();
+            order.push_back(i);
+            lock.unlock();
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    lock.unlock();
+    for (auto& waiter : waiters) {
+        waiter.join();
+    }
+    EXPECT_EQ((std::vector<int>{ 0, 1, 2 }), order);
+}
+
+TEST(MCSLock, MutualExclusion) {
+    AGT::MCSLock lock;
+    EXPECT_EQ(4u * 2000u, IncrementUnderLock(lock, 4, 2000));
+
+    //a thread can hold several locks and release them in any order
+    AGT::MCSLock other;
+    lock.lock();
+    EXPECT_TRUE(other.try_lock());
+    EXPECT_FALSE(other.try_lock());
+    lock.unlock();
+    other.unlock();
+
+    AGT::MCSLock::Node node;
+    EXPECT_TRUE(lock.try_lock(node));
+    std::atomic<bool> acquired{ false };
+    std::thread waiter([&]() {
+        lock.lock();
+        acquired.store(true);
+        lock.unlock();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(acquired.load());
+    lock.unlock(node);
+    waiter.join();
+    EXPECT_TRUE(acquired.load());
+}
+
+TEST(RWSpinLock, ReadersAndWriters) {
+    AGT::RWSpinLock lock;
+    EXPECT_GE(lock.GetNumSlots(), 1u);
+
+    //readers share the lock, writers exclude everyone
+    lock.lock_shared();
+    EXPECT_TRUE(lock.try_lock_shared());
+    EXPECT_FALSE(lock.try_lock());
+    lock.unlock_shared();
+    lock.unlock_shared();
+    EXPECT_TRUE(lock.try_lock());
+    EXPECT_FALSE(lock.try_lock_shared());
+    lock.unlock();
+
+    //the writer keeps both halves equal, readers must never see them differ
+    uint64_t first = 0;
+    uint64_t second = 0;
+    std::atomic<bool> stop{ false };
+    std::atomic<size_t> numTorn{ 0 };
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&]() {
+            while (!stop.load()) {
+                std::shared_lock<AGT::RWSpinLock> guard(lock);
+                numTorn += first != second;
+            }
+        });
+    }
+
+    for (uint64_t i = 1; i <= 2000; ++i) {
+        std::unique_lock<AGT::RWSpinLock> guard(lock);
+        first = i;
+        second = i;
+    }
+    stop.store(true);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(0u, numTorn.load());
+    EXPECT_EQ(2000u, first);
+}
+
+TEST(RWSpinLock, WriterPreferred) {
+    AGT::RWSpinLock lock;
+    lock.lock_shared();
+
+    std::atomic<bool> written{ false };
+    std::thread writer([&]() {
+        std::unique_lock<AGT::RWSpinLock> guard(lock);
+        written.store(true);
+    });
+
+    //once the writer waits, new readers stay out until it is done
+    while (lock.try_lock_shared()) {
+        lock.unlock_shared();
+        std::this_thread::yield();
+    }
+    EXPECT_FALSE(written.load());
+    lock.unlock_shared();
+    writer.join();
+    EXPECT_TRUE(written.load());
+    EXPECT_TRUE(lock.try_lock_shared());
+    lock.unlock_shared();
+}
+
+TEST(SeqLock, ConsistentSnapshots) {
+    struct Tuning {
+        uint64_t version;
+        double scale;
+        uint32_t checksum;
+    };
+
+    AGT::SeqLock<Tuning> tuning(Tuning{ 0, 0.0, ~0u });
+    EXPECT_EQ(0u, tuning.Load().version);
+
+    std::atomic<bool> stop{ false };
+    std::atomic<size_t> numTorn{ 0 };
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 3; ++i) {
+        readers.emplace_back([&]() {
+            while (!stop.load()) {
+                Tuning value = tuning.Load();
+                numTorn += value.scale != static_cast<double>(value.version) * 0.5
+                    || value.checksum != static_cast<uint32_t>(~value.version);
+            }
+        });
+    }
+
+    //two writers, each publishes only whole values
+    std::vector<std::thread> writers;
+    for (int w = 0; w < 2; ++w) {
+        writers.emplace_back([&, w]() {
+            for (uint64_t i = 1; i <= 5000; ++i) {
+                uint64_t version = i * 2 + w;
+                tuning.Store(Tuning{ version, static_cast<double>(version) * 0.5, static_cast<uint32_t>(~version) });
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    stop.store(true);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_EQ(0u, numTorn.load());
+    Tuning last = tuning.Load();
+    EXPECT_TRUE(last.version == 10000u || last.version == 10001u);
+}
+
+static bool GetLockProfile(std::string_view name, AGT::LockProfileStats& result) {
+    bool found = false;
+    AGT::LockProfiler::ForEach([&](std::string_view lockName, const AGT::LockProfileStats& stats) {
+        if (lockName == name) {
+            result = stats;
+            found = true;
+        }
+    });
+    return found;
+}
+
+TEST(LockProfiler, Statistics) {
+    EXPECT_EQ(0u, AGT::LockProfileStats::GetBucket(0));
+    EXPECT_EQ(0u, AGT::LockProfileStats::GetBucket(1));
+    EXPECT_EQ(10u, AGT::LockProfileStats::GetBucket(1500));
+    EXPECT_EQ(AGT::LockProfileStats::NUM_BUCKETS - 1, AGT::LockProfileStats::GetBucket(UINT64_MAX));
+
+    AGT::LockProfileStats stats;
+    EXPECT_FALSE(GetLockProfile("Test.Recorder", stats));
+
+    //a thread that exits keeps its counts
+    AGT::LockProfileRecorder recorder("Test.Recorder");
+    std::thread worker([&]() {
+        recorder.Acquired(AGT::LockProfileRecorder::GetTicks(), 0, false);
+        recorder.Released();
+    });
+    worker.join();
+
+    recorder.Acquired(AGT::LockProfileRecorder::GetTicks(), 5, true);
+    recorder.Released();
+
+    ASSERT_TRUE(GetLockProfile("Test.Recorder", stats));
+    EXPECT_EQ(2u, stats.numAcquires);
+    EXPECT_EQ(1u, stats.numContended);
+    EXPECT_EQ(5u, stats.numSpins);
+    uint64_t numWaits = 0;
+    uint64_t numHolds = 0;
+    for (size_t i = 0; i < AGT::LockProfileStats::NUM_BUCKETS; ++i) {
+        numWaits += stats.waitHistogram[i];
+        numHolds += stats.holdHistogram[i];
+    }
+    EXPECT_EQ(2u, numWaits);
+    EXPECT_EQ(2u, numHolds);
+    EXPECT_EQ(stats.maxWaitNs, AGT::LockProfileStats::GetPercentileNs(stats.waitHistogram, 0.99, stats.maxWaitNs));
+
+    //percentiles are bucket bounds, never above the longest sample
+    std::array<uint64_t, AGT::LockProfileStats::NUM_BUCKETS> histogram{};
+    histogram[AGT::LockProfileStats::GetBucket(100)] = 99;
+    histogram[AGT::LockProfileStats::GetBucket(4275)] = 1;
+    EXPECT_EQ(127u, AGT::LockProfileStats::GetPercentileNs(histogram, 0.5, 4275));
+    EXPECT_EQ(4275u, AGT::LockProfileStats::GetPercentileNs(histogram, 0.999, 4275));
+    EXPECT_NE(std::string::npos, AGT::LockProfiler::GetReport().find("Test.Recorder"));
+
+    //names are copied, the caller's string may go away
+    {
+        std::string name = "Test.Temporary";
+        AGT::LockProfileRecorder temporary(name.c_str());
+        name.assign(name.size(), 'x');
+        temporary.Acquired(AGT::LockProfileRecorder::GetTicks(), 0, false);
+        temporary.Released();
+    }
+    EXPECT_TRUE(GetLockProfile("Test.Temporary", stats));
+
+#ifdef AGT_ENABLE_LOCK_PROFILING
+    AGT::SpinLock spinLock("Test.SpinLock");
+    AGT::ProfiledLock<std::mutex> mutex("Test.Mutex");
+    EXPECT_EQ(4u * 500u, IncrementUnderLock(spinLock, 4, 500));
+    EXPECT_EQ(4u * 500u, IncrementUnderLock(mutex, 4, 500));
+    ASSERT_TRUE(GetLockProfile("Test.SpinLock", stats));
+    EXPECT_EQ(2000u, stats.numAcquires);
+    ASSERT_TRUE(GetLockProfile("Test.Mutex", stats));
+    EXPECT_EQ(2000u, stats.numAcquires);
+#else
+    //compiled out, the locks are untouched
+    AGT::ProfiledLock<std::mutex> mutex("Test.Mutex");
+    static_assert(sizeof(mutex) == sizeof(std::mutex));
+    static_assert(sizeof(AGT::SpinLock) == sizeof(std::atomic<bool>));
+    EXPECT_EQ(4u * 500u, IncrementUnderLock(mutex, 4, 500));
+    EXPECT_FALSE(GetLockProfile("Test.Mutex", stats));
+#endif
+}
+
+TEST(LockProfiler, PeriodicReport) {
+    AGT::LockProfileRecorder recorder("Test.Reported");
+    recorder.Acquired(AGT::LockProfileRecorder::GetTicks(), 0, false);
+    recorder.Released();
+
+    std::mutex lock;
+    std::vector<std::string> reports;
+    auto reporter = AGT::LockProfileReporter::Create(std::chrono::milliseconds(5), [&](const std::string& report) {
+        std::lock_guard<std::mutex> guard(lock);
+        reports.push_back(report);
+    });
+    ASSERT_TRUE(reporter);
+    EXPECT_FALSE(AGT::LockProfileReporter::Create(std::chrono::milliseconds(0), [](const std::string&) {}));
+
+    for (;;) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        std::lock_guard<std::mutex> guard(lock);
+        if (!reports.empty()) {
+            break;
+        }
+    }
+
+    //the last report is written on destruction
+    reporter.reset();
+    EXPECT_GE(reports.size(), 2u);
+    EXPECT_NE(std::string::npos, reports.back().find("Test.Reported"));
+}
+
+TEST(WorkStealingDeque, OwnerAndThieves) {
+    AGT::WorkStealingDeque<size_t> deque(4);
+    EXPECT_EQ(4u, deque.GetCapacity());
+
+    //the owner works LIFO, thieves take the oldest item
+    size_t item = 0;
+    for (size_t i = 1; i <= 4; ++i) {
+        EXPECT_TRUE(deque.Push(i));
+    }
+    EXPECT_FALSE(deque.Push(5));
+    EXPECT_TRUE(deque.Pop(item));
+    EXPECT_EQ(4u, item);
+    EXPECT_TRUE(deque.Steal(item));
+    EXPECT_EQ(1u, item);
+    EXPECT_TRUE(deque.Pop(item));
+    EXPECT_TRUE(deque.Pop(item));
+    EXPECT_EQ(2u, item);
+    EXPECT_FALSE(deque.Pop(item));
+    EXPECT_FALSE(deque.Steal(item));
+    EXPECT_TRUE(deque.IsEmpty());
+
+    //every item is taken exactly once while thieves race the owner
+    const size_t numItems = 100000;
+    AGT::WorkStealingDeque<size_t> shared(256);
+    std::vector<std::atomic<uint8_t>> taken(numItems);
+    std::atomic<bool> done{ false };
+    std::vector<std::thread> thieves;
+    for (int i = 0; i < 3; ++i) {
+        thieves.emplace_back([&]() {
+            size_t stolen = 0;
+            while (!done.load() || !shared.IsEmpty()) {
+                if (shared.Steal(stolen)) {
+                    taken[stolen].fetch_add(1);
+                }
+            }
+        });
+    }
+
+    size_t popped = 0;
+    for (size_t i = 0; i < numItems; ++i) {
+        while (!shared.Push(i)) {
+            if (shared.Pop(popped)) {
+                taken[popped].fetch_add(1);
+            }
+        }
+        if (i % 3 == 0 && shared.Pop(popped)) {
+            taken[popped].fetch_add(1);
+        }
+    }
+    done.store(true);
+    for (auto& thief : thieves) {
+        thief.join();
+    }
+    while (shared.Pop(popped)) {
+        taken[popped].fetch_add(1);
+    }
+
+    EXPECT_TRUE(std::all_of(taken.begin(), taken.end(), [](const std::atomic<uint8_t>& count) { return count.load() == 1; }));
+}
+
+static uint64_t JobFibonacci(AGT::JobSystem& jobSystem, uint64_t n) {
+    if (n < 2) {
+        return n;
+    }
+
+    //waiting inside a job runs other jobs instead of blocking the worker
+    uint64_t a = 0;
+    AGT::JobCounter counter;
+    jobSystem.Run([&]() { a = JobFibonacci(jobSystem, n - 1); }, &counter);
+    uint64_t b = JobFibonacci(jobSystem, n - 2);
+    jobSystem.Wait(counter);
+    return a + b;
+}
+
+TEST(JobSystem, RunAndWait) {
+    auto jobSystem = AGT::JobSystem::Create(4);
+    ASSERT_TRUE(jobSystem);
+    EXPECT_EQ(4u, jobSystem->GetNumWorkers());
+
+    std::atomic<size_t> numRun{ 0 };
+    AGT::JobCounter counter;
+    EXPECT_TRUE(counter.IsDone());
+    for (int i = 0; i < 1000; ++i) {
+        jobSystem->Run([&numRun]() { numRun.fetch_add(1); }, &counter);
+    }
+    jobSystem->Wait(counter);
+    EXPECT_TRUE(counter.IsDone());
+    EXPECT_EQ(1000u, numRun.load());
+
+    //a counter orders dependent work: the second stage starts once the first is done
+    std::vector<int> stage(64, 0);
+    AGT::JobCounter firstStage;
+    for (size_t i = 0; i < stage.size(); ++i) {
+        jobSystem->Run([&stage, i]() { stage[i] = static_cast<int>(i); }, &firstStage);
+    }
+    AGT::JobCounter secondStage;
+    int sum = 0;
+    jobSystem->Run([&]() {
+        jobSystem->Wait(firstStage);
+        for (int value : stage) {
+            sum += value;
+        }
+    }, &secondStage);
+    jobSystem->Wait(secondStage);
+    EXPECT_EQ(63 * 64 / 2, sum);
+
+    EXPECT_EQ(6765u, JobFibonacci(*jobSystem, 20));
+}
+
+TEST(JobSystem, ParallelFor) {
+    auto jobSystem = AGT::JobSystem::Create();
+    ASSERT_TRUE(jobSystem);
+    EXPECT_EQ(static_cast<size_t>(std::max(std::thread::hardware_concurrency(), 1u)), jobSystem->GetNumWorkers());
+
+    for (size_t count : { 0, 1, 7, 1000, 100000 }) {
+        std::vector<std::atomic<uint8_t>> visited(count);
+        jobSystem->ParallelFor(0, count, [&visited](size_t i) { visited[i].fetch_add(1); });
+        EXPECT_TRUE(std::all_of(visited.begin(), visited.end(), [](const std::atomic<uint8_t>& v) { return v.load() == 1; }));
+    }
+
+    std::vector<std::atomic<uint8_t>> visited(1000);
+    jobSystem->ParallelFor(100, 900, [&visited](size_t i) { visited[i].fetch_add(1); }, 1);
+    for (size_t i = 0; i < visited.size(); ++i) {
+        EXPECT_EQ(i >= 100 && i < 900 ? 1 : 0, visited[i].load());
+    }
+}
+
+TEST(JobSystem, FullPoolRunsInline) {
+    //with 4 pooled jobs most of these run on the calling thread, none get lost
+    auto jobSystem = AGT::JobSystem::Create(2, 4);
+    ASSERT_TRUE(jobSystem);
+
+    std::atomic<size_t> numRun{ 0 };
+    AGT::JobCounter counter;
+    for (int i = 0; i < 200; ++i) {
+        jobSystem->Run([&numRun]() {
+            std::this_thread::sleep_for(std::chrono::microseconds(10));
+            numRun.fetch_add(1);
+        }, &counter);
+    }
+    jobSystem->Wait(counter);
+    EXPECT_EQ(200u, numRun.load());
+
+    //jobs still queued run before the system goes away
+    std::atomic<size_t> numQueuedRun{ 0 };
+    for (int i = 0; i < 4; ++i) {
+        jobSystem->Run([&numQueuedRun]() { numQueuedRun.fetch_add(1); });
+    }
+    jobSystem.reset();
+    EXPECT_EQ(4u, numQueuedRun.load());
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+#include "pch.h"
+
+#include "AGT/time/Timer.h"
+#include "AGT/time/TscClock.h"
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+TEST(TscClock, Monotonic) {
+    uint64_t previous = AGT::TscClock::GetTicks();
+    uint64_t previousNs = AGT::TscClock::TicksToMonotonicNs(previous);
+    for (int i = 0; i < 100000; ++i) {
+        uint64_t ticks = AGT::TscClock::GetTicks();
+        uint64_t ns = AGT::TscClock::TicksToMonotonicNs(ticks);
+        EXPECT_GE(ticks, previous);
+        EXPECT_GE(ns, previousNs);
+        previous = ticks;
+        previousNs = ns;
+    }
+
+    EXPECT_GT(AGT::TscClock::GetTicksPerSecond(), 0u);
+}
+
+TEST(TscClock, Calibration) {
+    using namespace std::chrono;
+
+    uint64_t systemNs = duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+    uint64_t epochNs = AGT::TscClock::GetTimeSinceEpochNs();
+    EXPECT_LT(epochNs > systemNs ? epochNs - systemNs : systemNs - epochNs, 50'000'000u);
+
+    uint64_t startTicks = AGT::TscClock::GetTicks();
+    auto start = steady_clock::now();
+    std::this_thread::sleep_for(milliseconds(50));
+    uint64_t elapsedNs = AGT::TscClock::TicksToDurationNs(AGT::TscClock::GetTicks() - startTicks);
+    uint64_t expectedNs = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+
+    //1% drift
+    EXPECT_NEAR(static_cast<double>(elapsedNs), static_cast<double>(expectedNs), expectedNs * 0.01);
+}
+
+TEST(Timer, DeltaT) {
+    AGT::Timer timer;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    float deltaMs = timer.GetAndUpdateDeltaTMs();
+    EXPECT_GE(deltaMs, 9.0f);
+    EXPECT_LT(timer.GetDeltaTMs(), deltaMs);
+}
\ No newline at end of file